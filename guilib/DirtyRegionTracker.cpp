@@ -0,0 +1,215 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "include.h"
+#include "DirtyRegionTracker.h"
+#include "GraphicContext.h"
+#include "GUITextLayout.h"
+#include "GUIFontManager.h"
+#include "Settings.h"
+#ifdef HAS_SDL_OPENGL
+#include <GL/glew.h>
+#endif
+
+#include <algorithm>
+
+using namespace std;
+
+CDirtyRegionTracker g_dirtyRegionTracker;
+
+const float CDirtyRegionTracker::FULL_REDRAW_AREA = 0.6f;
+
+CDirtyRegionTracker::CDirtyRegionTracker()
+{
+  m_mode = MODE_SKIP_IDLE_FRAMES;
+  m_visualize = false;
+  m_recording = false;
+  m_probing = false;
+  m_forceRedraw = true;
+  m_haveFrame = false;
+  m_skippedFrames = 0;
+}
+
+bool CDirtyRegionTracker::BeginFrame(bool canTrack)
+{
+  m_mode = g_advancedSettings.m_guiDirtyRegions;
+  m_visualize = g_advancedSettings.m_guiVisualizeDirtyRegions;
+#ifndef HAS_SDL_OPENGL
+  if (m_mode == MODE_DIRTY_REGIONS)
+    m_mode = MODE_SKIP_IDLE_FRAMES; // only opengl can scissor the frame
+#endif
+
+  CRect screen(0, 0, (float)g_graphicsContext.GetWidth(), (float)g_graphicsContext.GetHeight());
+  if (screen != m_screen)
+  {
+    m_screen = screen;
+    m_forceRedraw = true;
+  }
+
+  m_frame.clear();
+  if (!canTrack || m_mode == MODE_ALWAYS_RENDER)
+  { // whatever is on screen now isn't something we know about
+    m_recording = m_probing = false;
+    m_haveFrame = false;
+    m_lastFrame.clear();
+    m_pending.clear();
+    m_changed.clear();
+    return true;
+  }
+
+  m_recording = true;
+  bool fullRedraw = m_forceRedraw || !m_haveFrame || m_visualize;
+  m_forceRedraw = false;
+  if (!fullRedraw && m_pending.empty())
+  { // nothing's changed since the last frame we presented
+    m_probing = true;
+    m_skippedFrames++;
+    g_graphicsContext.SetFrameScissor(CRect());
+    return false;
+  }
+
+  m_probing = false;
+  m_scissor = m_screen;
+  if (!fullRedraw && m_mode == MODE_DIRTY_REGIONS)
+  { // the back buffer is the frame before last, so it's also missing what we drew last time
+    m_pending.push_back(m_lastScissor);
+    CRect box = Bounds(m_pending);
+    box.Intersect(m_screen);
+    if (box.Width() * box.Height() < FULL_REDRAW_AREA * m_screen.Width() * m_screen.Height())
+      m_scissor = box;
+  }
+  m_pending.clear();
+  g_graphicsContext.SetFrameScissor(m_scissor);
+  return true;
+}
+
+void CDirtyRegionTracker::EndFrame()
+{
+  if (!m_recording)
+    return;
+
+  sort(m_frame.begin(), m_frame.end());
+  m_changed.clear();
+  AddDirtyRects(m_lastFrame, m_frame, m_changed);
+
+  if (m_probing)
+    m_pending.insert(m_pending.end(), m_changed.begin(), m_changed.end());
+  else
+  { // anything that changed outside the scissor is still out of date on screen
+    for (vector<CRect>::const_iterator i = m_changed.begin(); i != m_changed.end(); ++i)
+    {
+      if (i->x1 < m_scissor.x1 || i->y1 < m_scissor.y1 || i->x2 > m_scissor.x2 || i->y2 > m_scissor.y2)
+        m_pending.push_back(*i);
+    }
+    m_lastScissor = m_scissor;
+    m_haveFrame = true;
+    if (m_visualize && m_changed.empty())
+      m_skippedFrames++; // would have been skipped
+  }
+
+  if (m_pending.size() > MAX_PENDING)
+  {
+    CRect box = Bounds(m_pending);
+    m_pending.clear();
+    m_pending.push_back(box);
+  }
+
+  m_lastFrame.swap(m_frame);
+  m_recording = m_probing = false;
+  g_graphicsContext.SetFrameScissor(m_screen);
+}
+
+void CDirtyRegionTracker::AddPrimitive(DWORD hash, float x1, float y1, float x2, float y2)
+{
+  CPrimitive primitive;
+  primitive.hash = hash;
+  primitive.rect.SetRect(x1, y1, x2, y2);
+  m_frame.push_back(primitive);
+}
+
+void CDirtyRegionTracker::AddDirtyRects(vector<CPrimitive> &previous, vector<CPrimitive> &current, vector<CRect> &dirty)
+{
+  // both lists are sorted by hash, so anything in only one of them has appeared or gone
+  vector<CPrimitive>::const_iterator i = previous.begin();
+  vector<CPrimitive>::const_iterator j = current.begin();
+  while (i != previous.end() || j != current.end())
+  {
+    if (j == current.end() || (i != previous.end() && i->hash < j->hash))
+      dirty.push_back((i++)->rect);
+    else if (i == previous.end() || j->hash < i->hash)
+      dirty.push_back((j++)->rect);
+    else
+    {
+      ++i;
+      ++j;
+    }
+  }
+}
+
+CRect CDirtyRegionTracker::Bounds(const vector<CRect> &rects)
+{
+  if (rects.empty())
+    return CRect();
+  CRect box = rects[0];
+  for (unsigned int i = 1; i < rects.size(); i++)
+  {
+    if (rects[i].x1 < box.x1) box.x1 = rects[i].x1;
+    if (rects[i].y1 < box.y1) box.y1 = rects[i].y1;
+    if (rects[i].x2 > box.x2) box.x2 = rects[i].x2;
+    if (rects[i].y2 > box.y2) box.y2 = rects[i].y2;
+  }
+  return box;
+}
+
+void CDirtyRegionTracker::RenderOverlay()
+{
+  if (!m_visualize)
+    return;
+
+#ifdef HAS_SDL_OPENGL
+  // shade what changed this frame
+  glDisable(GL_TEXTURE_2D);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glEnable(GL_BLEND);
+  glColor4f(1.0f, 0.0f, 0.0f, 0.25f);
+  glBegin(GL_QUADS);
+  for (vector<CRect>::const_iterator i = m_changed.begin(); i != m_changed.end(); ++i)
+  {
+    glVertex3f(i->x1, i->y1, 0);
+    glVertex3f(i->x2, i->y1, 0);
+    glVertex3f(i->x2, i->y2, 0);
+    glVertex3f(i->x1, i->y2, 0);
+  }
+  glEnd();
+  glEnable(GL_TEXTURE_2D);
+#endif
+
+  CGUIFont *font = g_fontManager.GetFont("font13");
+  if (!font)
+    return;
+
+  RESOLUTION res = g_graphicsContext.GetVideoResolution();
+  g_graphicsContext.SetRenderingResolution(res, 0, 0, false);
+
+  CStdString text;
+  text.Format("Dirty regions: %u changed, %u frames skipped", (unsigned int)m_changed.size(), m_skippedFrames);
+  CGUITextLayout::DrawOutlineText(font, 0.04f * g_graphicsContext.GetWidth(), 0.08f * g_graphicsContext.GetHeight(), 0xffffffff, 0xff000000, 2, text);
+}
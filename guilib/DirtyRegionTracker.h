@@ -0,0 +1,138 @@
+/*!
+\file DirtyRegionTracker.h
+\brief
+*/
+
+#ifndef GUILIB_DIRTYREGIONTRACKER_H
+#define GUILIB_DIRTYREGIONTRACKER_H
+
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <vector>
+#include "Geometry.h"
+
+/*!
+ \ingroup graphics
+ \brief Works out which parts of the screen changed between GUI frames, so that idle frames aren't drawn.
+
+ Everything the GUI draws goes through CGUIImage and CGUIFontTTF.  While a frame is being tracked
+ they hand each quad or string they draw to AddPrimitive() as a hash of everything that affects its
+ pixels (texture, final screen coordinates, colours) along with its bounding box on screen.  At the
+ end of the frame the list is compared with the last frame's, and any primitive that appeared or
+ disappeared marks its box as dirty.
+
+ The GUI is still processed every frame, so that animations, scrolling text and info labels move
+ on, but when nothing is dirty the frame is only "probed": the primitives record themselves and
+ draw nothing, and the frame isn't presented.  When something is dirty, the next frame is drawn -
+ either all of it, or (MODE_DIRTY_REGIONS) only a scissor box around the dirty parts.  Because
+ the back buffer is a frame behind after a flip, the box also covers what was drawn the frame
+ before.  Drawing only part of the frame relies on the driver preserving the back buffer across
+ a flip, which is why it's opt in.
+
+ Frames can only be tracked when nothing is drawn around CGUIImage and the fonts - the caller
+ says so in BeginFrame(), and anything else (video, visualisations, the slideshow) gets a full
+ redraw every frame as before.
+ */
+class CDirtyRegionTracker
+{
+public:
+  enum MODE { MODE_ALWAYS_RENDER = 0,   ///< draw every frame
+              MODE_SKIP_IDLE_FRAMES,    ///< skip frames where nothing changed, otherwise draw everything
+              MODE_DIRTY_REGIONS };     ///< skip idle frames and only draw the changed parts of the rest
+
+  CDirtyRegionTracker();
+
+  /*! \brief Start a GUI frame
+   \param canTrack false if the frame has anything on it that isn't drawn through CGUIImage or the fonts
+   \return true if the frame should be drawn and presented, false if it should only be probed
+   */
+  bool BeginFrame(bool canTrack);
+  void EndFrame();
+
+  /*! \brief Draw the whole of the next frame, eg after a resolution change or the window being exposed
+   */
+  void MarkDirty() { m_forceRedraw = true; };
+
+  /*! \brief True while a frame is tracked - primitives should call AddPrimitive()
+   */
+  inline bool IsRecording() const { return m_recording; };
+  /*! \brief True while a frame is only probed - primitives shouldn't draw anything
+   */
+  inline bool IsProbing() const { return m_probing; };
+  void AddPrimitive(DWORD hash, float x1, float y1, float x2, float y2);
+
+  /*! \brief Outline the regions that changed, and show the number of skipped frames (advancedsettings visualizedirtyregions)
+   */
+  void RenderOverlay();
+  unsigned int GetSkippedFrames() const { return m_skippedFrames; };
+
+  /*! \brief FNV-1a, for building primitive hashes
+   */
+  static inline DWORD Hash(const void *data, unsigned int size, DWORD hash = 2166136261UL)
+  {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (unsigned int i = 0; i < size; i++)
+      hash = (hash ^ bytes[i]) * 16777619UL;
+    return hash;
+  };
+
+private:
+  struct CPrimitive
+  {
+    DWORD hash;
+    CRect rect;
+    bool operator<(const CPrimitive &right) const { return hash < right.hash; };
+  };
+
+  void AddDirtyRects(std::vector<CPrimitive> &previous, std::vector<CPrimitive> &current, std::vector<CRect> &dirty);
+  static CRect Bounds(const std::vector<CRect> &rects);
+
+  static const unsigned int MAX_PENDING = 32;   // dirty rects kept before they're merged into one
+  static const float FULL_REDRAW_AREA;          // redraw everything if more than this fraction is dirty
+
+  int m_mode;
+  bool m_visualize;
+  bool m_recording;
+  bool m_probing;
+  bool m_forceRedraw;
+  bool m_haveFrame;                     // m_lastFrame is what's on screen, other than m_pending
+
+  std::vector<CPrimitive> m_frame;      // primitives of the current frame
+  std::vector<CPrimitive> m_lastFrame;  // primitives of the last frame
+  std::vector<CRect> m_pending;         // parts of the screen that are out of date
+  std::vector<CRect> m_changed;         // parts that changed in the last frame, for the overlay
+  CRect m_screen;
+  CRect m_scissor;                      // part of the screen drawn this frame
+  CRect m_lastScissor;                  // part drawn in the last presented frame
+
+  unsigned int m_skippedFrames;
+};
+
+/*!
+ \ingroup graphics
+ \brief
+ */
+extern CDirtyRegionTracker g_dirtyRegionTracker;
+
+#endif
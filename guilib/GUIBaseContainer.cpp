@@ -198,6 +198,14 @@ bool CGUIBaseContainer::OnMessage(CGUIMessage& message)
       message.SetParam1(GetSelectedItem());
       return true;
     }
+    else if (message.GetMessage() == GUI_MSG_VISIBLE_RANGE)
+    {
+      int first, count;
+      GetVisibleRange(first, count);
+      message.SetParam1(first);
+      message.SetParam2(count);
+      return true;
+    }
     else if (message.GetMessage() == GUI_MSG_PAGE_CHANGE)
     {
       if (message.GetSenderId() == m_pageControl && IsVisible())
@@ -364,6 +372,12 @@ int CGUIBaseContainer::GetSelectedItem() const
   return CorrectOffset(m_offset, m_cursor);
 }
 
+void CGUIBaseContainer::GetVisibleRange(int &first, int &count) const
+{
+  first = CorrectOffset(m_offset, 0);
+  count = m_itemsPerPage;
+}
+
 CGUIListItemPtr CGUIBaseContainer::GetListItem(int offset, unsigned int flag) const
 {
   if (!m_items.size())
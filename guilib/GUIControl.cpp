@@ -25,6 +25,7 @@
 #include "utils/GUIInfoManager.h"
 #include "LocalizeStrings.h"
 #include "GUIWindowManager.h"
+#include "GUIProfiler.h"
 
 using namespace std;
 
@@ -132,6 +133,7 @@ void CGUIControl::DynamicResourceAlloc(bool bOnOff)
 // 3. reset the animation transform
 void CGUIControl::DoRender(DWORD currentTime)
 {
+  GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_CONTROL, CGUIProfiler::GetControlTypeName(ControlType), GetID())
   Animate(currentTime);
   if (m_hasCamera)
     g_graphicsContext.SetCameraPosition(m_camera);
@@ -23,7 +23,9 @@
 #include "GUIFontTTF.h"
 #include "GUIFontManager.h"
 #include "GraphicContext.h"
+#include "DirtyRegionTracker.h"
 #include <math.h>
+#include <float.h>
 
 // stuff for freetype
 #ifndef _LINUX
@@ -350,6 +352,14 @@ void CGUIFontTTF::DrawTextInternal(float x, float y, const vector<DWORD> &colors
   m_originX = x;
   m_originY = y;
 
+  bool recording = g_dirtyRegionTracker.IsRecording();
+  if (recording)
+  {
+    const CGUIFontTTF *font = this;
+    m_dirtyHash = CDirtyRegionTracker::Hash(&font, sizeof(font));
+    m_dirtyRect.SetRect(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+  }
+
   // Check if we will really need to truncate or justify the text
   if ( alignment & XBFONT_TRUNCATED )
   {
@@ -444,6 +454,9 @@ void CGUIFontTTF::DrawTextInternal(float x, float y, const vector<DWORD> &colors
       cursorX += ch->advance;
   }
 
+  if (recording && m_dirtyRect.x1 <= m_dirtyRect.x2)
+    g_dirtyRegionTracker.AddPrimitive(m_dirtyHash, m_dirtyRect.x1, m_dirtyRect.y1, m_dirtyRect.x2, m_dirtyRect.y2);
+
   End();
 }
 
@@ -780,7 +793,7 @@ bool CGUIFontTTF::CacheCharacter(WCHAR letter, DWORD style, Character *ch)
 
 void CGUIFontTTF::Begin()
 {
-  if (m_dwNestedBeginCount == 0)
+  if (m_dwNestedBeginCount == 0 && !g_dirtyRegionTracker.IsProbing())
   {
 #ifndef HAS_SDL
     // just have to blit from our texture.
@@ -869,6 +882,9 @@ void CGUIFontTTF::End()
   if (--m_dwNestedBeginCount > 0)
     return;
 
+  if (g_dirtyRegionTracker.IsProbing())
+    return;
+
 #ifndef HAS_SDL
 #ifdef HAS_XBOX_D3D
   m_pD3DDevice->End();
@@ -932,6 +948,23 @@ void CGUIFontTTF::RenderCharacter(float posX, float posY, const Character *ch, D
   float y4 = ROUND_TO_PIXEL(g_graphicsContext.ScaleFinalYCoord(vertex.x1, vertex.y2));
   float z4 = ROUND_TO_PIXEL(g_graphicsContext.ScaleFinalZCoord(vertex.x1, vertex.y2));
 
+  if (g_dirtyRegionTracker.IsRecording())
+  {
+    float coords[12] = { x[0], y1, x[1], y2, x[2], y3, x[3], y4,
+                         texture.x1, texture.y1, texture.x2, texture.y2 };
+    m_dirtyHash = CDirtyRegionTracker::Hash(coords, sizeof(coords), m_dirtyHash);
+    m_dirtyHash = CDirtyRegionTracker::Hash(&dwColor, sizeof(dwColor), m_dirtyHash);
+    for (int i = 0; i < 8; i += 2)
+    {
+      if (coords[i] < m_dirtyRect.x1) m_dirtyRect.x1 = coords[i];
+      if (coords[i] > m_dirtyRect.x2) m_dirtyRect.x2 = coords[i];
+      if (coords[i + 1] < m_dirtyRect.y1) m_dirtyRect.y1 = coords[i + 1];
+      if (coords[i + 1] > m_dirtyRect.y2) m_dirtyRect.y2 = coords[i + 1];
+    }
+    if (g_dirtyRegionTracker.IsProbing())
+      return;
+  }
+
 #ifdef HAS_XBOX_D3D
   m_pD3DDevice->SetVertexDataColor( D3DVSDE_DIFFUSE, dwColor);
 
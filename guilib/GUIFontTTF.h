@@ -28,6 +28,8 @@
  *
  */
 
+#include "Geometry.h"
+
 // forward definition
 struct FT_FaceRec_;
 struct FT_LibraryRec_;
@@ -140,6 +142,10 @@ protected:
 
   float m_originX;
   float m_originY;
+
+  // what the current DrawTextInternal() has drawn, for the dirty region tracker
+  DWORD m_dirtyHash;
+  CRect m_dirtyRect;
 #ifdef HAS_SDL_OPENGL
   bool m_glTextureLoaded;
   GLuint m_glTexture;
@@ -100,7 +100,9 @@ void CGUILargeImage::AllocResources()
 #else
     CGLTexture * texture;
 #endif
-    texture = g_largeTextureManager.GetImage(m_strFileName, m_iTextureWidth, m_iTextureHeight, m_orientation, !m_texturesAllocated);
+    // images that are fading in after a delay can wait for those already on screen
+    CGUILargeTextureManager::LOAD_PRIORITY priority = (m_visible == DELAYED) ? CGUILargeTextureManager::PRIORITY_NEXT_PAGE : CGUILargeTextureManager::PRIORITY_VISIBLE;
+    texture = g_largeTextureManager.GetImage(m_strFileName, m_iTextureWidth, m_iTextureHeight, m_orientation, !m_texturesAllocated, priority);
     m_texturesAllocated = true;
 
     if (!texture)
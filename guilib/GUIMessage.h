@@ -83,6 +83,8 @@
 #define GUI_MSG_PAGE_DOWN    31 // page down
 #define GUI_MSG_MOVE_OFFSET  32 // Instruct the contorl to MoveUp or MoveDown by offset amount
 
+#define GUI_MSG_VISIBLE_RANGE 33 // ask a list control which items are on screen: param1 = first item, param2 = number of items
+
 #define GUI_MSG_USER         1000
 
 /*!
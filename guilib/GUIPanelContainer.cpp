@@ -420,6 +420,12 @@ int CGUIPanelContainer::CorrectOffset(int offset, int cursor) const
   return offset * m_itemsPerRow + cursor;
 }
 
+void CGUIPanelContainer::GetVisibleRange(int &first, int &count) const
+{
+  first = CorrectOffset(m_offset, 0);
+  count = m_itemsPerPage * m_itemsPerRow;
+}
+
 //#ifdef PRE_SKIN_VERSION_2_1_COMPATIBILITY
 CGUIPanelContainer::CGUIPanelContainer(DWORD dwParentID, DWORD dwControlId, float posX, float posY, float width, float height,
                          const CImage& imageNoFocus, const CImage& imageFocus,
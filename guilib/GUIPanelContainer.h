@@ -68,6 +68,7 @@ protected:
   virtual void CalculateLayout();
   unsigned int GetRows() const;
   virtual int  CorrectOffset(int offset, int cursor) const;
+  virtual void GetVisibleRange(int &first, int &count) const;
   virtual bool SelectItemFromPoint(const CPoint &point);
   void SetCursor(int cursor);
   virtual void SelectItem(int item);
@@ -0,0 +1,251 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "include.h"
+#include "GUIProfiler.h"
+
+#ifdef HAS_GUI_PROFILER
+
+#include "GUIControl.h"
+#include "GUITextLayout.h"
+#include "GUIFontManager.h"
+#include "GraphicContext.h"
+#include "../xbmc/FileSystem/File.h"
+
+using namespace XFILE;
+
+CGUIProfiler g_guiProfiler;
+
+static const char *categoryNames[] = { "frame", "window", "control", "text", "texture", "infobool" };
+
+CGUIProfiler::CGUIProfiler()
+{
+  memset(m_samples, 0, sizeof(m_samples));
+  m_writePos = 0;
+  m_frame = 0;
+  m_frameStart = 0;
+  LARGE_INTEGER freq;
+  QueryPerformanceFrequency(&freq);
+  m_frequency = freq.QuadPart ? freq.QuadPart : 1;
+  m_frameTime = 0;
+  for (int i = 0; i < PROFILE_NUM_CATEGORIES; i++)
+  {
+    m_categoryTime[i] = 0;
+    m_categoryCount[i] = 0;
+  }
+  m_lastFramePos = 0;
+  m_showOverlay = false;
+}
+
+void CGUIProfiler::BeginFrame()
+{
+  m_frame++;
+  m_lastFramePos = (unsigned int)m_writePos;
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  m_frameStart = now.QuadPart;
+}
+
+void CGUIProfiler::EndFrame()
+{
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  AddSample(PROFILE_FRAME, "frame", m_frame, m_frameStart, now.QuadPart);
+
+  // sum up this frame's samples for the overlay.  Nested samples (controls inside
+  // windows, text inside controls) are counted in each of their categories.
+  for (int i = 0; i < PROFILE_NUM_CATEGORIES; i++)
+  {
+    m_categoryTime[i] = 0;
+    m_categoryCount[i] = 0;
+  }
+  unsigned int end = (unsigned int)m_writePos;
+  unsigned int start = m_lastFramePos;
+  if (end - start > RING_SIZE)
+    start = end - RING_SIZE;
+  for (unsigned int pos = start; pos != end; pos++)
+  {
+    const CSample &sample = m_samples[pos & (RING_SIZE - 1)];
+    if (sample.frame != m_frame)
+      continue;
+    m_categoryTime[sample.category] += (double)(sample.end - sample.start) * 1000.0 / m_frequency;
+    m_categoryCount[sample.category]++;
+  }
+  m_frameTime = m_categoryTime[PROFILE_FRAME];
+}
+
+void CGUIProfiler::AddSample(CATEGORY category, const char *name, int id, __int64 start, __int64 end)
+{
+  // claim a slot - once the ring wraps the oldest samples are simply overwritten
+  unsigned int pos = (unsigned int)(InterlockedIncrement(&m_writePos) - 1);
+  CSample &sample = m_samples[pos & (RING_SIZE - 1)];
+  sample.frame = m_frame;
+  sample.category = category;
+  sample.name = name;
+  sample.id = id;
+  sample.thread = GetCurrentThreadId();
+  sample.start = start;
+  sample.end = end;
+}
+
+void CGUIProfiler::RenderOverlay()
+{
+  if (!m_showOverlay)
+    return;
+
+  CGUIFont *font = g_fontManager.GetFont("font13");
+  if (!font)
+    return;
+
+  RESOLUTION res = g_graphicsContext.GetVideoResolution();
+  g_graphicsContext.SetRenderingResolution(res, 0, 0, false);
+
+  float x = 0.04f * g_graphicsContext.GetWidth();
+  float y = 0.12f * g_graphicsContext.GetHeight();
+
+  CStdString text;
+  text.Format("Frame %u: %2.2f ms", m_frame, m_frameTime);
+  CGUITextLayout::DrawOutlineText(font, x, y, 0xffffffff, 0xff000000, 2, text);
+  for (int i = PROFILE_WINDOW; i < PROFILE_NUM_CATEGORIES; i++)
+  {
+    y += font->GetLineHeight();
+    text.Format("%-10s %4u calls %2.2f ms", categoryNames[i], m_categoryCount[i], m_categoryTime[i]);
+    CGUITextLayout::DrawOutlineText(font, x, y, 0xffffffff, 0xff000000, 2, text);
+  }
+}
+
+bool CGUIProfiler::DumpTrace(const CStdString &file) const
+{
+  CFile output;
+  if (!output.OpenForWrite(file, true, true))
+  {
+    CLog::Log(LOGERROR, "%s - unable to open %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  unsigned int end = (unsigned int)m_writePos;
+  unsigned int start = (end > RING_SIZE) ? end - RING_SIZE : 0;
+
+  // find the earliest sample so that timestamps start near zero
+  __int64 base = 0;
+  for (unsigned int pos = start; pos != end; pos++)
+  {
+    const CSample &sample = m_samples[pos & (RING_SIZE - 1)];
+    if (sample.name && (!base || sample.start < base))
+      base = sample.start;
+  }
+
+  CStdString json = "{\"traceEvents\":[\n";
+  bool first = true;
+  unsigned int count = 0;
+  for (unsigned int pos = start; pos != end; pos++)
+  {
+    const CSample &sample = m_samples[pos & (RING_SIZE - 1)];
+    if (!sample.name)
+      continue;
+    double ts = (double)(sample.start - base) * 1000000.0 / m_frequency;
+    double dur = (double)(sample.end - sample.start) * 1000000.0 / m_frequency;
+    CStdString event;
+    event.Format("%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"id\":%i,\"frame\":%u}}",
+                 first ? "" : ",\n", sample.name, categoryNames[sample.category], ts, dur,
+                 (unsigned int)sample.thread, sample.id, sample.frame);
+    json += event;
+    first = false;
+    count++;
+    if (json.size() > 65536)
+    {
+      output.Write(json.c_str(), json.size());
+      json.clear();
+    }
+  }
+  json += "\n]}\n";
+  output.Write(json.c_str(), json.size());
+  output.Close();
+
+  CLog::Log(LOGINFO, "%s - wrote %u samples to %s", __FUNCTION__, count, file.c_str());
+  return true;
+}
+
+const char *CGUIProfiler::GetControlTypeName(int controlType)
+{
+  switch (controlType)
+  {
+  case CGUIControl::GUICONTROL_BUTTON: return "button";
+  case CGUIControl::GUICONTROL_CHECKMARK: return "checkmark";
+  case CGUIControl::GUICONTROL_FADELABEL: return "fadelabel";
+  case CGUIControl::GUICONTROL_IMAGE: return "image";
+  case CGUIControl::GUICONTROL_BORDEREDIMAGE: return "borderedimage";
+  case CGUIControl::GUICONTROL_LARGE_IMAGE: return "largeimage";
+  case CGUIControl::GUICONTROL_LABEL: return "label";
+  case CGUIControl::GUICONTROL_LIST: return "list";
+  case CGUIControl::GUICONTROL_LISTGROUP: return "listgroup";
+  case CGUIControl::GUICONTROL_LISTEX: return "listex";
+  case CGUIControl::GUICONTROL_PROGRESS: return "progress";
+  case CGUIControl::GUICONTROL_RADIO: return "radiobutton";
+  case CGUIControl::GUICONTROL_RSS: return "rss";
+  case CGUIControl::GUICONTROL_SELECTBUTTON: return "selectbutton";
+  case CGUIControl::GUICONTROL_SLIDER: return "slider";
+  case CGUIControl::GUICONTROL_SETTINGS_SLIDER: return "sliderex";
+  case CGUIControl::GUICONTROL_SPINBUTTON: return "spinbutton";
+  case CGUIControl::GUICONTROL_SPIN: return "spincontrol";
+  case CGUIControl::GUICONTROL_SPINEX: return "spincontrolex";
+  case CGUIControl::GUICONTROL_TEXTBOX: return "textbox";
+  case CGUIControl::GUICONTROL_THUMBNAIL: return "thumbnailpanel";
+  case CGUIControl::GUICONTROL_TOGGLEBUTTON: return "togglebutton";
+  case CGUIControl::GUICONTROL_VIDEO: return "videowindow";
+  case CGUIControl::GUICONTROL_MOVER: return "mover";
+  case CGUIControl::GUICONTROL_RESIZE: return "resize";
+  case CGUIControl::GUICONTROL_BUTTONBAR: return "buttonbar";
+  case CGUIControl::GUICONTROL_CONSOLE: return "console";
+  case CGUIControl::GUICONTROL_EDIT: return "edit";
+  case CGUIControl::GUICONTROL_VISUALISATION: return "visualisation";
+  case CGUIControl::GUICONTROL_MULTI_IMAGE: return "multiimage";
+  case CGUIControl::GUICONTROL_GROUP: return "group";
+  case CGUIControl::GUICONTROL_GROUPLIST: return "grouplist";
+  case CGUIControl::GUICONTROL_SCROLLBAR: return "scrollbar";
+  case CGUIControl::GUICONTROL_LISTLABEL: return "listlabel";
+  case CGUIControl::GUICONTROL_MULTISELECT: return "multiselect";
+  case CGUIControl::GUICONTAINER_LIST: return "list";
+  case CGUIControl::GUICONTAINER_WRAPLIST: return "wraplist";
+  case CGUIControl::GUICONTAINER_FIXEDLIST: return "fixedlist";
+  case CGUIControl::GUICONTAINER_PANEL: return "panel";
+  default: return "unknown";
+  }
+}
+
+CGUIProfilerScope::CGUIProfilerScope(CGUIProfiler::CATEGORY category, const char *name, int id)
+{
+  m_category = category;
+  m_name = name;
+  m_id = id;
+  LARGE_INTEGER start;
+  QueryPerformanceCounter(&start);
+  m_start = start.QuadPart;
+}
+
+CGUIProfilerScope::~CGUIProfilerScope()
+{
+  LARGE_INTEGER end;
+  QueryPerformanceCounter(&end);
+  g_guiProfiler.AddSample(m_category, m_name, m_id, m_start, end.QuadPart);
+}
+
+#endif
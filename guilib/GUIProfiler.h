@@ -0,0 +1,129 @@
+/*!
+\file GUIProfiler.h
+\brief
+*/
+
+#ifndef GUILIB_GUIPROFILER_H
+#define GUILIB_GUIPROFILER_H
+
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+// The GUI profiler only exists in debug builds - in release builds the macros
+// below expand to nothing and none of the profiler is compiled.
+#ifdef HAS_GUI_PROFILER
+
+#define GUIPROFILER_SCOPE(category, name, id) CGUIProfilerScope guiProfilerScope(category, name, id);
+#define GUIPROFILER_BEGIN_FRAME g_guiProfiler.BeginFrame();
+#define GUIPROFILER_END_FRAME g_guiProfiler.EndFrame();
+#define GUIPROFILER_RENDER_OVERLAY g_guiProfiler.RenderOverlay();
+
+/*!
+ \ingroup graphics
+ \brief Records per-frame render timings of windows, controls, text, texture binds and info bools.
+
+ Samples go into a fixed size ring buffer, claimed with an interlocked increment so that any
+ thread may record without taking a lock.  At the end of each frame the frame's samples are
+ summed per category for the on-screen overlay.  The whole buffer can be written out as a
+ Chrome trace (chrome://tracing) JSON file.
+ */
+class CGUIProfiler
+{
+public:
+  enum CATEGORY { PROFILE_FRAME = 0,
+                  PROFILE_WINDOW,
+                  PROFILE_CONTROL,
+                  PROFILE_TEXT,
+                  PROFILE_TEXTURE,
+                  PROFILE_INFOBOOL,
+                  PROFILE_NUM_CATEGORIES };
+
+  CGUIProfiler();
+
+  void BeginFrame();
+  void EndFrame();
+  void AddSample(CATEGORY category, const char *name, int id, __int64 start, __int64 end);
+
+  void ToggleOverlay() { m_showOverlay = !m_showOverlay; };
+  void RenderOverlay();
+  bool DumpTrace(const CStdString &file) const;
+
+  static const char *GetControlTypeName(int controlType);
+
+private:
+  struct CSample
+  {
+    unsigned int frame;
+    CATEGORY category;
+    const char *name;   // must be a static string
+    int id;
+    DWORD thread;
+    __int64 start;
+    __int64 end;
+  };
+
+  static const unsigned int RING_SIZE = 32768; // must be a power of 2
+
+  CSample m_samples[RING_SIZE];
+  LONG m_writePos;
+  unsigned int m_frame;
+  __int64 m_frameStart;
+  __int64 m_frequency;
+
+  // totals for the last complete frame, for the overlay
+  double m_frameTime;
+  double m_categoryTime[PROFILE_NUM_CATEGORIES];
+  unsigned int m_categoryCount[PROFILE_NUM_CATEGORIES];
+  unsigned int m_lastFramePos;
+
+  bool m_showOverlay;
+};
+
+/*!
+ \ingroup graphics
+ \brief Times the enclosing scope into g_guiProfiler.  Use via GUIPROFILER_SCOPE.
+ */
+class CGUIProfilerScope
+{
+public:
+  CGUIProfilerScope(CGUIProfiler::CATEGORY category, const char *name, int id);
+  ~CGUIProfilerScope();
+private:
+  CGUIProfiler::CATEGORY m_category;
+  const char *m_name;
+  int m_id;
+  __int64 m_start;
+};
+
+extern CGUIProfiler g_guiProfiler;
+
+#else
+
+#define GUIPROFILER_SCOPE(category, name, id)
+#define GUIPROFILER_BEGIN_FRAME
+#define GUIPROFILER_END_FRAME
+#define GUIPROFILER_RENDER_OVERLAY
+
+#endif
+
+#endif
@@ -27,6 +27,7 @@
 #include "GUIColorManager.h"
 #include "utils/CharsetConverter.h"
 #include "StringUtils.h"
+#include "GUIProfiler.h"
 
 using namespace std;
 
@@ -63,6 +64,7 @@ void CGUITextLayout::Render(float x, float y, float angle, DWORD color, DWORD sh
 {
   if (!m_font)
     return;
+  GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_TEXT, "render", m_lines.size())
 
   // set the main text color
   if (m_colors.size())
@@ -103,6 +105,7 @@ void CGUITextLayout::RenderScrolling(float x, float y, float angle, DWORD color,
 {
   if (!m_font)
     return;
+  GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_TEXT, "scrolling", m_lines.size())
 
   // set the main text color
   if (m_colors.size())
@@ -145,6 +148,7 @@ void CGUITextLayout::RenderOutline(float x, float y, DWORD color, DWORD outlineC
 {
   if (!m_font)
     return;
+  GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_TEXT, "outline", m_lines.size())
 
   // set the main text color
   if (m_colors.size())
@@ -189,6 +193,7 @@ bool CGUITextLayout::Update(const CStdString &text, float maxWidth)
 
 void CGUITextLayout::SetText(const CStdStringW &text, float maxWidth)
 {
+  GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_TEXT, "layout", text.size())
   vector<DWORD> parsedText;
 
   // empty out our previous string
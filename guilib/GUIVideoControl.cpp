@@ -23,6 +23,7 @@
 #include "GUIVideoControl.h"
 #include "GUIWindowManager.h"
 #include "Application.h"
+#include "DirtyRegionTracker.h"
 #ifdef HAS_VIDEO_PLAYBACK
 #include "cores/VideoRenderers/RenderManager.h"
 #else
@@ -52,6 +53,9 @@ void CGUIVideoControl::Render()
     if (!g_application.m_pPlayer->IsPaused())
       g_application.ResetScreenSaver();
 
+    // the video isn't drawn through the GUI primitives, so can't be tracked
+    g_dirtyRegionTracker.MarkDirty();
+
     g_graphicsContext.SetViewWindow(m_posX, m_posY, m_posX + m_width, m_posY + m_height);
 
 #ifdef HAS_VIDEO_PLAYBACK
@@ -2,6 +2,7 @@
 #include "GUIVisualisationControl.h"
 #include "GUIUserMessages.h"
 #include "Application.h"
+#include "DirtyRegionTracker.h"
 #include "MusicInfoTag.h"
 #include "visualizations/Visualisation.h"
 #include "visualizations/VisualisationFactory.h"
@@ -205,6 +206,9 @@ void CGUIVisualisationControl::UpdateVisibility(const CGUIListItem *item)
 
 void CGUIVisualisationControl::Render()
 {
+  // visualisations and karaoke draw straight to the screen, so can't be tracked
+  g_dirtyRegionTracker.MarkDirty();
+
   if (m_pVisualisation == NULL)
   { // check if we need to load
     if (g_application.IsPlayingAudio())
@@ -37,6 +37,7 @@
 #include "utils/SingleLock.h"
 #include "ButtonTranslator.h"
 #include "XMLUtils.h"
+#include "GUIProfiler.h"
 
 #ifdef HAS_PERFORMANCE_SAMPLE
 #include "utils/PerformanceSample.h"
@@ -450,6 +451,8 @@ void CGUIWindow::Render()
   // to occur.
   if (!m_WindowAllocated) return;
 
+  GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_WINDOW, "window", GetID())
+
   // find our origin point
   float posX = m_posX;
   float posY = m_posY;
@@ -995,6 +995,20 @@ void CGraphicContext::Clear()
 #endif
 }
 
+void CGraphicContext::SetFrameScissor(const CRect &rect)
+{
+#ifdef HAS_SDL_OPENGL
+  GLVALIDATE;
+  // round outwards to whole pixels - opengl uses bottomleft as origin
+  int left = (int)floorf(rect.x1);
+  int top = (int)floorf(rect.y1);
+  int right = (int)ceilf(rect.x2);
+  int bottom = (int)ceilf(rect.y2);
+  glScissor(left, m_iScreenHeight - bottom, right - left, bottom - top);
+  VerifyGLState();
+#endif
+}
+
 void CGraphicContext::CaptureStateBlock()
 {
 #ifndef HAS_SDL
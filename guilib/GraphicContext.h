@@ -193,6 +193,7 @@ public:
   void CaptureStateBlock();
   void ApplyStateBlock();
   void Clear();
+  void SetFrameScissor(const CRect &rect);   ///< limit drawing to part of the screen, see CDirtyRegionTracker
 
   // output scaling
   void SetRenderingResolution(RESOLUTION res, float posX, float posY, bool needsScaling);  ///< Sets scaling up for rendering
@@ -16,6 +16,9 @@
 #include "SkinInfo.h"
 #include "GUISettings.h"
 #include "Util.h"
+#ifdef _LINUX
+#include <sys/mman.h>
+#endif
 
 #ifdef _XBOX
 #pragma comment(lib,"xbmc/lib/liblzo/lzo.lib")
@@ -87,6 +90,8 @@ CTextureBundle::CTextureBundle(void)
   m_Ovl[1].hEvent = CreateEvent(0, TRUE, TRUE, 0);
 #else
   m_hFile = NULL;
+  m_MappedData = NULL;
+  m_MappedSize = 0;
 #endif
   m_CurFileHeader[0] = m_FileHeaders.end();
   m_CurFileHeader[1] = m_FileHeaders.end();
@@ -101,6 +106,8 @@ CTextureBundle::~CTextureBundle(void)
   if (m_hFile != INVALID_HANDLE_VALUE)
     CloseHandle(m_hFile);
 #else
+  if (m_MappedData)
+    munmap(m_MappedData, m_MappedSize);
   if (m_hFile != NULL)
     fclose(m_hFile);
 #endif
@@ -277,6 +284,26 @@ bool CTextureBundle::OpenBundle()
   if (lzo_init() != LZO_E_OK)
     goto LoadError;
 
+#ifdef _LINUX
+  // map the bundle so that textures can be decompressed straight out of the page cache
+  // rather than being read into a preload buffer first.  Version 3 bundles have their
+  // textures page aligned, so readahead of one texture doesn't drag in its neighbours.
+  m_MappedSize = fileStat.st_size;
+  m_MappedData = (BYTE*)mmap(NULL, m_MappedSize, PROT_READ, MAP_SHARED, fileno(m_hFile), 0);
+  if (m_MappedData == (BYTE*)MAP_FAILED)
+  {
+    CLog::Log(LOGDEBUG, "Unable to map file: %s: %s, reading textures instead", strPath.c_str(), strerror(errno));
+    m_MappedData = NULL;
+    m_MappedSize = 0;
+  }
+#endif
+  CLog::Log(LOGINFO, "Loaded texture bundle %s (version %i, %u textures%s)", strPath.c_str(), Version, (unsigned int)m_FileHeaders.size(),
+#ifdef _LINUX
+            m_MappedData ? ", mapped" : "");
+#else
+            "");
+#endif
+
   return true;
 
 LoadError:
@@ -298,6 +325,10 @@ void CTextureBundle::Cleanup()
     CloseHandle(m_hFile);
   m_hFile = INVALID_HANDLE_VALUE;
 #else
+  if (m_MappedData)
+    munmap(m_MappedData, m_MappedSize);
+  m_MappedData = NULL;
+  m_MappedSize = 0;
   if (m_hFile != NULL)
     fclose(m_hFile);
   m_hFile = NULL;
@@ -388,6 +419,20 @@ bool CTextureBundle::PreloadFile(const CStdString& Filename)
   CStdString name(Filename);
   name.Normalize();
 
+#ifdef _LINUX
+  if (m_MappedData)
+  { // just ask the kernel to start reading it in
+    std::map<CStdString, FileHeader_t>::iterator file = m_FileHeaders.find(name);
+    if (file == m_FileHeaders.end())
+      return false;
+    size_t start = file->second.Offset & ~(getpagesize() - 1);
+    size_t end = std::min((size_t)file->second.Offset + file->second.PackedSize, m_MappedSize);
+    if (start < end)
+      madvise(m_MappedData + start, end - start, MADV_WILLNEED);
+    return true;
+  }
+#endif
+
   if (m_PreLoadBuffer[m_PreloadIdx])
     free(m_PreLoadBuffer[m_PreloadIdx]);
   m_PreLoadBuffer[m_PreloadIdx] = 0;
@@ -462,6 +507,22 @@ bool CTextureBundle::PreloadFile(const CStdString& Filename)
   return false;
 }
 
+// Preload a list of textures.  A mapped bundle can have the reads for all of them in flight
+// at once, otherwise we can only read one texture ahead.
+void CTextureBundle::PreloadFiles(const std::list<CStdString>& Filenames)
+{
+#ifdef _LINUX
+  if (m_MappedData)
+  {
+    for (std::list<CStdString>::const_iterator it = Filenames.begin(); it != Filenames.end(); ++it)
+      PreloadFile(*it);
+    return;
+  }
+#endif
+  if (Filenames.size())
+    PreloadFile(Filenames.front());
+}
+
 HRESULT CTextureBundle::LoadFile(const CStdString& Filename, CAutoTexBuffer& UnpackedBuf)
 {
   if (Filename == "-")
@@ -469,6 +530,35 @@ HRESULT CTextureBundle::LoadFile(const CStdString& Filename, CAutoTexBuffer& Unp
 
   CStdString name(Filename);
   name.Normalize();
+
+#ifdef _LINUX
+  if (m_MappedData)
+  { // decompress directly from the mapping.  This touches no shared state, so textures
+    // from a mapped bundle may be loaded from several threads at once.
+    std::map<CStdString, FileHeader_t>::const_iterator file = m_FileHeaders.find(name);
+    if (file == m_FileHeaders.end())
+      return E_FAIL;
+    const FileHeader_t &header = file->second;
+    if ((size_t)header.Offset + header.PackedSize > m_MappedSize)
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s: Truncated bundle", Filename.c_str());
+      return E_FAIL;
+    }
+    if (!UnpackedBuf.Set((BYTE*)XPhysicalAlloc(header.UnpackedSize, MAXULONG_PTR, 128, PAGE_READWRITE)))
+    {
+      CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %u bytes)", name.c_str(), header.UnpackedSize);
+      return E_OUTOFMEMORY;
+    }
+    lzo_uint s = header.UnpackedSize;
+    if (lzo1x_decompress_safe(m_MappedData + header.Offset, header.PackedSize, UnpackedBuf, &s, NULL) != LZO_E_OK ||
+        s != header.UnpackedSize)
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", Filename.c_str());
+      return E_FAIL;
+    }
+    return S_OK;
+  }
+#endif
   if (m_CurFileHeader[0] != m_FileHeaders.end() && m_CurFileHeader[0]->first == name)
     m_LoadIdx = 0;
   else if (m_CurFileHeader[1] != m_FileHeaders.end() && m_CurFileHeader[1]->first == name)
@@ -39,6 +39,8 @@ class CTextureBundle
 #else
   FILE*  m_hFile;
   time_t m_TimeStamp;
+  BYTE*  m_MappedData;   // the whole bundle, if it could be memory mapped
+  size_t m_MappedSize;
 #endif  
   std::map<CStdString, FileHeader_t> m_FileHeaders;
   std::map<CStdString, FileHeader_t>::iterator m_CurFileHeader[2];
@@ -60,6 +62,7 @@ public:
   bool HasFile(const CStdString& Filename);
   void GetTexturesFromPath(const CStdString &path, std::vector<CStdString> &textures);
   bool PreloadFile(const CStdString& Filename);
+  void PreloadFiles(const std::list<CStdString>& Filenames);
 
 #ifndef HAS_SDL
   HRESULT LoadTexture(LPDIRECT3DDEVICE8 pDevice, const CStdString& Filename, D3DXIMAGE_INFO* pInfo, LPDIRECT3DTEXTURE8* ppTexture,
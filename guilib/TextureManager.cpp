@@ -12,6 +12,7 @@
 #include "../xbmc/Util.h"
 #include "../xbmc/FileSystem/File.h"
 #include "../xbmc/FileSystem/Directory.h"
+#include <algorithm>
 
 #ifdef HAS_SDL
 #define MAX_PICTURE_WIDTH  4096
@@ -330,6 +331,45 @@ DWORD CTextureMap::GetMemoryUsage() const
 }
 
 
+//------------------------------------------------------------------------------
+CTextureLoadStats::CTextureLoadStats()
+{
+  Reset();
+}
+
+void CTextureLoadStats::Reset()
+{
+  m_numSamples = 0;
+}
+
+void CTextureLoadStats::AddSample(float milliSeconds)
+{
+  m_samples[m_numSamples % MAX_SAMPLES] = milliSeconds;
+  m_numSamples++;
+}
+
+unsigned int CTextureLoadStats::GetCount() const
+{
+  return m_numSamples;
+}
+
+float CTextureLoadStats::GetPercentile(float percentile) const
+{
+  unsigned int count = min(m_numSamples, MAX_SAMPLES);
+  if (!count)
+    return 0.0f;
+  vector<float> sorted(m_samples, m_samples + count);
+  sort(sorted.begin(), sorted.end());
+  unsigned int index = (unsigned int)(percentile * (count - 1) / 100.0f + 0.5f);
+  return sorted[min(index, count - 1)];
+}
+
+void CTextureLoadStats::Dump(const char *name) const
+{
+  CLog::Log(LOGNOTICE, "%s: %u loads, decode time p50:%.1fms p90:%.1fms p99:%.1fms max:%.1fms", name, m_numSamples,
+            GetPercentile(50), GetPercentile(90), GetPercentile(99), GetPercentile(100));
+}
+
 //------------------------------------------------------------------------------
 CGUITextureManager::CGUITextureManager(void)
 {
@@ -475,9 +515,8 @@ void CGUITextureManager::EndPreLoad()
   for (int i = 0; i < 2; i++)
   {
     m_iNextPreload[i] = m_PreLoadNames[i].begin();
-    // preload next file
-    if (m_iNextPreload[i] != m_PreLoadNames[i].end())
-      m_TexBundle[i].PreloadFile(*m_iNextPreload[i]);
+    // preload next file (or all of them, if the bundle allows)
+    m_TexBundle[i].PreloadFiles(m_PreLoadNames[i]);
   }
 }
 
@@ -593,10 +632,8 @@ int CGUITextureManager::Load(const CStdString& strTextureName, DWORD dwColorKey,
   SDL_Palette* pPal = NULL;
 #endif
 
-#ifdef _DEBUG
   LARGE_INTEGER start;
   QueryPerformanceCounter(&start);
-#endif
 
   D3DXIMAGE_INFO info;
 
@@ -733,10 +770,11 @@ int CGUITextureManager::Load(const CStdString& strTextureName, DWORD dwColorKey,
       } // of for (int iImage=0; iImage < iImages; iImage++)
     }
 
-#ifdef _DEBUG
     LARGE_INTEGER end, freq;
     QueryPerformanceCounter(&end);
     QueryPerformanceFrequency(&freq);
+    m_loadStats.AddSample(1000.f * (end.QuadPart - start.QuadPart) / freq.QuadPart);
+#ifdef _DEBUG
     char temp[200];
     sprintf(temp, "Load %s: %.1fms%s\n", strPath.c_str(), 1000.f * (end.QuadPart - start.QuadPart) / freq.QuadPart, (bundle >= 0) ? " (bundled)" : "");
     OutputDebugString(temp);
@@ -816,10 +854,11 @@ int CGUITextureManager::Load(const CStdString& strTextureName, DWORD dwColorKey,
   SDL_FreeSurface(pTexture);
 #endif    
 
-#ifdef _DEBUG
   LARGE_INTEGER end, freq;
   QueryPerformanceCounter(&end);
   QueryPerformanceFrequency(&freq);
+  m_loadStats.AddSample(1000.f * (end.QuadPart - start.QuadPart) / freq.QuadPart);
+#ifdef _DEBUG
   char temp[200];
   sprintf(temp, "Load %s: %.1fms%s\n", strPath.c_str(), 1000.f * (end.QuadPart - start.QuadPart) / freq.QuadPart, (bundle >= 0) ? " (bundled)" : "");
   OutputDebugString(temp);
@@ -888,6 +927,7 @@ void CGUITextureManager::Dump() const
   CStdString strLog;
   strLog.Format("total texturemaps size:%i\n", m_vecTextures.size());
   OutputDebugString(strLog.c_str());
+  m_loadStats.Dump("skin textures");
 
   for (int i = 0; i < (int)m_vecTextures.size(); ++i)
   {
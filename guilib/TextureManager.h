@@ -141,6 +141,25 @@ protected:
   typedef std::vector<CTexture*>::iterator ivecTextures;
 };
 
+/*!
+ \ingroup textures
+ \brief Rolling window of texture decode times, reported by the Dump() functions
+ */
+class CTextureLoadStats
+{
+public:
+  CTextureLoadStats();
+  void AddSample(float milliSeconds);
+  float GetPercentile(float percentile) const;
+  unsigned int GetCount() const;
+  void Dump(const char *name) const;
+  void Reset();
+private:
+  static const unsigned int MAX_SAMPLES = 256;
+  float m_samples[MAX_SAMPLES];
+  unsigned int m_numSamples;    ///< total samples recorded (the window holds the last MAX_SAMPLES)
+};
+
 /*!
  \ingroup textures
  \brief 
@@ -187,6 +206,7 @@ protected:
   std::list<CStdString>::iterator m_iNextPreload[2];
 
   std::vector<CStdString> m_texturePaths;
+  CTextureLoadStats m_loadStats;
 };
 
 /*!
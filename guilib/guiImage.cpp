@@ -23,6 +23,9 @@
 #include "guiImage.h"
 #include "TextureManager.h"
 #include "../xbmc/Util.h"
+#include "../xbmc/Picture.h"
+#include "GUIProfiler.h"
+#include "DirtyRegionTracker.h"
 #if defined(HAS_SDL_OPENGL)
 #include <GL/glew.h>
 #elif defined(HAS_SDL_2D)
@@ -164,10 +167,25 @@ void CGUIImage::Render()
       }
     }
 
+    if (g_dirtyRegionTracker.IsRecording())
+    {
+      AddDirtyRegionPrimitive();
+      if (g_dirtyRegionTracker.IsProbing())
+      { // nothing is drawn on a probe frame
+        if (m_fNW > m_width || m_fNH > m_height)
+          g_graphicsContext.RestoreClipRegion();
+        CGUIControl::Render();
+        return;
+      }
+    }
+
 #ifndef HAS_SDL
     LPDIRECT3DDEVICE8 p3DDevice = g_graphicsContext.Get3DDevice();
     // Set state to render the image
-    p3DDevice->SetTexture( 0, m_vecTextures[m_iCurrentImage] );
+    {
+      GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_TEXTURE, "bind", GetID())
+      p3DDevice->SetTexture( 0, m_vecTextures[m_iCurrentImage] );
+    }
     p3DDevice->SetTextureStageState( 0, D3DTSS_MAGFILTER, D3DTEXF_LINEAR );
     p3DDevice->SetTextureStageState( 0, D3DTSS_MINFILTER, D3DTEXF_LINEAR );
     p3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_MODULATE );
@@ -216,11 +234,14 @@ void CGUIImage::Render()
 #ifdef HAS_SDL_OPENGL
     CGLTexture* texture = m_vecTextures[m_iCurrentImage];
     glActiveTextureARB(GL_TEXTURE0_ARB);
-    texture->LoadToGPU();
-    if (m_diffuseTexture)
-      m_diffuseTexture->LoadToGPU();
+    {
+      GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_TEXTURE, "bind", GetID())
+      texture->LoadToGPU();
+      if (m_diffuseTexture)
+        m_diffuseTexture->LoadToGPU();
 
-    glBindTexture(GL_TEXTURE_2D, texture->id);
+      glBindTexture(GL_TEXTURE_2D, texture->id);
+    }
     glEnable(GL_TEXTURE_2D);
     
     glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
@@ -348,6 +369,57 @@ void CGUIImage::Render()
   CGUIControl::Render();
 }
 
+void CGUIImage::AddDirtyRegionPrimitive()
+{
+  CRect vertex(m_fX, m_fY, m_fX + m_fNW, m_fY + m_fNH);
+  CRect texture(0, 0, m_fU, m_fV);
+  g_graphicsContext.ClipRect(vertex, texture);
+  if (vertex.IsEmpty())
+    return;
+
+  // the segments are all drawn from the same state, so one primitive covers the lot:
+  // where the corners end up on screen, their colours, and what's drawn with what
+  float corners[8];
+  corners[0] = g_graphicsContext.ScaleFinalXCoord(vertex.x1, vertex.y1);
+  corners[1] = g_graphicsContext.ScaleFinalYCoord(vertex.x1, vertex.y1);
+  corners[2] = g_graphicsContext.ScaleFinalXCoord(vertex.x2, vertex.y1);
+  corners[3] = g_graphicsContext.ScaleFinalYCoord(vertex.x2, vertex.y1);
+  corners[4] = g_graphicsContext.ScaleFinalXCoord(vertex.x2, vertex.y2);
+  corners[5] = g_graphicsContext.ScaleFinalYCoord(vertex.x2, vertex.y2);
+  corners[6] = g_graphicsContext.ScaleFinalXCoord(vertex.x1, vertex.y2);
+  corners[7] = g_graphicsContext.ScaleFinalYCoord(vertex.x1, vertex.y2);
+
+  DWORD colors[4];
+  for (int i = 0; i < 4; i++)
+  {
+    DWORD color = m_diffuseColor;
+    if (m_alpha[i] != 0xFF) color = MIX_ALPHA(m_alpha[i], color);
+    colors[i] = g_graphicsContext.MergeAlpha(color);
+  }
+
+  float coords[8] = { texture.x1, texture.y1, texture.x2, texture.y2,
+                      m_diffuseScaleU, m_diffuseScaleV, m_diffuseOffset.x, m_diffuseOffset.y };
+  const void *textures[2] = { m_vecTextures[m_iCurrentImage], m_diffuseTexture };
+  int orientations[2] = { GetOrientation(), m_image.orientation };
+
+  DWORD hash = CDirtyRegionTracker::Hash(corners, sizeof(corners));
+  hash = CDirtyRegionTracker::Hash(colors, sizeof(colors), hash);
+  hash = CDirtyRegionTracker::Hash(coords, sizeof(coords), hash);
+  hash = CDirtyRegionTracker::Hash(textures, sizeof(textures), hash);
+  hash = CDirtyRegionTracker::Hash(orientations, sizeof(orientations), hash);
+  hash = CDirtyRegionTracker::Hash(m_strFileName.c_str(), m_strFileName.size(), hash);
+
+  float x1 = corners[0], y1 = corners[1], x2 = corners[0], y2 = corners[1];
+  for (int i = 2; i < 8; i += 2)
+  {
+    if (corners[i] < x1) x1 = corners[i];
+    if (corners[i] > x2) x2 = corners[i];
+    if (corners[i + 1] < y1) y1 = corners[i + 1];
+    if (corners[i + 1] > y2) y2 = corners[i + 1];
+  }
+  g_dirtyRegionTracker.AddPrimitive(hash, x1, y1, x2, y2);
+}
+
 void CGUIImage::Render(float left, float top, float right, float bottom, float u1, float v1, float u2, float v2)
 {
 #ifndef HAS_SDL
@@ -648,7 +720,10 @@ bool CGUIImage::OnMessage(CGUIMessage& message)
   if (message.GetMessage() == GUI_MSG_REFRESH_THUMBS)
   {
     if (!m_image.file.IsConstant())
+    {
+      CPicture::ForgetThumbVariants(m_strFileName); // the thumb may have been replaced
       FreeTextures(true); // true as we want to free the texture immediately
+    }
     return true;
   }
   return CGUIControl::OnMessage(message);
@@ -673,7 +748,9 @@ void CGUIImage::AllocResources()
   m_iCurrentImage = 0;
   m_iCurrentLoop = 0;
 
-  int iImages = g_TextureManager.Load(m_strFileName, m_dwColorKey);
+  // use the smallest up to date pre-scaled variant of cached thumbs that covers what we draw, if there is one
+  m_strTextureFile = CPicture::GetBestThumbVariant(m_strFileName, GetThumbVariantSize());
+  int iImages = g_TextureManager.Load(m_strTextureFile, m_dwColorKey);
   // set allocated to true even if we couldn't load the image to save
   // use hitting the disk every frame
   m_texturesAllocated = true;
@@ -688,7 +765,7 @@ void CGUIImage::AllocResources()
     CGLTexture* pTexture;
 #endif
 
-    pTexture = g_TextureManager.GetTexture(m_strFileName, i, m_iTextureWidth, m_iTextureHeight, m_pPalette, m_linearTexture);
+    pTexture = g_TextureManager.GetTexture(m_strTextureFile, i, m_iTextureWidth, m_iTextureHeight, m_pPalette, m_linearTexture);
 
 #ifndef HAS_XBOX_D3D
     m_linearTexture = false;
@@ -700,10 +777,52 @@ void CGUIImage::AllocResources()
   }
 
   CalculateSize();
+  if (m_iTextureWidth && m_iTextureHeight) // so the next allocation can pick the right variant
+    CPicture::SetThumbAspect(m_strFileName, (float)m_iTextureWidth / m_iTextureHeight);
 
   LoadDiffuseImage();
 }
 
+// Returns how large (on its longer side) a pre-scaled variant of our image must be to cover the
+// screen pixels it's drawn over, or INT_MAX if we need the full image.
+int CGUIImage::GetThumbVariantSize() const
+{
+  // we're sized from the texture, or draw it at its own size
+  if (m_width == 0 || m_height == 0 || m_aspect.ratio == CAspectRatio::AR_CENTER)
+    return INT_MAX;
+
+  float width = m_width * g_graphicsContext.GetGUIScaleX();
+  float height = m_height * g_graphicsContext.GetGUIScaleY();
+  float aspect = CPicture::GetThumbAspect(m_strFileName);
+  if (aspect == 0)
+  { // until we know the image's shape only a kept aspect stays within our size
+    if (m_aspect.ratio != CAspectRatio::AR_KEEP)
+      return INT_MAX;
+    return (int)ceilf(std::max(width, height));
+  }
+  if (GetOrientation() & 4)
+    aspect = 1.0f / aspect;
+
+  if (m_aspect.ratio != CAspectRatio::AR_STRETCH)
+  { // the size CalculateSize() will draw it at
+    float outputRatio = aspect / g_graphicsContext.GetScalingPixelRatio();
+    float drawWidth = m_width;
+    float drawHeight = drawWidth / outputRatio;
+    if ((m_aspect.ratio == CAspectRatio::AR_SCALE && drawHeight < m_height) ||
+        (m_aspect.ratio == CAspectRatio::AR_KEEP && drawHeight > m_height))
+    {
+      drawHeight = m_height;
+      drawWidth = drawHeight * outputRatio;
+    }
+    width = drawWidth * g_graphicsContext.GetGUIScaleX();
+    height = drawHeight * g_graphicsContext.GetGUIScaleY();
+  }
+
+  // the variant's sides are size * aspect / longer and size / longer
+  float longer = std::max(aspect, 1.0f);
+  return (int)ceilf(std::max(width * longer / aspect, height * longer));
+}
+
 void CGUIImage::LoadDiffuseImage()
 {
   m_diffuseScaleU = m_diffuseScaleV = 1.0f;
@@ -759,7 +878,7 @@ void CGUIImage::FreeTextures(bool immediately /* = false */)
 {
   for (int i = 0; i < (int)m_vecTextures.size(); ++i)
   {
-    g_TextureManager.ReleaseTexture(m_strFileName, i);
+    g_TextureManager.ReleaseTexture(m_strTextureFile, i);
 #ifdef HAS_SDL_2D
     if (m_vecCachedTextures[i].surface)
       SDL_FreeSurface(m_vecCachedTextures[i].surface);
@@ -931,8 +1050,8 @@ void CGUIImage::Process()
     return ;
 
   m_dwFrameCounter++;
-  DWORD dwDelay = g_TextureManager.GetDelay(m_strFileName, m_iCurrentImage);
-  int iMaxLoops = g_TextureManager.GetLoops(m_strFileName, m_iCurrentImage);
+  DWORD dwDelay = g_TextureManager.GetDelay(m_strTextureFile, m_iCurrentImage);
+  int iMaxLoops = g_TextureManager.GetLoops(m_strTextureFile, m_iCurrentImage);
   if (!dwDelay) dwDelay = 100;
   if (m_dwFrameCounter*40 >= dwDelay)
   {
@@ -158,16 +158,19 @@ public:
 #endif
 protected:
   void LoadDiffuseImage();
+  int GetThumbVariantSize() const;
   virtual void AllocateOnDemand();
   virtual void FreeTextures(bool immediately = false);
   void Process();
   void Render(float left, float top, float bottom, float right, float u1, float v1, float u2, float v2);
   virtual int GetOrientation() const { return m_image.orientation; };
   void OrientateTexture(CRect &rect, int orientation);
+  void AddDirtyRegionPrimitive();
 
   DWORD m_dwColorKey;
   unsigned char m_alpha[4];
   CStdString m_strFileName;
+  CStdString m_strTextureFile;   // file actually loaded - may be a pre-scaled variant of m_strFileName
   int m_iTextureWidth;
   int m_iTextureHeight;
   int m_iImageWidth;
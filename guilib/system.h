@@ -231,6 +231,11 @@
 
 #endif
 
+// per-frame GUI render profiler - debug builds only
+#if defined(_DEBUG) && !defined(_XBOX)
+#define HAS_GUI_PROFILER
+#endif
+
 #if (defined(HAS_XBOX_D3D)  && defined(HAS_SDL))
 #error "Cannot have both HAS_XBOX_D3D and HAS_SDL defined simultaneously!"
 #endif
@@ -6,9 +6,15 @@
 // HDD sector = 512 bytes, DVD/CD sector = 2048 bytes
 // XBMC supports caching of texures on the HDD for DVD loads, so this can be 512
 #define ALIGN (512)
+// version 3 bundles align each texture to the page size, so that a memory mapped
+// bundle can be read ahead and decompressed texture by texture
+#define ALIGN_V3 (4096)
 
-bool CBundler::StartBundle()
+bool CBundler::StartBundle(int BundleVersion)
 {
+	Version = BundleVersion;
+	Align = (Version >= 3) ? ALIGN_V3 : ALIGN;
+
 	Data = (BYTE*)VirtualAlloc(0, 512 * 1024 * 1024, MEM_RESERVE, PAGE_NOACCESS);
 	if (!Data)
 	{
@@ -29,10 +35,10 @@ int CBundler::WriteBundle(const char* Filename, int NoProtect)
 	DWORD Offset = sizeof(XPR_FILE_HEADER) + FileHeaders.size() * sizeof(FileHeader_t);
 
 	// setup header
-	XPRHeader.dwMagic = XPR_MAGIC_HEADER_VALUE | ((2+(NoProtect << 7)) << 24); // version 2
+	XPRHeader.dwMagic = XPR_MAGIC_HEADER_VALUE | ((Version+(NoProtect << 7)) << 24);
 	XPRHeader.dwHeaderSize = Offset;
 
-	Offset = (Offset + (ALIGN-1)) & ~(ALIGN-1);
+	Offset = (Offset + (Align-1)) & ~(Align-1);
 	XPRHeader.dwTotalSize = Offset + DataSize;
 
 	// buffer data
@@ -109,7 +115,7 @@ bool CBundler::AddFile(const char* Filename, int nBuffers, const void** Buffers,
 
 	VirtualFree(buf, 0, MEM_RELEASE);
 
-	DataSize += (Header.PackedSize + (ALIGN-1)) & ~(ALIGN-1);
+	DataSize += (Header.PackedSize + (Align-1)) & ~(Align-1);
 	FileHeaders.push_back(Header);
 	return true;
 }
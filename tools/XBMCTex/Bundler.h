@@ -14,12 +14,14 @@ class CBundler
 	std::list<FileHeader_t> FileHeaders;
 	BYTE* Data;
 	DWORD DataSize;
+	int Version;
+	DWORD Align;
 
 public:
 	CBundler() {}
 	~CBundler() {}
 
-	bool StartBundle();
+	bool StartBundle(int BundleVersion = 2);
 	int WriteBundle(const char* Filename, int NoProtect);
 
 	bool AddFile(const char* Filename, int nBuffers, const void** Buffers, DWORD* Sizes);
@@ -941,11 +941,13 @@ void Usage()
 	puts("  -quality <qual>  Quality setting (min, low, normal, high, max). Default: normal");
   puts("  -noprotect       XPR contents viewable at full quality in skin editor");
   puts("  -onlyswizzled    Only allow swizzled textures (faster rendering, larger memory use) rather than linear textures");
+  puts("  -version <ver>   Bundle format version (2, 3). Version 3 page aligns textures for memory mapped loading. Default: 2");
 }
 
 int main(int argc, char* argv[])
 {
   int NoProtect = 0;
+  int BundleVersion = 2;
   AllowLinear = true;
   double MaxMSE = 4.0;
 
@@ -983,6 +985,15 @@ int main(int argc, char* argv[])
     {
       AllowLinear = false;
     }
+    else if (!stricmp(args[i], "-version") || !stricmp(args[i], "-v"))
+    {
+      BundleVersion = atoi(args[++i]);
+      if (BundleVersion != 2 && BundleVersion != 3)
+      {
+        printf("Unsupported bundle version: %s\n", args[i]);
+        return 1;
+      }
+    }
     else if (!stricmp(args[i], "-quality") || !stricmp(args[i], "-q"))
 		{
 			++i;
@@ -1059,7 +1070,7 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
-	Bundler.StartBundle();
+	Bundler.StartBundle(BundleVersion);
 
 	// Scan the input directory (or current dir if false) for media files
 	ConvertDirectory(InputDir, NULL, MaxMSE);
@@ -71,6 +71,7 @@
 #include "cores/DllLoader/DllLoaderContainer.h"
 #include "GUIUserMessages.h"
 #include "FileSystem/DirectoryCache.h"
+#include "FileSystem/DirectoryJournal.h"
 #include "FileSystem/StackDirectory.h"
 #include "FileSystem/DllLibCurl.h"
 #include "FileSystem/CMythSession.h"
@@ -78,6 +79,8 @@
 #include "utils/SystemInfo.h"
 #include "ApplicationRenderer.h"
 #include "GUILargeTextureManager.h"
+#include "GUIProfiler.h"
+#include "DirtyRegionTracker.h"
 #include "LastFmManager.h"
 #include "SmartPlaylist.h"
 #include "FileSystem/RarManager.h"
@@ -187,6 +190,9 @@
 #include "GUIDialogLockSettings.h"
 #include "GUIDialogContentSettings.h"
 #include "GUIDialogVideoScan.h"
+#include "utils/LibraryViewCache.h"
+#include "VideoThumbExtractor.h"
+#include "utils/JobManager.h"
 #include "GUIDialogBusy.h"
 
 #include "GUIDialogKeyboard.h"
@@ -426,6 +432,7 @@ CApplication::CApplication(void)
 #endif
 
   m_bPresentFrame = false;
+  m_bFrameDrawn = true;
   m_bPlatformDirectories = false;
 
   m_logPath = NULL;
@@ -2915,6 +2922,8 @@ void CApplication::RenderNoPresent()
   // don't do anything that would require graphiccontext to be locked before here in fullscreen.
   // that stuff should go into renderfullscreen instead as that is called from the renderin thread
 
+  m_bFrameDrawn = true;
+
   // dont show GUI when playing full screen video
   if (g_graphicsContext.IsFullScreenVideo() && IsPlaying() && !IsPaused())
   {
@@ -2970,10 +2979,22 @@ void CApplication::DoRender()
   m_pd3dDevice->BeginScene();
 #endif
 
+  GUIPROFILER_BEGIN_FRAME
+
   m_gWindowManager.UpdateModelessVisibility();
 
+  g_largeTextureManager.StartFrame();
+
+  // the slideshow, test pattern and screensaver draw straight to the screen, so can't be tracked
+  bool canTrack = !g_graphicsContext.IsFullScreenVideo() &&
+                  !m_gWindowManager.IsWindowActive(WINDOW_SLIDESHOW) &&
+                  !m_gWindowManager.IsWindowActive(WINDOW_TEST_PATTERN) &&
+                  !m_gWindowManager.IsWindowActive(WINDOW_SCREENSAVER);
+  m_bFrameDrawn = g_dirtyRegionTracker.BeginFrame(canTrack);
+
   // draw GUI
-  g_graphicsContext.Clear();
+  if (m_bFrameDrawn)
+    g_graphicsContext.Clear();
   //SWATHWIDTH of 4 improves fillrates (performance investigator)
 #ifdef HAS_XBOX_D3D
   m_pd3dDevice->SetRenderState(D3DRS_SWATHWIDTH, 4);
@@ -3050,14 +3071,21 @@ void CApplication::DoRender()
     }
 
     RenderMemoryStatus();
+    GUIPROFILER_RENDER_OVERLAY
+
+    g_dirtyRegionTracker.EndFrame();
+    g_dirtyRegionTracker.RenderOverlay();
   }
 
+  GUIPROFILER_END_FRAME
+
 #ifndef HAS_SDL
   m_pd3dDevice->EndScene();
 #endif
 
 #ifdef HAS_XBOX_D3D
-  m_pd3dDevice->Present( NULL, NULL, NULL, NULL );
+  if (m_bFrameDrawn)
+    m_pd3dDevice->Present( NULL, NULL, NULL, NULL );
 #endif
   g_graphicsContext.Unlock();
 
@@ -3133,11 +3161,12 @@ void CApplication::Render()
     }
     else
     {
-      // only "limit frames" if we are not using vsync.
+      // only "limit frames" if we are not using vsync, or if the last frame was
+      // unchanged and so wasn't flipped (and didn't wait on vsync).
       double graphicsFPS = (double)g_infoManager.GetFPS();
       double screenFPS = (double)g_graphicsContext.GetFPS();
 
-      if (g_videoConfig.GetVSyncMode() != VSYNC_ALWAYS ||
+      if (g_videoConfig.GetVSyncMode() != VSYNC_ALWAYS || !m_bFrameDrawn ||
           (graphicsFPS > screenFPS + 10) && graphicsFPS > 1000/singleFrameTime)
       {
         if (lastFrameTime + singleFrameTime > currentTime)
@@ -3164,14 +3193,17 @@ void CApplication::Render()
   }
   g_graphicsContext.Lock();
   RenderNoPresent();
-  // Present the backbuffer contents to the display
+  // Present the backbuffer contents to the display, unless nothing changed
+  if (m_bFrameDrawn)
+  {
 #ifndef HAS_SDL
-  if (m_pd3dDevice) m_pd3dDevice->Present( NULL, NULL, NULL, NULL );
+    if (m_pd3dDevice) m_pd3dDevice->Present( NULL, NULL, NULL, NULL );
 #elif defined(HAS_SDL_2D)
-  g_graphicsContext.Flip();
+    g_graphicsContext.Flip();
 #elif defined(HAS_SDL_OPENGL)
-  g_graphicsContext.Flip();
+    g_graphicsContext.Flip();
 #endif
+  }
   g_graphicsContext.Unlock();
 }
 #endif
@@ -4556,6 +4588,11 @@ void CApplication::Stop()
     CGUIDialogVideoScan *videoScan = (CGUIDialogVideoScan *)m_gWindowManager.GetWindow(WINDOW_DIALOG_VIDEO_SCAN);
     if (videoScan /*&& videoScan->IsDialogRunning()*/)
       videoScan->StopScanning();
+
+    g_libraryViewCache.Stop();
+    g_directoryWatcher.Stop();
+    g_videoThumbExtractor.Stop();
+    g_jobManager.Stop();
     
     m_bStop = true;
     CLog::Log(LOGNOTICE, "stop all");
@@ -6192,6 +6229,12 @@ void CApplication::ProcessSlow()
   if (g_guiSettings.GetString("screensaver.mode") != "None")
     CheckScreenSaver();
 
+#ifdef HAS_UPNP
+  // let control points know the library has changed, rather than waiting for them to browse
+  if (CUPnP::IsInstantiated())
+    CUPnP::GetInstance()->UpdateServerState();
+#endif
+
 #ifdef __APPLE__
    // If playing video tickle system, or else if in full-screen always tickle.
    if (((IsPlayingVideo() && !m_pPlayer->IsPaused()) && ((timeGetTime() - m_dwOSXscreensaverTicks) > 5000)) ||
@@ -6707,6 +6750,9 @@ void CApplication::CheckPlayingProgress()
         {
           musicdatabase.IncrTop100CounterByFileName(m_itemCurrentFile->m_strPath);
           musicdatabase.Close();
+          // the top 100 views are the only ones that depend on the play count
+          CFileItemList("musicdb://5/1/").RemoveDiscCache();
+          CFileItemList("musicdb://5/2/").RemoveDiscCache();
         }
       }
     }
@@ -287,6 +287,7 @@ protected:
   int m_nextPlaylistItem;
 
   bool m_bPresentFrame;
+  bool m_bFrameDrawn;     // false if the last GUI frame was unchanged, and so not drawn
 
   char* m_logPath;
 
@@ -448,7 +448,12 @@ void CApplicationMessenger::ProcessMessage(ThreadMessage *pMsg)
         CSectionLoader::Load("LIBHTTP");
         m_pXbmcHttp = new CXbmcHttp();
       }
+      // the response buffer is only used on this thread, and is handed back to the
+      // sender with the message so that callers on other threads don't share it
+      SetResponse("");
       int ret=m_pXbmcHttp->xbmcCommand(pMsg->strParam);
+      if (pMsg->lpVoid)
+        *(CStdString *)pMsg->lpVoid = GetResponse();
       switch(ret)
       {
       case 1:
@@ -590,12 +595,15 @@ CStdString CApplicationMessenger::GetResponse()
   return tmp;
 }
 
-void CApplicationMessenger::HttpApi(string cmd, bool wait)
+CStdString CApplicationMessenger::HttpApi(string cmd, bool wait)
 {
-  SetResponse("");
+  CStdString response;
   ThreadMessage tMsg = {TMSG_HTTPAPI};
   tMsg.strParam = cmd;
+  if (wait)
+    tMsg.lpVoid = &response;
   SendMessage(tMsg, wait);
+  return response;
 }
 
 void CApplicationMessenger::ExecBuiltIn(const CStdString &command)
@@ -109,7 +109,7 @@ public:
 
   CStdString GetResponse();
   int SetResponse(CStdString response);
-  void HttpApi(std::string cmd, bool wait = false);
+  CStdString HttpApi(std::string cmd, bool wait = false); // returns the command's response when waiting
   void ExecBuiltIn(const CStdString &command);
 
   void NetworkMessage(DWORD dwMessage, DWORD dwParam = 0);
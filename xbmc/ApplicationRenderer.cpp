@@ -25,6 +25,7 @@
 #include "guiImage.h"
 #include "Settings.h"
 #include "GUIWindowManager.h"
+#include "DirtyRegionTracker.h"
 
 CApplicationRenderer g_ApplicationRenderer;
 
@@ -248,6 +249,7 @@ void CApplicationRenderer::Process()
           g_graphicsContext.Get3DDevice()->EndScene();
           //D3DSWAPEFFECT_DISCARD is used so we can't just present the busy rect but can only present the entire screen.
           g_graphicsContext.Get3DDevice()->Present( NULL, NULL, NULL, NULL );
+          g_dirtyRegionTracker.MarkDirty();
         }
         m_busycount++;
         m_prevbusycount = m_busycount;
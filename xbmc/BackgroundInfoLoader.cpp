@@ -23,6 +23,9 @@
 #include "BackgroundInfoLoader.h"
 #include "FileItem.h"
 
+#include <map>
+#include <algorithm>
+
 #ifdef _XBOX
 #define ITEMS_PER_THREAD 10
 #define MAX_THREAD_COUNT 2
@@ -31,16 +34,40 @@
 #define MAX_THREAD_COUNT 5
 #endif
 
+// how many screenfuls of items around those on screen are moved to the front of the queue
+#define PRIORITIZED_PAGES 4
+
+using namespace std;
+
+static bool RankLess(const pair<int, CFileItemPtr> &left, const pair<int, CFileItemPtr> &right)
+{
+  return left.first < right.first;
+}
+
+class CBackgroundInfoLoader::CLoaderJob : public CJob
+{
+public:
+  CLoaderJob(CBackgroundInfoLoader *loader, unsigned int generation) : m_loader(loader), m_generation(generation) {}
+  virtual void DoWork() { m_loader->Run(m_generation); }
+private:
+  CBackgroundInfoLoader *m_loader;
+  unsigned int m_generation;
+};
+
 CBackgroundInfoLoader::CBackgroundInfoLoader(int nThreads)
 {
   m_bRunning = false;
   m_bStop = true;
+  m_bIndependentItems = false;
   m_pObserver=NULL;
   m_pProgressCallback=NULL;
   m_pVecItems = NULL;
   m_nRequestedThreads = nThreads;
   m_bStartCalled = false;
   m_nActiveThreads = 0;
+  m_generation = 0;
+  m_visibleFirst = 0;
+  m_visibleCount = 0;
 }
 
 CBackgroundInfoLoader::~CBackgroundInfoLoader()
@@ -53,119 +80,133 @@ void CBackgroundInfoLoader::SetNumOfWorkers(int nThreads)
   m_nRequestedThreads = nThreads;
 }
 
-void CBackgroundInfoLoader::Run()
+void CBackgroundInfoLoader::Run(unsigned int generation)
 {
   try
   {
-    if (m_vecItems.size() > 0)
     {
+      CSingleLock lock(m_lock);
+      if (generation != m_generation)
+        return; // the load was abandoned before we started
+      if (!m_bStartCalled)
       {
-        CSingleLock lock(m_lock);
-        if (!m_bStartCalled)
-        {
-          OnLoaderStart();
-          m_bStartCalled = true;
-        }
+        OnLoaderStart();
+        m_bStartCalled = true;
       }
+    }
 
-      while (!m_bStop)
-      {
-        CSingleLock lock(m_lock);
-        CFileItemPtr pItem;
-        std::vector<CFileItemPtr>::iterator iter = m_vecItems.begin();
-        if (iter != m_vecItems.end())
-        {
-          pItem = *iter;
-          m_vecItems.erase(iter);
-        }
+    while (!m_bStop)
+    {
+      CSingleLock lock(m_lock);
+      if (generation != m_generation || m_queue.empty())
+        break;
 
-        if (pItem == NULL)
-          break;
+      CFileItemPtr pItem = m_queue.front();
+      m_queue.pop_front();
 
-        // Ask the callback if we should abort
-        if (m_pProgressCallback && m_pProgressCallback->Abort())
-          m_bStop=true;
+      // Ask the callback if we should abort
+      if (m_pProgressCallback && m_pProgressCallback->Abort())
+        m_bStop=true;
 
-        lock.Leave();
-        try
-        {
-          if (!m_bStop && LoadItem(pItem.get()) && m_pObserver)
-            m_pObserver->OnItemLoaded(pItem.get());
-        }
-        catch (...)
-        {
-          CLog::Log(LOGERROR, "%s::LoadItem - Unhandled exception for item %s", __FUNCTION__, pItem->m_strPath.c_str());
+      lock.Leave();
+      try
+      {
+        if (!m_bStop && LoadItem(pItem.get()))
+        { // Load() or StopThread() on another thread may have moved on while we were loading
+          IBackgroundLoaderObserver *observer = NULL;
+          {
+            CSingleLock observerLock(m_lock);
+            if (generation == m_generation)
+              observer = m_pObserver;
+          }
+          if (observer)
+            observer->OnItemLoaded(pItem.get());
         }
       }
+      catch (...)
+      {
+        CLog::Log(LOGERROR, "%s::LoadItem - Unhandled exception for item %s", __FUNCTION__, pItem->m_strPath.c_str());
+      }
     }
 
     CSingleLock lock(m_lock);
-    if (m_nActiveThreads == 1)
-      OnLoaderFinish();
-    m_nActiveThreads--;
-
+    if (generation == m_generation)
+    {
+      if (m_nActiveThreads == 1)
+        OnLoaderFinish();
+      m_nActiveThreads--;
+    }
   }
   catch (...)
   {
-    m_nActiveThreads--;
+    CSingleLock lock(m_lock);
+    if (generation == m_generation)
+      m_nActiveThreads--;
     CLog::Log(LOGERROR, "%s - Unhandled exception", __FUNCTION__);
   }
 }
 
 void CBackgroundInfoLoader::Load(CFileItemList& items)
 {
-  StopThread();
+  StopThread(false);
 
   if (items.Size() == 0)
     return;
   
-  EnterCriticalSection(m_lock);
+  CSingleLock lock(m_lock);
 
   for (int nItem=0; nItem < items.Size(); nItem++)
-    m_vecItems.push_back(items[nItem]);
+    m_queue.push_back(items[nItem]);
 
   m_pVecItems = &items;
   m_bRunning = true;
   m_bStop = false;
   m_bStartCalled = false;
+  Prioritize();
 
   int nThreads = m_nRequestedThreads;
   if (nThreads == -1)
-    nThreads = (m_vecItems.size() / (ITEMS_PER_THREAD+1)) + 1;
+    nThreads = (m_queue.size() / (ITEMS_PER_THREAD+1)) + 1;
 
   if (nThreads > MAX_THREAD_COUNT)
     nThreads = MAX_THREAD_COUNT;
 
+  // each worker job runs Run(), taking items off m_queue until there are none left
   m_nActiveThreads = nThreads;
+  if (!m_token)
+    m_token.reset(new CJobToken);
   for (int i=0; i < nThreads; i++)
-  {
-    CThread *pThread = new CThread(this); 
-    pThread->Create();
-#ifndef _LINUX
-    pThread->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
-#endif
-    pThread->SetName("Background Loader");
-    m_workers.push_back(pThread);
-  }
-      
-  LeaveCriticalSection(m_lock);
+    g_jobManager.Submit(CJobPtr(new CLoaderJob(this, m_generation)), CJobManager::PRIORITY_HIGH, m_token);
 }
 
-void CBackgroundInfoLoader::StopThread()
+void CBackgroundInfoLoader::StopThread(bool wait)
 {
+  if (!wait && m_bIndependentItems)
+  { // drop the queue and move on - the jobs notice the new generation and stop, and
+    // results for items they're part way through are thrown away
+    CSingleLock lock(m_lock);
+    m_queue.clear();
+    if (m_nActiveThreads > 0 && m_bStartCalled)
+      OnLoaderFinish();
+    m_generation++;
+    m_pVecItems = NULL;
+    m_bRunning = false;
+    m_nActiveThreads = 0;
+    return;
+  }
+
   m_bStop = true;
   EnterCriticalSection(m_lock);
-  m_vecItems.clear();
+  m_queue.clear();
   LeaveCriticalSection(m_lock);
 
-  for (int i=0; i<(int)m_workers.size(); i++)
+  // jobs that haven't started are dropped, and we wait for those that have
+  if (m_token)
   {
-    m_workers[i]->StopThread();
-    delete m_workers[i];
+    m_token->Cancel();
+    m_token.reset();
   }
 
-  m_workers.clear();
-
   m_pVecItems = NULL;
   m_bRunning = false;
   m_nActiveThreads = 0;
@@ -178,6 +219,7 @@ bool CBackgroundInfoLoader::IsLoading()
 
 void CBackgroundInfoLoader::SetObserver(IBackgroundLoaderObserver* pObserver)
 {
+  CSingleLock lock(m_lock);
   m_pObserver = pObserver;
 }
 
@@ -186,3 +228,55 @@ void CBackgroundInfoLoader::SetProgressCallback(IProgressCallback* pCallback)
   m_pProgressCallback = pCallback;
 }
 
+void CBackgroundInfoLoader::SetVisibleItems(int first, int count)
+{
+  CSingleLock lock(m_lock);
+  m_visibleFirst = first;
+  m_visibleCount = count;
+  Prioritize();
+}
+
+void CBackgroundInfoLoader::Prioritize()
+{
+  if (!m_pVecItems || m_queue.size() < 2 || m_visibleCount <= 0)
+    return;
+
+  // This runs on the GUI thread for each scroll step, so only the few pages around what's
+  // on screen are ranked (by where they are in the list now - it may have been sorted
+  // since the load started): the visible items first, then working outwards from them,
+  // alternating below and above.
+  int size = m_pVecItems->Size();
+  int first = std::max(0, std::min(m_visibleFirst, size));
+  int end = std::min(size, first + m_visibleCount);
+  int limit = m_visibleCount * PRIORITIZED_PAGES;
+  map<CFileItem *, int> ranks;
+  int rank = 0;
+  for (int i = first; i < end; i++)
+    ranks[(*m_pVecItems)[i].get()] = rank++;
+  for (int below = end, above = first - 1; rank < limit && (below < size || above >= 0); )
+  {
+    if (below < size)
+      ranks[(*m_pVecItems)[below++].get()] = rank++;
+    if (above >= 0 && rank < limit)
+      ranks[(*m_pVecItems)[above--].get()] = rank++;
+  }
+
+  // move those that are still queued to the front, and leave the rest in the order they were
+  vector< pair<int, CFileItemPtr> > ranked;
+  deque<CFileItemPtr> rest;
+  for (deque<CFileItemPtr>::const_iterator i = m_queue.begin(); i != m_queue.end(); ++i)
+  {
+    map<CFileItem *, int>::const_iterator ranking = ranks.find(i->get());
+    if (ranking != ranks.end())
+      ranked.push_back(make_pair(ranking->second, *i));
+    else
+      rest.push_back(*i);
+  }
+  if (ranked.empty())
+    return;
+  sort(ranked.begin(), ranked.end(), RankLess);
+
+  m_queue.swap(rest);
+  for (int i = (int)ranked.size() - 1; i >= 0; i--)
+    m_queue.push_front(ranked[i].second);
+}
@@ -21,11 +21,11 @@
  *
  */
 
-#include "utils/Thread.h"
 #include "IProgressCallback.h"
 #include "utils/CriticalSection.h"
+#include "utils/JobManager.h"
 
-#include <vector>
+#include <deque>
 #include "boost/shared_ptr.hpp"
 
 class CFileItem; typedef boost::shared_ptr<CFileItem> CFileItemPtr;
@@ -38,7 +38,18 @@ public:
   virtual void OnItemLoaded(CFileItem* pItem) = 0;
 };
 
-class CBackgroundInfoLoader : public IRunnable
+/*!
+ \brief Loads extra information (thumbs, tags) for the items of a listing on the job manager.
+
+ Items are loaded in list order, except that the items on screen (see SetVisibleItems) go first,
+ followed by those nearest to them, so the rows the user is looking at fill in before the rest.
+ The window passes on the visible range whenever it changes, and the queue is reordered.
+
+ Loaders whose LoadItem() only touches the item it's given set m_bIndependentItems.  Stopping
+ one of those, or starting it on the next listing, drops the queued items at once without waiting
+ for those already being loaded - their results are discarded.
+ */
+class CBackgroundInfoLoader
 {
 public:
   CBackgroundInfoLoader(int nThreads=-1);
@@ -46,32 +57,46 @@ public:
 
   void Load(CFileItemList& items);
   bool IsLoading();
-  virtual void Run();
   void SetObserver(IBackgroundLoaderObserver* pObserver);
   void SetProgressCallback(IProgressCallback* pCallback);
   virtual bool LoadItem(CFileItem* pItem) { return false; };
 
-  void StopThread(); // will actually stop all worker threads.
+  /*! \brief Stop loading
+   \param wait wait for items that are being loaded.  Ignored (always waits) unless m_bIndependentItems is set.
+   */
+  void StopThread(bool wait = true); // will actually stop all worker jobs.
 
-  void SetNumOfWorkers(int nThreads); // -1 means auto compute num of required threads
+  void SetNumOfWorkers(int nThreads); // -1 means auto compute num of required jobs
+
+  /*! \brief Load the items first..first+count-1 of the list (as on screen) before any others
+   */
+  void SetVisibleItems(int first, int count);
 
 protected:
   virtual void OnLoaderStart() {};
   virtual void OnLoaderFinish() {};
 
   CFileItemList *m_pVecItems;
-  std::vector<CFileItemPtr> m_vecItems; // FileItemList would delete the items and we only want to keep a reference.
+  std::deque<CFileItemPtr> m_queue; // FileItemList would delete the items and we only want to keep a reference.
   CCriticalSection m_lock;
 
   bool m_bStartCalled;
   bool m_bRunning;
   bool m_bStop;
+  bool m_bIndependentItems; // LoadItem() only touches its item, so needn't be waited for when stopping
   int  m_nRequestedThreads;
   int  m_nActiveThreads;
 
   IBackgroundLoaderObserver* m_pObserver;
   IProgressCallback* m_pProgressCallback;
 
-  std::vector<CThread *> m_workers;
-};
+private:
+  class CLoaderJob;
+  void Run(unsigned int generation);
+  void Prioritize();
 
+  CJobTokenPtr m_token;       // for the worker jobs
+  unsigned int m_generation;  // bumped when a load is abandoned - its jobs then stop and their results are dropped
+  int m_visibleFirst;
+  int m_visibleCount;
+};
@@ -23,7 +23,10 @@
 #include "Database.h"
 #include "Util.h"
 #include "Settings.h"
+#include <algorithm>
+#include <set>
 
+using namespace std;
 using namespace AUTOPTR;
 using namespace dbiplus;
 
@@ -85,6 +88,125 @@ CStdString CDatabase::FormatSQL(CStdString strStmt, ...)
   return strResult;
 }
 
+// collects the output of GetArbitraryQuery into a string
+class CQueryString : public CDatabase::IQueryOutput
+{
+public:
+  CQueryString(CStdString &result) : m_result(result) {};
+  virtual bool Write(const CStdString &data) { m_result += data; return true; };
+private:
+  CStdString &m_result;
+};
+
+// state for the GetArbitraryQuery row callback
+struct ArbitraryQuery
+{
+  CDatabase::IQueryOutput *output;
+  const CStdString *openRecordSet, *openRecord, *closeRecord, *openField, *closeField;
+  int offset;
+  int limit;
+  int row;
+  bool started;
+  bool failed;
+};
+
+static bool ArbitraryQueryRow(const sql_record &record, void *data)
+{
+  ArbitraryQuery &query = *(ArbitraryQuery *)data;
+  if (!query.started)
+  { // the query was prepared fine, so the record set is on its way
+    query.started = true;
+    if (!query.output->Write(*query.openRecordSet))
+    {
+      query.failed = true;
+      return false;
+    }
+  }
+  if (query.row < query.offset)
+  {
+    query.row++;
+    return true;
+  }
+  if (query.limit >= 0 && query.row >= query.offset + query.limit)
+    return false; // we have all the rows that were asked for
+  query.row++;
+
+  CStdString strRecord = *query.openRecord;
+  for (unsigned int i = 0; i < record.size(); i++)
+  {
+    strRecord += *query.openField;
+    strRecord += record[i].get_asString();
+    strRecord += *query.closeField;
+  }
+  strRecord += *query.closeRecord;
+  if (!query.output->Write(strRecord))
+  {
+    query.failed = true;
+    return false;
+  }
+  return true;
+}
+
+bool CDatabase::GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet,
+                                  const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField,
+                                  const CStdString& strCloseField, CStdString& strResult)
+{
+  CStdString strOutput, strError;
+  CQueryString output(strOutput);
+  if (!GetArbitraryQuery(strQuery, strOpenRecordSet, strCloseRecordSet, strOpenRecord, strCloseRecord, strOpenField, strCloseField, output, strError))
+  {
+    strResult = strError;
+    return false;
+  }
+  strResult = strOutput;
+  return true;
+}
+
+bool CDatabase::GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet,
+                                  const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField,
+                                  const CStdString& strCloseField, IQueryOutput &output, CStdString& strError, int offset, int limit)
+{
+  ArbitraryQuery query;
+  query.output = &output;
+  query.openRecordSet = &strOpenRecordSet;
+  query.openRecord = &strOpenRecord;
+  query.closeRecord = &strCloseRecord;
+  query.openField = &strOpenField;
+  query.closeField = &strCloseField;
+  query.offset = offset;
+  query.limit = limit;
+  query.row = 0;
+  query.started = false;
+  query.failed = false;
+  try
+  {
+    strError = "";
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+    CStdString strSQL=FormatSQL(strQuery);
+    m_pDS->query_rows(strSQL.c_str(), ArbitraryQueryRow, &query);
+    if (query.failed)
+      return false;
+    if (!query.started && !output.Write(strOpenRecordSet))
+      return false;
+    return output.Write(strCloseRecordSet);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, strQuery.c_str());
+  }
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    strError = m_pDB->getErrorMsg();
+  }
+  catch (...)
+  {
+  }
+
+  return false;
+}
+
 bool CDatabase::Open()
 {
   if (IsOpen())
@@ -330,6 +452,172 @@ bool CDatabase::CreateTables()
     return true;
 }
 
+/* FNV-1a hash of the path.  Path lookups were previously done with "like", so
+   the path is lowercased first to keep them case insensitive. */
+__int64 CDatabase::HashPath(const CStdString &path)
+{
+  unsigned __int64 hash = 14695981039346656037ULL;
+  for (unsigned int i = 0; i < path.size(); i++)
+  {
+    hash ^= (unsigned char)tolower((unsigned char)path[i]);
+    hash *= 1099511628211ULL;
+  }
+  return (__int64)hash;
+}
+
+/* Fills in iPathHash for all rows of the path table and creates its unique
+   index.  Paths that differ only by case share a hash - only the first of
+   them (which is what the old "like" lookups returned) keeps it. */
+void CDatabase::UpdatePathHashes()
+{
+  CLog::Log(LOGINFO, "computing path hashes");
+  vector< pair<long, __int64> > paths;
+  m_pDS->query("select idPath, strPath from path order by idPath");
+  while (!m_pDS->eof())
+  {
+    paths.push_back(make_pair(m_pDS->fv(0).get_asLong(), HashPath(m_pDS->fv(1).get_asString())));
+    m_pDS->next();
+  }
+  m_pDS->close();
+
+  set<__int64> hashes;
+  for (unsigned int i = 0; i < paths.size(); i++)
+  {
+    if (hashes.insert(paths[i].second).second)
+      m_pDS->exec(FormatSQL("update path set iPathHash=%I64d where idPath=%ld", paths[i].second, paths[i].first).c_str());
+    else
+      CLog::Log(LOGWARNING, "%s - path %ld is a duplicate of an existing path", __FUNCTION__, paths[i].first);
+  }
+  m_pDS->exec("CREATE UNIQUE INDEX idxPathHash ON path(iPathHash)");
+}
+
+void CDatabase::CreateSearchIndex()
+{
+  CLog::Log(LOGINFO, "create searchindex table");
+  m_pDS->exec("CREATE TABLE searchindex ( strToken text, iType integer, idItem integer)\n");
+  m_pDS->exec("CREATE INDEX idxSearchIndex ON searchindex(iType, strToken)");
+  m_pDS->exec("CREATE INDEX idxSearchIndex2 ON searchindex(iType, idItem)");
+}
+
+/* Splits text into lower case words for the search index.  Anything that
+   isn't a letter or digit separates words, multibyte (utf8) characters are
+   kept as part of a word.  Duplicates are removed. */
+void CDatabase::GetSearchTokens(const CStdString &text, vector<CStdString> &tokens)
+{
+  CStdString token;
+  for (unsigned int i = 0; i <= text.size(); i++)
+  {
+    unsigned char c = i < text.size() ? (unsigned char)text[i] : 0;
+    if (c >= 0x80 || isalnum(c))
+      token += (char)tolower(c);
+    else if (!token.IsEmpty())
+    {
+      if (find(tokens.begin(), tokens.end(), token) == tokens.end())
+        tokens.push_back(token);
+      token.Empty();
+    }
+  }
+}
+
+CStdString CDatabase::FormatIdList(const vector<long> &ids)
+{
+  CStdString list = "(";
+  for (unsigned int i = 0; i < ids.size(); i++)
+  {
+    CStdString id;
+    id.Format(i ? ",%ld" : "%ld", ids[i]);
+    list += id;
+  }
+  list += ")";
+  return list;
+}
+
+void CDatabase::AddToSearchIndex(int type, long id, const CStdString &text)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    vector<CStdString> tokens;
+    GetSearchTokens(text, tokens);
+    for (unsigned int i = 0; i < tokens.size(); i++)
+      m_pDS->exec(FormatSQL("insert into searchindex (strToken, iType, idItem) values ('%s', %i, %ld)", tokens[i].c_str(), type, id).c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed for type %i, id %ld", __FUNCTION__, type, id);
+  }
+}
+
+void CDatabase::RemoveFromSearchIndex(int type, long id)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return;
+    if (NULL == m_pDS.get()) return;
+
+    m_pDS->exec(FormatSQL("delete from searchindex where iType=%i and idItem=%ld", type, id).c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed for type %i, id %ld", __FUNCTION__, type, id);
+  }
+}
+
+/* Finds the items of the given type that have a word starting with each word
+   of the search string.  Items where the first search word matches a whole
+   word come first, then those where it matches the shortest word.  Each word
+   is a range lookup on the (iType, strToken) index. */
+bool CDatabase::SearchIndex(int type, const CStdString &search, vector<long> &ids, unsigned int limit)
+{
+  ids.clear();
+  CStdString strSQL;
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    vector<CStdString> words;
+    GetSearchTokens(search, words);
+    if (words.empty())
+      return true;
+
+    // each word matches the tokens in [word, next) where next is the word
+    // with its last character incremented.  Tokens never contain 0xff.
+    vector<CStdString> next;
+    for (unsigned int i = 0; i < words.size(); i++)
+    {
+      CStdString upper = words[i];
+      upper[upper.size() - 1]++;
+      next.push_back(upper);
+    }
+
+    strSQL = FormatSQL("select idItem from searchindex where iType=%i and strToken>='%s' and strToken<'%s'",
+                       type, words[0].c_str(), next[0].c_str());
+    for (unsigned int i = 1; i < words.size(); i++)
+      strSQL += FormatSQL(" and idItem in (select idItem from searchindex where iType=%i and strToken>='%s' and strToken<'%s')",
+                          type, words[i].c_str(), next[i].c_str());
+    strSQL += FormatSQL(" group by idItem order by max(strToken='%s') desc, min(length(strToken))", words[0].c_str());
+    if (limit)
+      strSQL += FormatSQL(" limit %u", limit);
+
+    if (!m_pDS->query(strSQL.c_str())) return false;
+    while (!m_pDS->eof())
+    {
+      ids.push_back(m_pDS->fv(0).get_asLong());
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, strSQL.c_str());
+  }
+  return false;
+}
+
 bool CDatabase::UpdateOldVersion(int version)
 {
   try
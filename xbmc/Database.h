@@ -40,6 +40,34 @@ public:
   bool InTransaction();
 
   static CStdString FormatSQL(CStdString strStmt, ...);
+
+  /*! \brief Where GetArbitraryQuery writes its output as the rows are read
+   */
+  class IQueryOutput
+  {
+  public:
+    virtual ~IQueryOutput() {}
+    virtual bool Write(const CStdString &data)=0;
+  };
+
+  /*! \brief Run an arbitrary select, formatting the rows with the given tags.
+   \return false with the error message in strResult if the query fails.
+   */
+  bool GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet,
+                         const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField, const CStdString& strCloseField,
+                         CStdString& strResult);
+
+  /*! \brief Run an arbitrary select, writing each row to output as it is stepped so the
+   rows aren't kept in the dataset.  The buffered version above is this one collected into a string.
+   output is called with the statement open, which keeps the database locked against writers,
+   so it mustn't block (eg on a socket).
+   \param offset, limit only output this range of rows (limit -1 for no limit).
+   \return false if the query fails, with the error message in strError, or if output fails.
+   Rows may already have been written when a query fails part way through.
+   */
+  bool GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet,
+                         const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField, const CStdString& strCloseField,
+                         IQueryOutput &output, CStdString& strError, int offset = 0, int limit = -1);
 protected:
   void Split(const CStdString& strFileNameAndPath, CStdString& strPath, CStdString& strFileName);
   DWORD ComputeCRC(const CStdString &text);
@@ -47,6 +75,20 @@ protected:
   virtual bool CreateTables();
   virtual bool UpdateOldVersion(int version);
 
+  // word prefix index used for searching the library.  Items are identified
+  // by a type (defined by the derived class) and their id.
+  void CreateSearchIndex();
+  void AddToSearchIndex(int type, long id, const CStdString &text);
+  void RemoveFromSearchIndex(int type, long id);
+  bool SearchIndex(int type, const CStdString &search, std::vector<long> &ids, unsigned int limit = 0);
+  static void GetSearchTokens(const CStdString &text, std::vector<CStdString> &tokens);
+  static CStdString FormatIdList(const std::vector<long> &ids);
+
+  // path tables are looked up by a 64 bit hash of the lowercased path (iPathHash),
+  // which carries a unique index.
+  static __int64 HashPath(const CStdString &path);
+  void UpdatePathHashes();
+
   bool m_bOpen;
   int m_version;
 //#ifdef PRE_2_1_DATABASE_COMPATIBILITY
@@ -1599,7 +1599,7 @@ void CFileItemList::Serialize(CArchive& ar)
 
     ar >> m_content;
 
-    for (int i = 0; i < iSize; ++i)
+    for (int i = 0; i < iSize && !ar.IsFailed(); ++i)
     {
       CFileItemPtr pItem(new CFileItem);
       ar >> *pItem;
@@ -2051,9 +2051,19 @@ bool CFileItemList::Load()
   if (file.Open(GetDiscCacheFile()))
   {
     CLog::Log(LOGDEBUG,"Loading fileitems [%s]",m_strPath.c_str());
-    CArchive ar(&file, CArchive::load);
+    DWORD time = timeGetTime();
+    CArchive ar(&file, CArchive::load, CArchive::compact);
     ar >> *this;
-    CLog::Log(LOGDEBUG,"  -- items: %i, directory: %s sort method: %i, ascending: %s",Size(),m_strPath.c_str(), m_sortMethod, m_sortOrder ? "true" : "false");
+    if (ar.IsFailed())
+    { // old format or truncated - it'll be rebuilt
+      CLog::Log(LOGDEBUG,"  -- unable to load cached fileitems, removing");
+      ar.Close();
+      file.Close();
+      Clear();
+      RemoveDiscCache();
+      return false;
+    }
+    CLog::Log(LOGDEBUG,"  -- items: %i, directory: %s sort method: %i, ascending: %s, %u bytes in %lu ms",Size(),m_strPath.c_str(), m_sortMethod, m_sortOrder ? "true" : "false", ar.GetSize(), timeGetTime() - time);
     ar.Close();
     file.Close();
     return true;
@@ -2070,14 +2080,28 @@ bool CFileItemList::Save()
 
   CLog::Log(LOGDEBUG,"Saving fileitems [%s]",m_strPath.c_str());
 
+  // write to a temporary file and move it into place, so that a listing being
+  // saved from the background (see CLibraryViewCache) is never loaded half written
+  CStdString cacheFile(GetDiscCacheFile());
+  CStdString tempFile(cacheFile + ".tmp");
   CFile file;
-  if (file.OpenForWrite(GetDiscCacheFile(), true, true)) // overwrite always
+  if (file.OpenForWrite(tempFile, true, true)) // overwrite always
   {
-    CArchive ar(&file, CArchive::store);
+    DWORD time = timeGetTime();
+    CArchive ar(&file, CArchive::store, CArchive::compact);
     ar << *this;
-    CLog::Log(LOGDEBUG,"  -- items: %i, sort method: %i, ascending: %s",iSize,m_sortMethod, m_sortOrder ? "true" : "false");
+    CLog::Log(LOGDEBUG,"  -- items: %i, sort method: %i, ascending: %s, %u bytes in %lu ms",iSize,m_sortMethod, m_sortOrder ? "true" : "false", ar.GetSize(), timeGetTime() - time);
     ar.Close();
     file.Close();
+    if (!CFile::Rename(tempFile, cacheFile))
+    { // the rename won't overwrite on win32
+      CFile::Delete(cacheFile);
+      if (!CFile::Rename(tempFile, cacheFile))
+      {
+        CFile::Delete(tempFile);
+        return false;
+      }
+    }
     return true;
   }
 
@@ -2091,6 +2115,11 @@ void CFileItemList::RemoveDiscCache() const
     CFile::Delete(GetDiscCacheFile());
 }
 
+bool CFileItemList::HasDiscCache() const
+{
+  return CFile::Exists(GetDiscCacheFile());
+}
+
 CStdString CFileItemList::GetDiscCacheFile() const
 {
   CStdString strPath=m_strPath;
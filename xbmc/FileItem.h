@@ -349,6 +349,7 @@ public:
   bool CacheToDiscAlways() const { return m_cacheToDisc == CACHE_ALWAYS; }
   bool CacheToDiscIfSlow() const { return m_cacheToDisc == CACHE_IF_SLOW; }
   void RemoveDiscCache() const;
+  bool HasDiscCache() const;
   bool AlwaysCache() const;
 
   void SetCachedVideoThumbs();
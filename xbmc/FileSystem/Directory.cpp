@@ -28,9 +28,14 @@
 #endif
 #include "Util.h"
 #include "FileItem.h"
+#include "MusicInfoTagCache.h"
+#include "FileStats.h"
+#include "DirectoryCache.h"
+#include "URL.h"
 
 using namespace std;
 using namespace DIRECTORY;
+using namespace XFILE;
 
 CDirectory::CDirectory()
 {}
@@ -44,6 +49,7 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, C
   {
     CStdString translatedPath = CUtil::TranslateSpecialPath(_P(strPath));
 
+    CFileStatsSample sample(g_fileStats.GetSource(CURL(translatedPath)), CFileStats::OP_DIRECTORY);
     auto_ptr<IDirectory> pDirectory(CFactoryDirectory::Create(translatedPath));
     if (!pDirectory.get()) return false;
 
@@ -55,6 +61,7 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, C
     items.m_strPath=_P(strPath);
 
     bool bSuccess = pDirectory->GetDirectory(translatedPath, items);
+    sample.SetResult(bSuccess, items.Size());
     if (bSuccess)
     {
       //  Should any of the files we read be treated as a directory?
@@ -103,7 +110,10 @@ bool CDirectory::Create(const CStdString& strPath)
     auto_ptr<IDirectory> pDirectory(CFactoryDirectory::Create(translatedPath));
     if (pDirectory.get())
       if(pDirectory->Create(translatedPath.c_str()))
+      {
+        g_directoryCache.ClearListing(translatedPath);
         return true;
+      }
   }
 #ifndef _LINUX
   catch (const win32_exception &e) 
@@ -150,7 +160,11 @@ bool CDirectory::Remove(const CStdString& strPath)
     auto_ptr<IDirectory> pDirectory(CFactoryDirectory::Create(translatedPath));
     if (pDirectory.get())
       if(pDirectory->Remove(translatedPath.c_str()))
+      {
+        g_musicInfoTagCache.InvalidateDirectory(strPath);
+        g_directoryCache.ClearListing(translatedPath);
         return true;
+      }
   }
 #ifndef _LINUX
   catch (const win32_exception &e) 
@@ -124,9 +124,123 @@ bool CDirectoryCache::FileExists(const CStdString& strFile, bool& bInCache)
     }
     ++i;
   }
+
+  // then the recent listings of network directories
+  CListedFile file;
+  if (g_directoryCache.FindListedFile(strFixedFile, file, bInCache))
+    return true;
   return false;
 }
 
+CStdString CDirectoryCache::ListingKey(const CStdString &strPath)
+{
+  CStdString key(_P(strPath));
+  CUtil::RemoveSlashAtEnd(key);
+  // only fold case where the filesystem is case insensitive - ftp, daap, upnp etc. may
+  // well have two entries that differ only in case.
+#ifndef _LINUX
+  if (CUtil::IsSmb(key) || (key.size() > 1 && key[1] == ':'))
+#else
+  if (CUtil::IsSmb(key))
+#endif
+    key.ToLower();
+  return key;
+}
+
+void CDirectoryCache::SetListing(const CStdString& strPath, const CFileItemList &items)
+{
+  CSingleLock lock (m_cs);
+
+  map<CStdString, CListing> &listings = g_directoryCache.m_listings;
+  CStdString key = ListingKey(strPath);
+  DWORD now = timeGetTime();
+  if (listings.find(key) == listings.end() && listings.size() >= MAX_LISTINGS)
+  { // make room by dropping the oldest
+    map<CStdString, CListing>::iterator oldest = listings.begin();
+    for (map<CStdString, CListing>::iterator i = listings.begin(); i != listings.end(); ++i)
+    {
+      if (now - i->second.time > now - oldest->second.time)
+        oldest = i;
+    }
+    listings.erase(oldest);
+  }
+
+  CListing &listing = listings[key];
+  listing.time = now;
+  listing.files.clear();
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CFileItemPtr item = items[i];
+    CListedFile file;
+    file.size = item->m_dwSize;
+    file.time = 0;
+    if (item->m_dateTime.IsValid())
+    { // item times are local, stat times are UTC
+      FILETIME utc;
+      item->m_dateTime.GetAsTimeStamp(utc);
+      CDateTime(utc).GetAsTime(file.time);
+    }
+    file.folder = item->m_bIsFolder;
+    listing.files[ListingKey(item->m_strPath)] = file;
+  }
+}
+
+bool CDirectoryCache::FindListedFile(const CStdString& strFile, CListedFile &file, bool& bInCache)
+{
+  CStdString strPath(strFile);
+  CUtil::RemoveSlashAtEnd(strPath);
+  CUtil::GetDirectory(strPath, strPath);
+
+  map<CStdString, CListing>::iterator listing = m_listings.find(ListingKey(strPath));
+  if (listing == m_listings.end())
+    return false;
+  if (timeGetTime() - listing->second.time > LISTING_LIFETIME)
+  {
+    m_listings.erase(listing);
+    return false;
+  }
+
+  bInCache = true;
+  map<CStdString, CListedFile>::const_iterator i = listing->second.files.find(ListingKey(strFile));
+  if (i == listing->second.files.end())
+    return false;
+  file = i->second;
+  return true;
+}
+
+bool CDirectoryCache::StatListedFile(const CStdString& strFile, struct __stat64* buffer, bool& bInCache)
+{
+  CSingleLock lock (m_cs);
+
+  bInCache = false;
+  CListedFile file;
+  if (!g_directoryCache.FindListedFile(_P(strFile), file, bInCache))
+    return false;
+
+  if (buffer)
+  {
+    memset(buffer, 0, sizeof(struct __stat64));
+    buffer->st_size = file.size;
+#ifndef _LINUX
+    buffer->st_mtime = buffer->st_ctime = buffer->st_atime = file.time;
+#else
+    buffer->_st_mtime = buffer->_st_ctime = buffer->_st_atime = file.time;
+#endif
+    buffer->st_mode = file.folder ? S_IFDIR : S_IFREG;
+  }
+  return true;
+}
+
+void CDirectoryCache::ClearListing(const CStdString& strFile)
+{
+  CSingleLock lock (m_cs);
+
+  CStdString strPath(strFile);
+  CUtil::RemoveSlashAtEnd(strPath);
+  CUtil::GetDirectory(strPath, strPath);
+  g_directoryCache.m_listings.erase(ListingKey(strPath));
+}
+
 void CDirectoryCache::Clear()
 {
   CSingleLock lock (m_cs);
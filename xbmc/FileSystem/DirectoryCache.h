@@ -23,6 +23,7 @@
 #include "Directory.h"
 
 #include <set>
+#include <map>
 
 class CFileItem;
 
@@ -45,6 +46,20 @@ public:
   static void ClearDirectory(const CStdString& strPath);
   static void Clear();
   static bool FileExists(const CStdString& strPath, bool& bInCache);
+
+  /*! \brief Remember what a listing of a network directory said about each file for a little while,
+   so that Exists() and Stat() on the files just listed don't go back to the server
+   */
+  static void SetListing(const CStdString& strPath, const CFileItemList &items);
+  /*! \brief Stat a file from a recent listing of its directory
+   \param bInCache set if the directory was listed recently, in which case a file that isn't found doesn't exist
+   \return true if the file was found
+   */
+  static bool StatListedFile(const CStdString& strFile, struct __stat64* buffer, bool& bInCache);
+  /*! \brief Forget the listing of the directory a file is in, eg when it's written to or deleted
+   */
+  static void ClearListing(const CStdString& strFile);
+  static const DWORD LISTING_LIFETIME = 30000;  // ms a listing is used for
   static void InitThumbCache();
   static void ClearThumbCache();
   static void InitMusicThumbCache();
@@ -54,6 +69,23 @@ protected:
   static void ClearCache(std::set<CStdString>& dirs);
   static bool IsCacheDir(const CStdString &strPath);
 
+  struct CListedFile
+  {
+    __int64 size;
+    time_t time;                                  // UTC, as stat returns it
+    bool folder;
+  };
+  struct CListing
+  {
+    DWORD time;                                   // when it was listed
+    std::map<CStdString, CListedFile> files;      // by ListingKey()
+  };
+  static CStdString ListingKey(const CStdString &strPath);
+  bool FindListedFile(const CStdString& strFile, CListedFile &file, bool& bInCache);
+
+  static const unsigned int MAX_LISTINGS = 16;
+  std::map<CStdString, CListing> m_listings;     // by ListingKey()
+
   std::vector<CDir*> m_vecCache;
   typedef std::vector<CDir*>::iterator ivecCache;
 
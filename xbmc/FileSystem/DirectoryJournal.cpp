@@ -0,0 +1,397 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "stdafx.h"
+#include "DirectoryJournal.h"
+#include "File.h"
+#include "Util.h"
+#include "URL.h"
+#include "DirectoryCache.h"
+#include "utils/Archive.h"
+#include "utils/SingleLock.h"
+
+#if defined(_LINUX) && !defined(__APPLE__)
+#define HAS_INOTIFY
+#include <sys/inotify.h>
+#include <sys/select.h>
+#endif
+
+using namespace std;
+using namespace DIRECTORY;
+using namespace XFILE;
+
+CDirectoryWatcher g_directoryWatcher;
+
+CDirectoryWatcher::CDirectoryWatcher()
+{
+  m_fd = -1;
+  m_lastGeneration = 0;
+}
+
+CDirectoryWatcher::~CDirectoryWatcher()
+{
+  Stop();
+}
+
+unsigned int CDirectoryWatcher::Watch(const CStdString &strPath)
+{
+#ifdef HAS_INOTIFY
+  if (!CUtil::IsHD(strPath))
+    return 0;
+
+  CSingleLock lock(m_critSection);
+  map<CStdString, unsigned int>::iterator it = m_generations.find(strPath);
+  if (it != m_generations.end())
+    return it->second;
+  if (m_generations.size() >= MAX_WATCHES)
+    return 0;
+
+  if (m_fd < 0)
+  {
+    m_fd = inotify_init();
+    if (m_fd < 0)
+    {
+      CLog::Log(LOGERROR, "%s - unable to initialise inotify (%s)", __FUNCTION__, strerror(errno));
+      return 0;
+    }
+    Create();
+    SetName("DirectoryWatcher");
+  }
+
+  int wd = inotify_add_watch(m_fd, _P(strPath).c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                                        IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+  if (wd < 0)
+    return 0;
+  if (m_paths.find(wd) != m_paths.end())
+    return 0; // the same directory by another name, eg through a symlink
+
+  m_paths.insert(make_pair(wd, strPath));
+  m_generations[strPath] = ++m_lastGeneration;
+  return m_lastGeneration;
+#else
+  return 0;
+#endif
+}
+
+unsigned int CDirectoryWatcher::GetGeneration(const CStdString &strPath)
+{
+  CSingleLock lock(m_critSection);
+  map<CStdString, unsigned int>::iterator it = m_generations.find(strPath);
+  if (it != m_generations.end())
+    return it->second;
+  return 0;
+}
+
+void CDirectoryWatcher::Stop()
+{
+  StopThread();
+
+  CSingleLock lock(m_critSection);
+#ifdef HAS_INOTIFY
+  if (m_fd >= 0)
+    close(m_fd); // drops the watches
+#endif
+  m_fd = -1;
+  m_paths.clear();
+  m_generations.clear();
+}
+
+void CDirectoryWatcher::Process()
+{
+#ifdef HAS_INOTIFY
+  unsigned int buffer[1024]; // aligned for inotify_event
+
+  while (!m_bStop)
+  {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(m_fd, &fds);
+    struct timeval timeout = { 0, 500000 };
+    if (select(m_fd + 1, &fds, NULL, NULL, &timeout) <= 0)
+      continue;
+
+    int length = read(m_fd, buffer, sizeof(buffer));
+    if (length <= 0)
+      continue;
+
+    CSingleLock lock(m_critSection);
+    for (int offset = 0; offset < length; )
+    {
+      struct inotify_event *event = (struct inotify_event *)((char *)buffer + offset);
+      offset += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW)
+      { // events were lost, so no directory can be trusted
+        for (map<CStdString, unsigned int>::iterator it = m_generations.begin(); it != m_generations.end(); ++it)
+          it->second = ++m_lastGeneration;
+        continue;
+      }
+
+      map<int, CStdString>::iterator it = m_paths.find(event->wd);
+      if (it == m_paths.end())
+        continue;
+      if (event->mask & IN_IGNORED)
+      { // the directory is gone, or on a filesystem that went away
+        m_generations.erase(it->second);
+        m_paths.erase(it);
+        continue;
+      }
+      m_generations[it->second] = ++m_lastGeneration;
+    }
+  }
+#endif
+}
+
+CDirectoryJournal::CDirectoryJournal()
+{
+  m_open = false;
+  m_loaded = false;
+  m_modified = false;
+}
+
+CDirectoryJournal::~CDirectoryJournal()
+{
+  Close();
+}
+
+void CDirectoryJournal::Open(const CStdString &file)
+{
+  Close();
+
+  CSingleLock lock(m_critSection);
+  if (!m_loaded || file != m_file)
+  {
+    m_file = file;
+    m_entries.clear();
+    Load();
+    m_loaded = true;
+  }
+  m_open = true;
+}
+
+void CDirectoryJournal::Close()
+{
+  CSingleLock lock(m_critSection);
+  if (!m_open)
+    return;
+  if (m_modified && Save())
+    m_modified = false;
+  m_checked.clear();
+  m_open = false;
+}
+
+bool CDirectoryJournal::IsUnchanged(const CStdString &strPath, vector<CStdString> &folders, int &files)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_open)
+    return false;
+
+  map<CStdString, CCheck>::iterator checked = m_checked.find(strPath);
+  if (checked == m_checked.end())
+  {
+    lock.Leave();
+    CCheck check = Check(strPath);
+    lock.Enter();
+    if (!m_open)
+      return false;
+    checked = m_checked.insert(make_pair(strPath, check)).first; // the first check wins if we raced
+  }
+  if (!checked->second.unchanged)
+    return false;
+
+  map<CStdString, CEntry>::iterator it = m_entries.find(strPath);
+  if (it == m_entries.end())
+    return false;
+  folders = it->second.folders;
+  files = it->second.files;
+  return true;
+}
+
+// How recent a directory's modification time must be for a change to it to possibly not have
+// moved it on: the resolution of the protocol's timestamps, plus how old a listing CFile::Stat()
+// may answer from (CDirectoryCache::SetListing()) for the protocols that keep them.
+int CDirectoryJournal::GetMTimeSlack(const CStdString &strPath)
+{
+  CURL url(strPath);
+  CStdString protocol = url.GetProtocol();
+  if (protocol.Equals("ftp") || protocol.Equals("ftpx") || protocol.Equals("ftps"))
+    return 60 + CDirectoryCache::LISTING_LIFETIME / 1000;   // LIST only has minutes
+  if (protocol.Equals("smb"))
+    return 2 + CDirectoryCache::LISTING_LIFETIME / 1000;
+  return 2;                                                  // FAT has 2 second resolution
+}
+
+CDirectoryJournal::CCheck CDirectoryJournal::Check(const CStdString &strPath)
+{
+  CCheck check;
+  check.unchanged = false;
+  check.mtime = 0;
+  check.generation = g_directoryWatcher.Watch(strPath);
+
+  bool known = false;
+  unsigned int generation = 0;
+  __int64 mtime = 0;
+  {
+    CSingleLock lock(m_critSection);
+    map<CStdString, CEntry>::iterator it = m_entries.find(strPath);
+    if (it != m_entries.end())
+    {
+      known = true;
+      generation = it->second.generation;
+      mtime = it->second.mtime;
+    }
+  }
+
+  if (known && generation && generation == check.generation)
+  { // watched since it was scanned, and nothing has happened in it
+    check.unchanged = true;
+    return check;
+  }
+
+  CStdString path(strPath);
+  CUtil::RemoveSlashAtEnd(path); // smb won't stat a directory with a slash on the end
+  struct __stat64 st;
+  if (CFile::Stat(path, &st) == 0)
+  {
+#ifndef _LINUX
+    check.mtime = st.st_mtime;
+#else
+    check.mtime = st._st_mtime;
+#endif
+    // another change could follow within the resolution of the timestamp
+    if (check.mtime > (__int64)time(NULL) - GetMTimeSlack(path))
+      check.mtime = 0;
+  }
+  check.unchanged = known && check.mtime && check.mtime == mtime;
+  return check;
+}
+
+void CDirectoryJournal::Update(const CStdString &strPath, const vector<CStdString> &folders, int files)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_open)
+    return;
+
+  // we need to know what it looked like before it was listed
+  map<CStdString, CCheck>::iterator checked = m_checked.find(strPath);
+  if (checked == m_checked.end())
+    return;
+
+  CEntry &entry = m_entries[strPath];
+  // folders that have gone won't be asked about again
+  for (unsigned int i = 0; i < entry.folders.size(); i++)
+  {
+    if (find(folders.begin(), folders.end(), entry.folders[i]) == folders.end())
+      RemoveTree(entry.folders[i]);
+  }
+  entry.mtime = checked->second.mtime;
+  entry.generation = checked->second.generation;
+  entry.files = files;
+  entry.folders = folders;
+  m_modified = true;
+}
+
+void CDirectoryJournal::RemoveTree(const CStdString &strPath)
+{
+  map<CStdString, CEntry>::iterator it = m_entries.lower_bound(strPath);
+  while (it != m_entries.end() && it->first.Left(strPath.size()) == strPath)
+    m_entries.erase(it++);
+}
+
+bool CDirectoryJournal::Load()
+{
+  CFile file;
+  if (!file.Open(m_file))
+    return false;
+
+  CArchive ar(&file, CArchive::load, CArchive::compact);
+  int version = 0;
+  int count = 0;
+  ar >> version;
+  if (version == JOURNAL_VERSION)
+    ar >> count;
+  for (int i = 0; i < count && !ar.IsFailed(); i++)
+  {
+    CStdString path;
+    CEntry entry;
+    int folders = 0;
+    ar >> path;
+    ar >> entry.mtime;
+    ar >> entry.files;
+    ar >> folders;
+    for (int j = 0; j < folders && !ar.IsFailed(); j++)
+    {
+      CStdString folder;
+      ar >> folder;
+      entry.folders.push_back(folder);
+    }
+    entry.generation = 0; // the watches went with the last run
+    m_entries.insert(make_pair(path, entry));
+  }
+  bool failed = version != JOURNAL_VERSION || ar.IsFailed();
+  ar.Close();
+  file.Close();
+
+  if (failed)
+  { // old format or truncated - the next scan is a full one
+    CLog::Log(LOGDEBUG, "%s - unable to load %s, ignoring it", __FUNCTION__, m_file.c_str());
+    m_entries.clear();
+    return false;
+  }
+  CLog::Log(LOGDEBUG, "%s - loaded %u directories from %s", __FUNCTION__, (unsigned int)m_entries.size(), m_file.c_str());
+  return true;
+}
+
+bool CDirectoryJournal::Save()
+{
+  CStdString tempFile(m_file + ".tmp");
+  CFile file;
+  if (!file.OpenForWrite(tempFile, true, true))
+    return false;
+
+  CArchive ar(&file, CArchive::store, CArchive::compact);
+  ar << JOURNAL_VERSION;
+  ar << (int)m_entries.size();
+  for (map<CStdString, CEntry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    const CEntry &entry = it->second;
+    ar << it->first;
+    ar << entry.mtime;
+    ar << entry.files;
+    ar << (int)entry.folders.size();
+    for (unsigned int i = 0; i < entry.folders.size(); i++)
+      ar << entry.folders[i];
+  }
+  ar.Close();
+  file.Close();
+
+  if (!CFile::Rename(tempFile, m_file))
+  { // the rename won't overwrite on win32
+    CFile::Delete(m_file);
+    if (!CFile::Rename(tempFile, m_file))
+    {
+      CFile::Delete(tempFile);
+      return false;
+    }
+  }
+  return true;
+}
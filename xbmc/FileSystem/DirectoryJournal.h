@@ -0,0 +1,154 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/Thread.h"
+#include "utils/CriticalSection.h"
+
+#include <map>
+#include <vector>
+
+namespace DIRECTORY
+{
+/*!
+ \ingroup filesystem
+ \brief Watches local directories for changes, with inotify (linux only)
+
+ A watched directory has a generation that changes whenever an entry in it is
+ created, deleted, moved in or out, written to or has its attributes changed.
+ Generations are never reused, so a caller that remembers the generation of a
+ directory knows it hasn't changed as long as GetGeneration() returns the same.
+ Only MAX_WATCHES directories are watched, which stays well under the default
+ inotify limit - past that (or off linux, or for anything not on a local disk)
+ Watch() returns 0.
+ */
+class CDirectoryWatcher : public CThread
+{
+public:
+  CDirectoryWatcher();
+  virtual ~CDirectoryWatcher();
+
+  /*! \brief Start watching a directory, if it isn't watched already
+   \return its generation, or 0 if it can't be watched
+   */
+  unsigned int Watch(const CStdString &strPath);
+
+  /*! \brief The generation of a watched directory, or 0 if it isn't watched
+   */
+  unsigned int GetGeneration(const CStdString &strPath);
+
+  void Stop();
+
+protected:
+  virtual void Process();
+
+private:
+  static const unsigned int MAX_WATCHES = 4096;
+
+  CCriticalSection m_critSection;
+  int m_fd;
+  std::map<int, CStdString> m_paths;                // watch descriptor -> path
+  std::map<CStdString, unsigned int> m_generations; // path -> generation
+  unsigned int m_lastGeneration;
+};
+
+/*!
+ \ingroup filesystem
+ \brief What the directories of a library looked like when they were last scanned.
+
+ A library update normally lists every directory and compares a hash of the
+ listing with the one in the database, which on a large share means a lot of
+ listings to find the few directories that changed.  With a journal, a scanner
+ asks IsUnchanged() before it lists a directory, and tells Update() about the
+ directories it has scanned.
+
+ A directory on a local disk is unchanged if it's been watched by
+ g_directoryWatcher since its last scan and nothing happened in it.  Anything
+ else is unchanged if its modification time is the same as when it was last
+ scanned, which costs one stat instead of a listing.  Either way the folders
+ it had (and the number of files, for the progress) come from the journal, so
+ the scan can carry on into them without listing the parent.
+
+ A modification time only changes when entries are added, removed or renamed,
+ so a file rewritten in place on a share isn't noticed (a full update still
+ finds it).  Modification times close to the time of the check aren't trusted,
+ as another change could follow within the timestamp's resolution.
+
+ The journal is saved in a file next to the databases.
+ */
+class CDirectoryJournal
+{
+public:
+  CDirectoryJournal();
+  ~CDirectoryJournal();
+
+  /*! \brief Start a scan.  The journal is loaded from file the first time, and kept in memory after that.
+   */
+  void Open(const CStdString &file);
+  /*! \brief Finish a scan, saving the journal if it changed
+   */
+  void Close();
+
+  /*! \brief Whether strPath hasn't changed since its last Update(), with the folders and files it had then.  Safe to call from any thread.
+   */
+  bool IsUnchanged(const CStdString &strPath, std::vector<CStdString> &folders, int &files);
+
+  /*! \brief strPath has been scanned, as it was when IsUnchanged() was asked about it
+   \param folders the folders the scan went into
+   \param files the files counted for the progress
+   */
+  void Update(const CStdString &strPath, const std::vector<CStdString> &folders, int files);
+
+private:
+  struct CEntry
+  {
+    __int64 mtime;                      // 0 if not known
+    unsigned int generation;            // g_directoryWatcher generation, 0 if not watched
+    int files;
+    std::vector<CStdString> folders;
+  };
+
+  struct CCheck
+  {
+    bool unchanged;
+    __int64 mtime;
+    unsigned int generation;
+  };
+
+  CCheck Check(const CStdString &strPath);
+  static int GetMTimeSlack(const CStdString &strPath);
+  bool Load();
+  bool Save();
+  void RemoveTree(const CStdString &strPath);
+
+  static const int JOURNAL_VERSION = 1;
+
+  CCriticalSection m_critSection;
+  CStdString m_file;
+  bool m_open;
+  bool m_loaded;
+  bool m_modified;
+  std::map<CStdString, CEntry> m_entries;
+  std::map<CStdString, CCheck> m_checked;  // the directories asked about since Open()
+};
+}
+
+extern DIRECTORY::CDirectoryWatcher g_directoryWatcher;
@@ -0,0 +1,367 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "stdafx.h"
+#include "DirectoryWalker.h"
+#include "Directory.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "utils/SingleLock.h"
+
+using namespace std;
+using namespace DIRECTORY;
+
+class CDirectoryWalker::CListJob : public CJob
+{
+public:
+  CListJob(CDirectoryWalker *walker, CNode *node) : m_walker(walker), m_node(node) {}
+  virtual void DoWork()
+  {
+    if (m_walker->BeginListing(m_node))
+      m_walker->List(m_node);
+  }
+private:
+  CDirectoryWalker *m_walker;
+  CNode *m_node;
+};
+
+CDirectoryWalker::CDirectoryWalker(unsigned int maxPerHost)
+{
+  m_callback = NULL;
+  m_ordered = true;
+  m_stopped = true;
+  m_maxPerHost = maxPerHost ? maxPerHost : 1;
+  m_pending = 0;
+  m_keptItems = 0;
+  m_takers = 0;
+  m_files = 0;
+  m_finished = false;
+  m_startTime = 0;
+}
+
+CDirectoryWalker::~CDirectoryWalker()
+{
+  Stop();
+}
+
+void CDirectoryWalker::Start(const vector<CStdString> &roots, const CStdString &mask, IDirectoryWalkerCallback *callback, bool ordered)
+{
+  Stop();
+
+  CSingleLock lock(m_critSection);
+  m_callback = callback;
+  m_mask = mask;
+  m_ordered = ordered;
+  m_stopped = false;
+  m_finished = false;
+  m_files = 0;
+  m_startTime = timeGetTime();
+  m_token.reset(new CJobToken);
+
+  vector<CNode *> nodes;
+  for (unsigned int i = 0; i < roots.size(); i++)
+  {
+    CNode *node = AddNode(roots[i]);
+    if (node)
+    {
+      Queue(node, false);
+      nodes.push_back(node);
+    }
+  }
+  if (m_ordered)
+    m_order.assign(nodes.rbegin(), nodes.rend());
+  if (nodes.empty())
+    m_finished = true;
+  SubmitJobs();
+}
+
+void CDirectoryWalker::Stop()
+{
+  CJobTokenPtr token;
+  {
+    CSingleLock lock(m_critSection);
+    m_stopped = true;
+    token = m_token;
+    m_token.reset();
+  }
+  m_deliveredEvent.Set();
+
+  // wait for the listings in progress, after which nothing else will touch the nodes
+  if (token)
+    token->Cancel();
+  CSingleLock lock(m_critSection);
+  while (m_takers)
+  {
+    lock.Leave();
+    Sleep(10);
+    lock.Enter();
+  }
+  lock.Leave();
+  Clear();
+}
+
+void CDirectoryWalker::Clear()
+{
+  CSingleLock lock(m_critSection);
+  for (map<CStdString, CNode *>::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it)
+  {
+    delete it->second->items;
+    delete it->second;
+  }
+  m_nodes.clear();
+  m_hosts.clear();
+  m_order.clear();
+  m_listed.clear();
+  m_pending = 0;
+  m_keptItems = 0;
+}
+
+bool CDirectoryWalker::Take(const CStdString &strPath, CFileItemList &items)
+{
+  CSingleLock lock(m_critSection);
+  if (m_stopped)
+    return false;
+  map<CStdString, CNode *>::iterator it = m_nodes.find(strPath);
+  if (it == m_nodes.end())
+    return false;
+  CNode *node = it->second;
+
+  if (!node->listing)
+  { // we'd only wait on it behind the other jobs (it may not even be submitted yet), so
+    // list it ourselves.  If its job has been submitted we take over its place in the
+    // host's count, and the job does nothing when it gets to run.
+    node->listing = true;
+    CHost &host = m_hosts[node->host];
+    deque<CNode *>::iterator i = find(host.queue.begin(), host.queue.end(), node);
+    if (i != host.queue.end())
+    {
+      host.queue.erase(i);
+      host.active++;
+    }
+    m_takers++;
+    lock.Leave();
+    List(node);
+    lock.Enter();
+    m_takers--;
+    if (m_stopped)
+      return false;
+  }
+
+  while (!node->delivered)
+  {
+    lock.Leave();
+    m_deliveredEvent.WaitMSec(100);
+    lock.Enter();
+    if (m_stopped)
+      return false;
+  }
+
+  if (!node->items)
+    return false; // taken already, or dropped
+
+  items.Clear();
+  items.Assign(*node->items);
+  items.m_strPath = node->items->m_strPath;
+  m_keptItems -= node->items->Size();
+  delete node->items;
+  node->items = NULL;
+  return true;
+}
+
+bool CDirectoryWalker::IsFinished()
+{
+  CSingleLock lock(m_critSection);
+  return m_finished;
+}
+
+bool CDirectoryWalker::BeginListing(CNode *node)
+{
+  CSingleLock lock(m_critSection);
+  if (m_stopped || node->listing)
+    return false; // Take() got to it first
+  node->listing = true;
+  return true;
+}
+
+void CDirectoryWalker::List(CNode *node)
+{
+  vector<CStdString> folders;
+  int files = 0;
+  if (m_callback->IsUnchanged(node->path, folders, files))
+  {
+    OnListed(node, NULL, folders, files);
+    return;
+  }
+
+  CFileItemList *items = new CFileItemList;
+  CDirectory::GetDirectory(node->path, *items, m_mask);
+  for (int i = 0; i < items->Size(); i++)
+  {
+    const CFileItemPtr item = (*items)[i];
+    if (item->m_bIsFolder && m_callback->WalkInto(*item))
+      folders.push_back(item->m_strPath);
+  }
+  OnListed(node, items, folders, 0);
+}
+
+CDirectoryWalker::CNode *CDirectoryWalker::AddNode(const CStdString &strPath)
+{
+  if (m_nodes.find(strPath) != m_nodes.end())
+    return NULL; // already part of the walk
+
+  CNode *node = new CNode;
+  node->path = strPath;
+  CURL url(strPath);
+  node->host = url.GetProtocol() + "://" + url.GetHostName();
+  node->items = NULL;
+  node->files = 0;
+  node->listed = false;
+  node->listing = false;
+  node->delivered = false;
+  m_nodes.insert(make_pair(strPath, node));
+  m_pending++;
+  return node;
+}
+
+void CDirectoryWalker::Queue(CNode *node, bool front)
+{
+  CHost &host = m_hosts[node->host];
+  if (front)
+    host.queue.push_front(node);
+  else
+    host.queue.push_back(node);
+}
+
+void CDirectoryWalker::SubmitJobs()
+{
+  for (map<CStdString, CHost>::iterator it = m_hosts.begin(); it != m_hosts.end(); ++it)
+  {
+    CHost &host = it->second;
+    while (host.active < m_maxPerHost && !host.queue.empty())
+    {
+      CNode *node = host.queue.front();
+      host.queue.pop_front();
+      host.active++;
+      g_jobManager.Submit(CJobPtr(new CListJob(this, node)), CJobManager::PRIORITY_LOW, m_token);
+    }
+  }
+}
+
+void CDirectoryWalker::OnListed(CNode *node, CFileItemList *items, const vector<CStdString> &folders, int files)
+{
+  {
+    CSingleLock lock(m_critSection);
+    if (m_stopped)
+    {
+      delete items;
+      return;
+    }
+    node->items = items;
+    node->files = files;
+    if (items)
+      m_keptItems += items->Size();
+    m_hosts[node->host].active--;
+
+    for (unsigned int i = 0; i < folders.size(); i++)
+    {
+      CNode *child = AddNode(folders[i]);
+      if (child)
+        node->children.push_back(child);
+    }
+    // ordered walks go depth first, so the listings can be delivered as they arrive
+    if (m_ordered)
+    {
+      for (unsigned int i = node->children.size(); i > 0; i--)
+        Queue(node->children[i - 1], true);
+    }
+    else
+    {
+      for (unsigned int i = 0; i < node->children.size(); i++)
+        Queue(node->children[i], false);
+      m_listed.push_back(node);
+    }
+    node->listed = true;
+    m_pending--;
+    SubmitJobs();
+  }
+
+  DeliverListings();
+}
+
+void CDirectoryWalker::DeliverListings()
+{
+  CSingleLock deliverLock(m_deliverSection);
+  unsigned int directories;
+  while (true)
+  {
+    CNode *node = NULL;
+    {
+      CSingleLock lock(m_critSection);
+      if (m_stopped)
+        return;
+      if (m_ordered)
+      {
+        if (!m_order.empty() && m_order.back()->listed)
+        {
+          node = m_order.back();
+          m_order.pop_back();
+          for (unsigned int i = node->children.size(); i > 0; i--)
+            m_order.push_back(node->children[i - 1]);
+        }
+      }
+      else if (!m_listed.empty())
+      {
+        node = m_listed.front();
+        m_listed.pop_front();
+      }
+
+      if (!node)
+      {
+        if (m_pending || m_finished || (m_ordered ? !m_order.empty() : !m_listed.empty()))
+          return;
+        m_finished = true;
+        directories = m_nodes.size();
+        break;
+      }
+    }
+
+    int files = node->files;
+    if (node->items)
+      files += m_callback->OnDirectoryListed(node->path, *node->items);
+
+    {
+      CSingleLock lock(m_critSection);
+      m_files += files;
+      node->delivered = true;
+      if (node->items && m_keptItems > MAX_KEPT_ITEMS)
+      { // too much kept already - the caller will have to list this one again
+        m_keptItems -= node->items->Size();
+        delete node->items;
+        node->items = NULL;
+      }
+    }
+    m_deliveredEvent.Set();
+  }
+
+  CLog::Log(LOGDEBUG, "%s - listed %u directories (%i files) in %lu ms", __FUNCTION__, directories, m_files, timeGetTime() - m_startTime);
+  m_callback->OnWalkFinished(m_files);
+}
@@ -0,0 +1,163 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/CriticalSection.h"
+#include "utils/JobManager.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+class CFileItem;
+class CFileItemList;
+
+namespace DIRECTORY
+{
+/*!
+ \ingroup filesystem
+ \brief Told about the directories a CDirectoryWalker lists
+ */
+class IDirectoryWalkerCallback
+{
+public:
+  virtual ~IDirectoryWalkerCallback() {}
+
+  /*! \brief Whether the walk should go into a folder of a listing.  Called on the walker's jobs, so it mustn't touch the caller's state.
+   */
+  virtual bool WalkInto(const CFileItem &folder) = 0;
+
+  /*! \brief Called on the walker's jobs before a directory is listed.  Return true to not list it, with the folders to
+   walk into and its number of files (eg from a CDirectoryJournal).  It won't be passed to OnDirectoryListed().
+   */
+  virtual bool IsUnchanged(const CStdString &strDirectory, std::vector<CStdString> &folders, int &files) { return false; };
+
+  /*! \brief A directory has been listed.  Called for one directory at a time.
+   \return the number of files in it, added to the count passed to OnWalkFinished()
+   */
+  virtual int OnDirectoryListed(const CStdString &strDirectory, const CFileItemList &items) = 0;
+
+  /*! \brief Every directory under the roots has been listed
+   */
+  virtual void OnWalkFinished(int files) {};
+};
+
+/*!
+ \ingroup filesystem
+ \brief Lists a directory tree in parallel, ahead of whoever is working through it.
+
+ The directories are listed by jobs on g_jobManager, with at most maxPerHost
+ of them going to any one host (or to the local disks) at a time, so a large
+ share doesn't get more than a few requests at once and one slow server
+ doesn't hold up the others.  As each directory is listed the callback decides
+ which of its folders to walk into, and gets the listing.
+
+ An ordered walk gives the listings to the callback in the order a serial
+ depth first walk would (each directory, then each of its folders in listing
+ order), and lists the subfolders of a directory before its later siblings so
+ that it doesn't need to hold many listings back.  An unordered walk lists
+ breadth first and gives out each listing as soon as it's done.
+
+ The listings are kept, so that someone walking the same tree (a scanner) can
+ Take() them instead of listing every directory again - Take() waits for the
+ listing if it's in progress, and lists it itself if it hasn't been started
+ rather than waiting behind the queued jobs.
+ Only MAX_KEPT_ITEMS items are kept; past that, listings are dropped once the
+ callback has had them, and Take() returns false for them.
+ */
+class CDirectoryWalker
+{
+public:
+  CDirectoryWalker(unsigned int maxPerHost = 4);
+  ~CDirectoryWalker();
+
+  /*! \brief Start walking the trees under roots, stopping any earlier walk
+   \param mask the file mask, as for CDirectory::GetDirectory
+   */
+  void Start(const std::vector<CStdString> &roots, const CStdString &mask, IDirectoryWalkerCallback *callback, bool ordered = true);
+  void Stop();
+
+  /*! \brief Move the listing of strPath into items, waiting for it if need be
+   \return false if strPath isn't part of the walk, its listing was dropped or the walk was stopped
+   */
+  bool Take(const CStdString &strPath, CFileItemList &items);
+
+  bool IsFinished();
+
+private:
+  class CListJob;
+
+  struct CNode
+  {
+    CStdString path;
+    CStdString host;
+    CFileItemList *items;          // the listing, until it's taken or dropped.  NULL if it wasn't listed.
+    int files;                     // files counted without listing it
+    std::vector<CNode *> children; // folders walked into, in listing order
+    bool listing;                  // a job or Take() has started listing it
+    bool listed;
+    bool delivered;                // the callback has had the listing
+  };
+
+  struct CHost
+  {
+    unsigned int active;           // listings in progress
+    std::deque<CNode *> queue;     // waiting for one of those to finish
+  };
+
+  CNode *AddNode(const CStdString &strPath);
+  bool BeginListing(CNode *node);
+  void List(CNode *node);
+  void Queue(CNode *node, bool front);
+  void SubmitJobs();
+  void OnListed(CNode *node, CFileItemList *items, const std::vector<CStdString> &folders, int files);
+  void DeliverListings();
+  void Clear();
+
+#ifdef _XBOX
+  static const unsigned int MAX_KEPT_ITEMS = 5000;
+#else
+  static const unsigned int MAX_KEPT_ITEMS = 50000;
+#endif
+
+  CCriticalSection m_critSection;
+  CCriticalSection m_deliverSection;   // held while the callback has a listing
+  CEvent m_deliveredEvent;
+  CJobTokenPtr m_token;
+
+  IDirectoryWalkerCallback *m_callback;
+  CStdString m_mask;
+  bool m_ordered;
+  bool m_stopped;
+  unsigned int m_maxPerHost;
+
+  std::map<CStdString, CNode *> m_nodes;
+  std::map<CStdString, CHost> m_hosts;
+  std::vector<CNode *> m_order;        // ordered walks: the next nodes to deliver, last first
+  std::deque<CNode *> m_listed;        // unordered walks: listed but not delivered
+  unsigned int m_pending;              // nodes not yet listed
+  unsigned int m_keptItems;
+  unsigned int m_takers;               // Take()s listing a directory themselves
+  int m_files;
+  bool m_finished;
+  DWORD m_startTime;
+};
+}
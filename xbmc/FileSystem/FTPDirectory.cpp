@@ -95,8 +95,7 @@ bool CFTPDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
       pItem->m_dwSize = lp.size;
       pItem->m_dateTime=lp.mtime;
 
-      if( m_cacheDirectory )
-        vecCacheItems.Add(pItem);
+      vecCacheItems.Add(pItem);
 
       /* if file is ok by mask or a folder add it */
       if( pItem->m_bIsFolder || IsAllowed(name) )
@@ -106,6 +105,7 @@ bool CFTPDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
 
 
  if (m_cacheDirectory)
-    g_directoryCache.SetDirectory(path, vecCacheItems);
+    g_directoryCache.SetDirectory(strPath, vecCacheItems);
+  g_directoryCache.SetListing(strPath, vecCacheItems);
   return true;
 }
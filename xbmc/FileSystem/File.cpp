@@ -26,6 +26,7 @@
 #include "DirectoryCache.h"
 #include "FileCache.h"
 #include "FileItem.h"
+#include "MusicInfoTagCache.h"
 
 #ifndef _LINUX
 #include "utils/Win32Exception.h"
@@ -101,6 +102,7 @@ CFile::CFile()
   m_pFile = NULL;
   m_pBuffer = NULL;
   m_flags = 0;
+  m_stats = NULL;
 }
 
 //*********************************************************************************************
@@ -281,10 +283,16 @@ bool CFile::Open(const CStdString& strFileName, bool bBinary, unsigned int flags
       m_flags |= READ_CACHED;
 
     CURL url(strFileName);
+    // CFileCache's own CFile records what actually goes to the source, so reads
+    // through the cache aren't recorded here as well
+    m_stats = (m_flags & READ_CACHED) ? NULL : g_fileStats.GetSource(url);
+    CFileStatsSample sample(m_stats, CFileStats::OP_OPEN);
     if (m_flags & READ_CACHED)
     {
       m_pFile = new CFileCache();
-      return m_pFile->Open(url, bBinary);
+      bool opened = m_pFile->Open(url, bBinary);
+      sample.SetResult(opened);
+      return opened;
     }
 
     m_pFile = CFileFactory::CreateLoader(url);
@@ -335,6 +343,7 @@ bool CFile::Open(const CStdString& strFileName, bool bBinary, unsigned int flags
     }
 
     m_bitStreamStats.Start();
+    sample.SetResult(true);
     return true;
   }
 #ifndef _LINUX
@@ -381,6 +390,7 @@ bool CFile::OpenForWrite(const CStdString& strFileName, bool bBinary, bool bOver
   {
     CURL url(strFileName);
 
+    g_directoryCache.ClearListing(strFileName);
     m_pFile = CFileFactory::CreateLoader(url);
     if (m_pFile)
       return m_pFile->OpenForWrite(url, bBinary, bOverWrite);
@@ -412,11 +422,14 @@ bool CFile::Exists(const CStdString& strFileName)
       return false;
 
     CURL url(strFileName);
+    CFileStatsSample sample(g_fileStats.GetSource(url), CFileStats::OP_STAT);
 
     std::auto_ptr<IFile> pFile(CFileFactory::CreateLoader(url));
     if (!pFile.get()) return false;
 
-    return pFile->Exists(url);
+    bool exists = pFile->Exists(url);
+    sample.SetResult(exists);
+    return exists;
   }
 #ifndef _LINUX
   catch (const win32_exception &e) 
@@ -436,12 +449,21 @@ int CFile::Stat(const CStdString& strFileName, struct __stat64* buffer)
 {
   try
   {
+    bool bPathInCache;
+    if (g_directoryCache.StatListedFile(strFileName, buffer, bPathInCache))
+      return 0;
+    if (bPathInCache)
+      return -1;
+
     CURL url(strFileName);
+    CFileStatsSample sample(g_fileStats.GetSource(url), CFileStats::OP_STAT);
 
     std::auto_ptr<IFile> pFile(CFileFactory::CreateLoader(url));
     if (!pFile.get()) return false;
 
-    return pFile->Stat(url, buffer);
+    int result = pFile->Stat(url, buffer);
+    sample.SetResult(result == 0);
+    return result;
   }
 #ifndef _LINUX
   catch (const win32_exception &e) 
@@ -462,6 +484,7 @@ unsigned int CFile::Read(void *lpBuf, __int64 uiBufSize)
   if (!m_pFile) 
     return 0;
 
+  CFileStatsSample sample(m_stats, CFileStats::OP_READ);
   if(m_pBuffer)
   {
     if(m_flags & READ_TRUNCATED)
@@ -471,6 +494,7 @@ unsigned int CFile::Read(void *lpBuf, __int64 uiBufSize)
                                                   m_pBuffer->in_avail()));
       if (nBytes>0)
         m_bitStreamStats.AddSampleBytes(nBytes);
+      sample.SetResult(true, nBytes);
       return nBytes;
     }
     else
@@ -478,6 +502,7 @@ unsigned int CFile::Read(void *lpBuf, __int64 uiBufSize)
       unsigned int nBytes = m_pBuffer->sgetn((char*)lpBuf, uiBufSize);
       if (nBytes>0)
         m_bitStreamStats.AddSampleBytes(nBytes);
+      sample.SetResult(true, nBytes);
       return nBytes;
     }
   }
@@ -489,6 +514,7 @@ unsigned int CFile::Read(void *lpBuf, __int64 uiBufSize)
       unsigned int nBytes = m_pFile->Read(lpBuf, uiBufSize);
       if (nBytes>0)
         m_bitStreamStats.AddSampleBytes(nBytes);
+      sample.SetResult(true, nBytes);
       return nBytes;
     }
     else
@@ -504,6 +530,7 @@ unsigned int CFile::Read(void *lpBuf, __int64 uiBufSize)
       }
       if (done > 0)
         m_bitStreamStats.AddSampleBytes(done);
+      sample.SetResult(true, done);
       return done;
     }
   }
@@ -530,6 +557,7 @@ void CFile::Close()
 
     if (m_pFile)
       SAFE_DELETE(m_pFile);
+    m_stats = NULL;
   }
 #ifndef _LINUX
   catch (const win32_exception &e) 
@@ -595,7 +623,12 @@ __int64 CFile::Seek(__int64 iFilePosition, int iWhence)
       }
     }
     else
-      return m_pFile->Seek(iFilePosition, iWhence);
+    {
+      CFileStatsSample sample(m_stats, CFileStats::OP_SEEK);
+      __int64 ret = m_pFile->Seek(iFilePosition, iWhence);
+      sample.SetResult(ret >= 0);
+      return ret;
+    }
   }
 #ifndef _LINUX
   catch (const win32_exception &e) 
@@ -759,7 +792,11 @@ bool CFile::Delete(const CStdString& strFileName)
     if (!pFile.get()) return false;
 
     if(pFile->Delete(url))
+    {
+      g_musicInfoTagCache.Invalidate(strFileName);
+      g_directoryCache.ClearListing(strFileName);
       return true;
+    }
   }
 #ifndef _LINUX
   catch (const access_violation &e) 
@@ -790,7 +827,12 @@ bool CFile::Rename(const CStdString& strFileName, const CStdString& strNewFileNa
     if (!pFile.get()) return false;
 
     if(pFile->Rename(url, urlnew))
+    {
+      g_musicInfoTagCache.Invalidate(strFileName);
+      g_directoryCache.ClearListing(strFileName);
+      g_directoryCache.ClearListing(strNewFileName);
       return true;
+    }
   }
 #ifndef _LINUX
   catch (const win32_exception &e) 
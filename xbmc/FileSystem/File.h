@@ -33,6 +33,7 @@
 #include "IFile.h"
 #include "StdString.h"
 #include "../utils/BitstreamStats.h"
+#include "FileStats.h"
 
 class CURL;
 
@@ -98,6 +99,7 @@ private:
   IFile* m_pFile;
   CFileStreamBuffer* m_pBuffer;
   BitstreamStats m_bitStreamStats;
+  CFileStats::CSource* m_stats;
 };
 
 // streambuf for file io, only supports buffered input currently
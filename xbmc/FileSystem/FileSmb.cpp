@@ -36,6 +36,11 @@
 #endif
 #include "../utils/Network.h"
 #include "Settings.h"
+#ifdef _LINUX
+#include "utils/Thread.h"
+#include "utils/Event.h"
+#include <deque>
+#endif
 
 
 using namespace XFILE;
@@ -72,6 +77,12 @@ void CSMB::Deinit()
 {
   CSingleLock lock(*this);
 
+#ifdef _LINUX
+  for (unsigned int i = 0; i < m_idleConnections.size(); i++)
+    delete m_idleConnections[i];
+  m_idleConnections.clear();
+#endif
+
   /* samba goes loco if deinited while it has some files opened */
   if (m_context)
   {
@@ -111,18 +122,6 @@ void CSMB::Init()
     xb_setSambaWorkgroup((char*)g_guiSettings.GetString("smb.workgroup").c_str());
 #endif
 
-    // setup our context
-    m_context = smbc_new_context();
-    m_context->debug = g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0;
-    m_context->callbacks.auth_fn = xb_smbc_auth;
-    orig_cache = m_context->callbacks.get_cached_srv_fn;
-    m_context->callbacks.get_cached_srv_fn = xb_smbc_cache;
-    m_context->options.one_share_per_server = false;
-    m_context->options.browse_max_lmb_count = 0;
-
-    /* set connection timeout. since samba always tries two ports, divide this by two the correct value */
-    m_context->timeout = g_advancedSettings.m_sambaclienttimeout * 1000;    
-
 #ifdef _LINUX
     // Create ~/.smb/smb.conf
     char smb_conf[MAX_PATH];
@@ -152,8 +151,9 @@ void CSMB::Init()
     }
 #endif
     
-    // initialize samba and do some hacking into the settings
-    if (smbc_init_context(m_context))
+    // setup and initialize our context, then do some hacking into the settings
+    m_context = CreateContext();
+    if (m_context)
     {
       /* setup old interface to use this context */
       smbc_set_context(m_context);
@@ -174,17 +174,39 @@ void CSMB::Init()
         lp_do_parameter( -1, "dos charset", "CP850");
 #endif
     }
-    else
-    {
-      smbc_free_context(m_context, 1);
-      m_context = NULL;
-    }
   }
 #ifdef _LINUX
   m_LastActive = timeGetTime();
 #endif
 }
 
+/* libsmbclient keeps global state even with separate contexts (smbc_init_context
+   loads smb.conf), so contexts are only created, used and freed under our lock */
+SMBCCTX *CSMB::CreateContext()
+{
+  CSingleLock lock(smb);
+  SMBCCTX *context = smbc_new_context();
+  if (!context)
+    return NULL;
+
+  context->debug = g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0;
+  context->callbacks.auth_fn = xb_smbc_auth;
+  orig_cache = context->callbacks.get_cached_srv_fn;
+  context->callbacks.get_cached_srv_fn = xb_smbc_cache;
+  context->options.one_share_per_server = false;
+  context->options.browse_max_lmb_count = 0;
+
+  /* set connection timeout. since samba always tries two ports, divide this by two the correct value */
+  context->timeout = g_advancedSettings.m_sambaclienttimeout * 1000;    
+
+  if (!smbc_init_context(context))
+  {
+    smbc_free_context(context, 1);
+    return NULL;
+  }
+  return context;
+}
+
 void CSMB::Purge()
 {
 #ifndef _LINUX
@@ -326,6 +348,350 @@ void CSMB::AddIdleConnection()
      leaves the movie paused for a long while and then press stop */
   m_LastActive = timeGetTime();  
 }
+
+/* Hands out a private context for reading a file, preferring an idle one that
+   already has a session to the same share. Returns NULL if samba can't give us
+   a new context, in which case the caller should use the global one. */
+CSMBConnection *CSMB::AcquireConnection(const CURL &url)
+{
+  Init(); // writes smb.conf, which new contexts read
+  {
+    CSingleLock lock(*this);
+    for (std::vector<CSMBConnection *>::iterator it = m_idleConnections.begin(); it != m_idleConnections.end(); ++it)
+    {
+      if ((*it)->IsFor(url))
+      {
+        CSMBConnection *connection = *it;
+        m_idleConnections.erase(it);
+        return connection;
+      }
+    }
+  }
+
+  CSMBConnection *connection = new CSMBConnection(url.GetHostName(), url.GetShareName());
+  if (!connection->IsValid())
+  {
+    CLog::Log(LOGERROR, "%s - unable to create samba context for %s", __FUNCTION__, url.GetHostName().c_str());
+    delete connection;
+    return NULL;
+  }
+  return connection;
+}
+
+void CSMB::ReleaseConnection(CSMBConnection *connection)
+{
+  if (!connection)
+    return;
+
+  CSingleLock lock(*this);
+  m_idleConnections.push_back(connection);
+  if (m_idleConnections.size() > MAX_IDLE_CONNECTIONS)
+  { // drop the one that has been idle longest
+    delete m_idleConnections.front();
+    m_idleConnections.erase(m_idleConnections.begin());
+  }
+  m_LastActive = timeGetTime();
+}
+
+CSMBConnection::CSMBConnection(const CStdString &host, const CStdString &share)
+{
+  m_host = host;
+  m_share = share;
+  m_context = CSMB::CreateContext();
+}
+
+CSMBConnection::~CSMBConnection()
+{
+  if (m_context)
+  {
+    CSingleLock lock(smb);
+    try
+    {
+      smbc_free_context(m_context, 1);
+    }
+    catch(...)
+    {
+      CLog::Log(LOGERROR,"exception on CSMBConnection::~CSMBConnection. errno: %d", errno);
+    }
+  }
+}
+
+bool CSMBConnection::IsFor(const CURL &url) const
+{
+  return m_host.Equals(url.GetHostName()) && m_share.Equals(url.GetShareName());
+}
+
+SMBCFILE *CSMBConnection::Open(const CStdString &path)
+{
+  CSingleLock lock(smb);
+  return m_context->open(m_context, path.c_str(), O_RDONLY, 0);
+}
+
+void CSMBConnection::Close(SMBCFILE *file)
+{
+  if (file)
+  {
+    CSingleLock lock(smb);
+    m_context->close_fn(m_context, file);
+  }
+}
+
+int CSMBConnection::Read(SMBCFILE *file, void *buffer, unsigned int size)
+{
+  CSingleLock lock(smb);
+  return m_context->read(m_context, file, buffer, size);
+}
+
+__int64 CSMBConnection::Seek(SMBCFILE *file, __int64 position, int whence)
+{
+  CSingleLock lock(smb);
+  return m_context->lseek(m_context, file, (off_t)position, whence);
+}
+
+int CSMBConnection::Stat(const CStdString &path, struct stat *buffer)
+{
+  CSingleLock lock(smb);
+  return m_context->stat(m_context, path.c_str(), buffer);
+}
+
+int CSMBConnection::Stat(SMBCFILE *file, struct stat *buffer)
+{
+  CSingleLock lock(smb);
+  return m_context->fstat(m_context, file, buffer);
+}
+
+namespace XFILE
+{
+/*
+ * A single sequential stream waits a full round trip for each 64k block before
+ * the caller can process it. To hide that we run a few reader threads, each
+ * with its own connection and file handle, that fetch consecutive blocks ahead
+ * of the position the file is being read from. libsmbclient isn't thread safe,
+ * so the samba calls themselves still go one at a time under the CSMB lock.
+ */
+class CSMBReadAhead
+{
+public:
+  CSMBReadAhead(const CURL &url, const CStdString &strFileName, __int64 fileSize, __int64 position, int readers);
+  ~CSMBReadAhead();
+
+  // returns bytes read, or -1 if the data can't be supplied (caller reads it directly)
+  int Read(__int64 position, void *buffer, unsigned int size);
+
+private:
+  static const unsigned int BLOCK_SIZE = 64*1024-2; // see CFileSMB::Read
+
+  struct CBlock
+  {
+    __int64 offset;
+    int size;       // -1 on error
+    bool ready;
+    bool discarded;
+    char data[BLOCK_SIZE];
+  };
+
+  class CReader : public CThread
+  {
+  public:
+    CReader(CSMBReadAhead *owner) { m_owner = owner; };
+  protected:
+    virtual void Process() { m_owner->ReaderProcess(this); };
+    CSMBReadAhead *m_owner;
+  };
+
+  void ReaderProcess(CReader *reader);
+  CBlock *NextBlock();
+  void BlockDone(CBlock *block, int size);
+
+  CURL m_url;
+  CStdString m_strFileName;
+  __int64 m_fileSize;
+
+  CCriticalSection m_section;
+  CEvent m_blockReady;
+  CEvent m_slotFree;
+  std::deque<CBlock *> m_blocks;  // in file order, front is the next block to be read
+  __int64 m_nextOffset;           // offset of the next block to hand to a reader
+  unsigned int m_maxBlocks;
+  int m_activeReaders;
+  bool m_stop;
+  std::vector<CReader *> m_readers;
+};
+
+CSMBReadAhead::CSMBReadAhead(const CURL &url, const CStdString &strFileName, __int64 fileSize, __int64 position, int readers)
+{
+  m_url = url;
+  m_strFileName = strFileName;
+  m_fileSize = fileSize;
+  m_nextOffset = position;
+  m_maxBlocks = readers * 2;
+  m_activeReaders = readers;
+  m_stop = false;
+  for (int i = 0; i < readers; i++)
+  {
+    CReader *reader = new CReader(this);
+    m_readers.push_back(reader);
+    reader->Create();
+  }
+}
+
+CSMBReadAhead::~CSMBReadAhead()
+{
+  {
+    CSingleLock lock(m_section);
+    m_stop = true;
+  }
+  for (unsigned int i = 0; i < m_readers.size(); i++)
+  {
+    m_slotFree.Set();
+    m_readers[i]->StopThread();
+    delete m_readers[i];
+  }
+  for (unsigned int i = 0; i < m_blocks.size(); i++)
+    delete m_blocks[i];
+}
+
+void CSMBReadAhead::ReaderProcess(CReader *reader)
+{
+  CSMBConnection *connection = smb.AcquireConnection(m_url);
+  SMBCFILE *file = connection ? connection->Open(m_strFileName) : NULL;
+  __int64 position = 0;
+
+  while (file)
+  {
+    CBlock *block = NextBlock();
+    if (!block)
+    {
+      CSingleLock lock(m_section);
+      if (m_stop)
+        break;
+      lock.Leave();
+      m_slotFree.WaitMSec(100);
+      continue;
+    }
+
+    int size = -1;
+    if (position == block->offset || connection->Seek(file, block->offset, SEEK_SET) == block->offset)
+    {
+      size = 0;
+      while (size < (int)BLOCK_SIZE)
+      {
+        int bytes = connection->Read(file, block->data + size, BLOCK_SIZE - size);
+        if (bytes <= 0)
+          break;
+        size += bytes;
+      }
+      position = block->offset + size;
+      if (!size)
+        size = -1;
+    }
+    else
+      position = -1;
+    BlockDone(block, size);
+  }
+
+  if (connection)
+  {
+    connection->Close(file);
+    smb.ReleaseConnection(connection);
+  }
+
+  CSingleLock lock(m_section);
+  m_activeReaders--;
+  m_blockReady.Set();
+}
+
+CSMBReadAhead::CBlock *CSMBReadAhead::NextBlock()
+{
+  CSingleLock lock(m_section);
+  if (m_stop || m_blocks.size() >= m_maxBlocks || m_nextOffset >= m_fileSize)
+    return NULL;
+
+  CBlock *block = new CBlock;
+  block->offset = m_nextOffset;
+  block->size = 0;
+  block->ready = false;
+  block->discarded = false;
+  m_blocks.push_back(block);
+  m_nextOffset += BLOCK_SIZE;
+  return block;
+}
+
+void CSMBReadAhead::BlockDone(CBlock *block, int size)
+{
+  CSingleLock lock(m_section);
+  if (block->discarded)
+  { // no longer wanted - we own it
+    delete block;
+    return;
+  }
+  block->size = size;
+  block->ready = true;
+  m_blockReady.Set();
+}
+
+int CSMBReadAhead::Read(__int64 position, void *buffer, unsigned int size)
+{
+  if (position >= m_fileSize)
+    return 0;
+
+  CSingleLock lock(m_section);
+  // drop anything before the requested position.  Blocks still being
+  // fetched are left for their reader to free.
+  while (m_blocks.size() && m_blocks.front()->offset + BLOCK_SIZE <= position)
+  {
+    CBlock *block = m_blocks.front();
+    m_blocks.pop_front();
+    if (block->ready)
+      delete block;
+    else
+      block->discarded = true;
+    m_slotFree.Set();
+  }
+
+  if (m_blocks.empty())
+  {
+    if (m_nextOffset > position || m_activeReaders == 0)
+      return -1;
+    // haven't fetched this far yet - skip ahead
+    m_nextOffset = position;
+    m_slotFree.Set();
+  }
+
+  while (true)
+  {
+    if (m_blocks.size())
+    {
+      CBlock *block = m_blocks.front();
+      if (block->offset > position)
+        return -1;
+      if (block->ready)
+      {
+        if (block->size < 0 || position >= block->offset + block->size)
+          return -1;
+        unsigned int offset = (unsigned int)(position - block->offset);
+        unsigned int bytes = (unsigned int)block->size - offset;
+        if (bytes > size)
+          bytes = size;
+        memcpy(buffer, block->data + offset, bytes);
+        if (offset + bytes == (unsigned int)block->size)
+        {
+          m_blocks.pop_front();
+          delete block;
+          m_slotFree.Set();
+        }
+        return (int)bytes;
+      }
+    }
+    else if (m_activeReaders == 0)
+      return -1;
+
+    lock.Leave();
+    m_blockReady.WaitMSec(100);
+    lock.Enter();
+  }
+}
+}
 #endif
 
 CSMB smb;
@@ -335,6 +701,13 @@ CFileSMB::CFileSMB()
   smb.Init();
   m_fd = -1;
 #ifdef _LINUX
+  m_connection = NULL;
+  m_file = NULL;
+  m_position = 0;
+  m_sequentialReads = 0;
+  m_readAhead = NULL;
+  m_bytesRead = 0;
+  m_openTime = 0;
   smb.AddActiveConnection();
 #endif
 }
@@ -349,6 +722,9 @@ CFileSMB::~CFileSMB()
 
 __int64 CFileSMB::GetPosition()
 {
+#ifdef _LINUX
+  if (m_file) return m_position;
+#endif
   if (m_fd == -1) return 0;
   smb.Init();
   CSingleLock lock(smb);
@@ -360,6 +736,9 @@ __int64 CFileSMB::GetPosition()
 
 __int64 CFileSMB::GetLength()
 {
+#ifdef _LINUX
+  if (m_file) return m_fileSize;
+#endif
   if (m_fd == -1) return 0;
   return m_fileSize;
 }
@@ -384,6 +763,20 @@ bool CFileSMB::Open(const CURL& url, bool bBinary)
   // listed, which will create lot's of open sessions.
 
   CStdString strFileName;
+#ifdef _LINUX
+  // read only files get a samba connection of their own so their session
+  // and file position aren't disturbed by everything else on the global context
+  strFileName = g_passwordManager.GetSMBAuthFilename(smb.URLEncode(url));
+  int error = 0;
+  if (OpenConnection(url, strFileName, error))
+    return true;
+  // only authentication failures are worth retrying on the global context, which can prompt
+  if (error && error != EACCES)
+  {
+    CLog::Log(LOGINFO, "FileSmb->Open: Unable to open file : '%s'\nunix_err:'%x' error : '%s'", strFileName.c_str(), error, strerror(error));
+    return false;
+  }
+#endif
   m_fd = OpenFile(url, strFileName);
 
   CLog::Log(LOGDEBUG,"CFileSMB::Open - opened %s, fd=%d",url.GetFileName().c_str(), m_fd);
@@ -426,6 +819,47 @@ bool CFileSMB::Open(const CURL& url, bool bBinary)
 }
 
 
+#ifdef _LINUX
+bool CFileSMB::OpenConnection(const CURL &url, const CStdString &strFileName, int &error)
+{
+  error = 0;
+  m_connection = smb.AcquireConnection(url);
+  if (!m_connection)
+    return false;
+
+  m_file = m_connection->Open(strFileName);
+  struct stat tmpBuffer;
+  if (!m_file || m_connection->Stat(m_file, &tmpBuffer) < 0)
+  {
+    error = errno ? errno : EIO;
+    CloseConnection();
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG,"CFileSMB::Open - opened %s on its own connection", url.GetFileName().c_str());
+  m_strFileName = strFileName;
+  m_fileSize = tmpBuffer.st_size;
+  m_position = 0;
+  m_sequentialReads = 0;
+  m_bytesRead = 0;
+  m_openTime = timeGetTime();
+  return true;
+}
+
+void CFileSMB::CloseConnection()
+{
+  delete m_readAhead;
+  m_readAhead = NULL;
+  if (m_connection)
+  {
+    m_connection->Close(m_file);
+    smb.ReleaseConnection(m_connection);
+  }
+  m_connection = NULL;
+  m_file = NULL;
+}
+#endif
+
 /// \brief Checks authentication against SAMBA share. Reads password cache created in CSMBDirectory::OpenDir().
 /// \param strAuth The SMB style path
 /// \return SMB file descriptor
@@ -526,17 +960,28 @@ bool CFileSMB::Exists(const CURL& url)
 
 int CFileSMB::Stat(struct __stat64* buffer)
 {
+#ifndef _LINUX
   if (m_fd == -1)
     return -1;
 
-#ifndef _LINUX
   struct __stat64 tmpBuffer = {0};
-#else
-  struct stat tmpBuffer = {0};
-#endif
 
   CSingleLock lock(smb);
   int iResult = smbc_fstat(m_fd, &tmpBuffer);
+#else
+  if (m_fd == -1 && !m_file)
+    return -1;
+
+  struct stat tmpBuffer = {0};
+  int iResult;
+  if (m_file)
+    iResult = m_connection->Stat(m_file, &tmpBuffer);
+  else
+  {
+    CSingleLock lock(smb);
+    iResult = smbc_fstat(m_fd, &tmpBuffer);
+  }
+#endif
 
   buffer->st_dev = tmpBuffer.st_dev;
   buffer->st_ino = tmpBuffer.st_ino;  
@@ -590,10 +1035,11 @@ int CFileSMB::Stat(const CURL& url, struct __stat64* buffer)
 
 unsigned int CFileSMB::Read(void *lpBuf, __int64 uiBufSize)
 {
-  if (m_fd == -1) return 0;
-  CSingleLock lock(smb); // Init not called since it has to be "inited" by now
 #ifdef _LINUX
+  if (m_fd == -1 && !m_file) return 0;
   smb.SetActivityTime();
+#else
+  if (m_fd == -1) return 0;
 #endif
   /* work around stupid bug in samba */
   /* some samba servers has a bug in it where the */
@@ -605,6 +1051,42 @@ unsigned int CFileSMB::Read(void *lpBuf, __int64 uiBufSize)
   if( uiBufSize >= 64*1024-2 )
     uiBufSize = 64*1024-2;
 
+#ifdef _LINUX
+  if (m_file)
+  {
+    // start reading ahead once the file is clearly being streamed
+    if (!m_readAhead && g_advancedSettings.m_sambareadahead > 0 && m_sequentialReads >= 4 && m_position < m_fileSize)
+      m_readAhead = new CSMBReadAhead(m_url, m_strFileName, m_fileSize, m_position, g_advancedSettings.m_sambareadahead);
+
+    int bytesRead = -1;
+    if (m_readAhead)
+    {
+      bytesRead = m_readAhead->Read(m_position, lpBuf, (unsigned int)uiBufSize);
+      if (bytesRead < 0)
+      { // not something the readers can supply (seek backwards, read error), so read it ourselves
+        delete m_readAhead;
+        m_readAhead = NULL;
+        m_sequentialReads = 0;
+      }
+    }
+    // the handle isn't kept in step with reads done by the read ahead, but a
+    // SEEK_SET is handled locally by libsmbclient so it costs nothing
+    if (bytesRead < 0 && m_connection->Seek(m_file, m_position, SEEK_SET) == m_position)
+      bytesRead = m_connection->Read(m_file, lpBuf, (unsigned int)uiBufSize);
+
+    if ( bytesRead < 0 )
+    {
+      CLog::Log(LOGERROR, "%s - Error( %s )", __FUNCTION__, strerror(errno));
+      return 0;
+    }
+    m_position += bytesRead;
+    m_bytesRead += bytesRead;
+    m_sequentialReads++;
+    return (unsigned int)bytesRead;
+  }
+#endif
+
+  CSingleLock lock(smb); // Init not called since it has to be "inited" by now
   int bytesRead = smbc_read(m_fd, lpBuf, (int)uiBufSize);
 
   if ( bytesRead < 0 )
@@ -622,6 +1104,30 @@ unsigned int CFileSMB::Read(void *lpBuf, __int64 uiBufSize)
 
 __int64 CFileSMB::Seek(__int64 iFilePosition, int iWhence)
 {
+#ifdef _LINUX
+  if (m_file)
+  {
+    if(iWhence == SEEK_POSSIBLE)
+      return 1;
+    smb.SetActivityTime();
+    if (iWhence == SEEK_CUR)
+    {
+      iFilePosition += m_position;
+      iWhence = SEEK_SET;
+    }
+    __int64 pos = m_connection->Seek(m_file, iFilePosition, iWhence);
+    if ( pos < 0 )
+    {
+      CLog::Log(LOGERROR, "%s - Error( %s )", __FUNCTION__, strerror(errno));
+      return -1;
+    }
+    // a running read ahead follows small skips forward itself
+    if (pos != m_position && !m_readAhead)
+      m_sequentialReads = 0;
+    m_position = pos;
+    return pos;
+  }
+#endif
   if (m_fd == -1) return -1;
   if(iWhence == SEEK_POSSIBLE)
     return 1;
@@ -647,6 +1153,15 @@ __int64 CFileSMB::Seek(__int64 iFilePosition, int iWhence)
 
 void CFileSMB::Close()
 {
+#ifdef _LINUX
+  if (m_file)
+  {
+    DWORD elapsed = timeGetTime() - m_openTime;
+    CLog::Log(LOGDEBUG,"CFileSMB::Close closing %s, read %"PRId64" bytes in %u ms (%.2f MB/s)", m_url.GetFileName().c_str(),
+              m_bytesRead, elapsed, elapsed ? (double)m_bytesRead / (elapsed * 1024.0 * 1024.0) * 1000.0 : 0.0);
+    CloseConnection();
+  }
+#endif
   if (m_fd != -1)
   {
     CLog::Log(LOGDEBUG,"CFileSMB::Close closing fd %d", m_fd);
@@ -51,6 +51,37 @@
 
 struct _SMBCCTX;
 typedef _SMBCCTX SMBCCTX;
+struct _SMBCFILE;
+typedef _SMBCFILE SMBCFILE;
+
+#ifdef _LINUX
+/*
+ * A private libsmbclient context with its own server sessions.
+ * Files opened for reading borrow one of these from CSMB, so that reading
+ * one file doesn't have to wait for samba calls on any other file to finish.
+ * A connection is only ever used by one thread at a time.
+ */
+class CSMBConnection
+{
+public:
+  CSMBConnection(const CStdString &host, const CStdString &share);
+  ~CSMBConnection();
+  bool IsValid() const { return m_context != NULL; };
+  bool IsFor(const CURL &url) const;
+
+  SMBCFILE *Open(const CStdString &path);
+  void Close(SMBCFILE *file);
+  int Read(SMBCFILE *file, void *buffer, unsigned int size);
+  __int64 Seek(SMBCFILE *file, __int64 position, int whence);
+  int Stat(const CStdString &path, struct stat *buffer);
+  int Stat(SMBCFILE *file, struct stat *buffer);
+
+private:
+  SMBCCTX *m_context;
+  CStdString m_host;
+  CStdString m_share;
+};
+#endif
 
 class CSMB : public CCriticalSection
 {
@@ -66,11 +97,16 @@ public:
   void SetActivityTime();
   void AddActiveConnection();
   void AddIdleConnection();
+
+  CSMBConnection *AcquireConnection(const CURL &url);
+  void ReleaseConnection(CSMBConnection *connection);
 #endif  
   CStdString URLEncode(const CStdString &value);
   CStdString URLEncode(const CURL &url);
 
   DWORD ConvertUnixToNT(int error);
+
+  static SMBCCTX *CreateContext();
 private:
   SMBCCTX *m_context;
   CStdString m_strLastHost;
@@ -78,6 +114,9 @@ private:
 #ifdef _LINUX
   int m_OpenConnections;
   int m_LastActive;
+
+  static const unsigned int MAX_IDLE_CONNECTIONS = 4;
+  std::vector<CSMBConnection *> m_idleConnections;
 #endif
 };
 
@@ -85,6 +124,10 @@ extern CSMB smb;
 
 namespace XFILE
 {
+#ifdef _LINUX
+class CSMBReadAhead;
+#endif
+
 class CFileSMB : public IFile
 {
 public:
@@ -112,6 +155,19 @@ protected:
   __int64 m_fileSize;
   bool m_bBinary;
   int m_fd;
+#ifdef _LINUX
+  // files opened for reading use a connection of their own instead of m_fd
+  bool OpenConnection(const CURL &url, const CStdString &strFileName, int &error);
+  void CloseConnection();
+  CSMBConnection *m_connection;
+  SMBCFILE *m_file;
+  CStdString m_strFileName;
+  __int64 m_position;
+  unsigned int m_sequentialReads;
+  CSMBReadAhead *m_readAhead;
+  __int64 m_bytesRead;
+  DWORD m_openTime;
+#endif
 };
 }
 
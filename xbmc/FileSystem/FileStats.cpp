@@ -0,0 +1,271 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "FileStats.h"
+#include "File.h"
+#include "URL.h"
+#include "utils/SingleLock.h"
+
+using namespace std;
+using namespace XFILE;
+
+CFileStats g_fileStats;
+
+static const char *operationNames[] = { "open", "read", "seek", "stat", "directory" };
+
+CFileStats::CFileStats()
+{
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  m_frequency = frequency.QuadPart / 1000000.0;
+  if (m_frequency <= 0)
+    m_frequency = 1;
+}
+
+CFileStats::~CFileStats()
+{
+  for (map<CStdString, CSource *>::iterator i = m_sources.begin(); i != m_sources.end(); ++i)
+    delete i->second;
+}
+
+__int64 CFileStats::Now()
+{
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return now.QuadPart;
+}
+
+CFileStats::CSource *CFileStats::GetSource(const CURL &url)
+{
+  CStdString protocol(url.GetProtocol());
+  if (protocol.IsEmpty())
+    protocol = "file";
+  protocol.ToLower();
+
+  // network paths go by host and share, local paths by their first two directories
+  CStdString path(url.GetFileName());
+  path.Replace('\\', '/');
+  unsigned int depth = url.GetHostName().IsEmpty() ? 2 : 1;
+  int end = 0;
+  for (unsigned int i = 0; i < depth && end >= 0; i++)
+    end = path.Find('/', end + 1);
+  if (end > 0)
+    path = path.Left(end + 1);
+
+  CStdString name;
+  if (url.GetHostName().IsEmpty())
+    name = protocol + "://" + path;
+  else
+    name = protocol + "://" + url.GetHostName() + "/" + path;
+
+  CSingleLock lock(m_critSection);
+  map<CStdString, CSource *>::iterator i = m_sources.find(name);
+  if (i != m_sources.end())
+    return i->second;
+
+  if (m_sources.size() >= MAX_SOURCES)
+  {
+    name = protocol + "://*";
+    i = m_sources.find(name);
+    if (i != m_sources.end())
+      return i->second;
+  }
+
+  CSource *source = new CSource;
+  memset(source->operations, 0, sizeof(source->operations));
+  memset(source->readSizes, 0, sizeof(source->readSizes));
+  source->bytesRead = 0;
+  source->protocol = protocol;
+  m_sources.insert(make_pair(name, source));
+  return source;
+}
+
+unsigned int CFileStats::Bucket(__int64 value)
+{
+  unsigned int bucket = 0;
+  while (value > 0 && bucket < NUM_BUCKETS - 1)
+  {
+    value >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void CFileStats::AddSample(CSource *source, OPERATION op, __int64 start, bool success, unsigned int size)
+{
+  if (!source)
+    return;
+
+  __int64 time = (__int64)((Now() - start) / m_frequency);
+
+  CSingleLock lock(source->section);
+  COperation &operation = source->operations[op];
+  operation.count++;
+  if (!success)
+    operation.failures++;
+  operation.time += time;
+  operation.times[Bucket(time)]++;
+  if (op == OP_READ && size)
+  {
+    source->bytesRead += size;
+    source->readSizes[Bucket(size)]++;
+  }
+}
+
+void CFileStats::Add(CSource &total, const CSource &source)
+{
+  for (unsigned int op = 0; op < NUM_OPERATIONS; op++)
+  {
+    total.operations[op].count += source.operations[op].count;
+    total.operations[op].failures += source.operations[op].failures;
+    total.operations[op].time += source.operations[op].time;
+    for (unsigned int i = 0; i < NUM_BUCKETS; i++)
+      total.operations[op].times[i] += source.operations[op].times[i];
+  }
+  total.bytesRead += source.bytesRead;
+  for (unsigned int i = 0; i < NUM_BUCKETS; i++)
+    total.readSizes[i] += source.readSizes[i];
+}
+
+CStdString CFileStats::Describe(const CSource &source)
+{
+  CStdString description;
+  for (unsigned int op = 0; op < NUM_OPERATIONS; op++)
+  {
+    const COperation &operation = source.operations[op];
+    if (!operation.count)
+      continue;
+    CStdString part;
+    part.Format("%s%u %s", description.IsEmpty() ? "" : ", ", operation.count, operationNames[op]);
+    if (operation.failures)
+      part.AppendFormat(" (%u failed)", operation.failures);
+    part.AppendFormat(" %.1f ms", operation.time / 1000.0 / operation.count);
+    if (op == OP_READ)
+      part.AppendFormat(" %.1f MB", source.bytesRead / 1048576.0);
+    description += part;
+  }
+  return description;
+}
+
+CStdString CFileStats::DescribeHistogram(const unsigned int *buckets, const char *unit)
+{
+  CStdString histogram;
+  for (unsigned int i = 0; i < NUM_BUCKETS; i++)
+  {
+    if (buckets[i])
+      histogram.AppendFormat(" <%u%s:%u", 1U << i, unit, buckets[i]);
+  }
+  return histogram;
+}
+
+CStdString CFileStats::GetSummary(unsigned int index)
+{
+  // total up each protocol, busiest first
+  map<CStdString, CSource> protocols;
+  {
+    CSingleLock lock(m_critSection);
+    for (map<CStdString, CSource *>::const_iterator i = m_sources.begin(); i != m_sources.end(); ++i)
+    {
+      CSingleLock sourceLock(i->second->section);
+      map<CStdString, CSource>::iterator protocol = protocols.find(i->second->protocol);
+      if (protocol == protocols.end())
+        protocols.insert(make_pair(i->second->protocol, *i->second));
+      else
+        Add(protocol->second, *i->second);
+    }
+  }
+
+  multimap<__int64, CStdString> busiest;
+  for (map<CStdString, CSource>::const_iterator i = protocols.begin(); i != protocols.end(); ++i)
+  {
+    __int64 time = 0;
+    for (unsigned int op = 0; op < NUM_OPERATIONS; op++)
+      time += i->second.operations[op].time;
+    busiest.insert(make_pair(-time, i->first));
+  }
+
+  for (multimap<__int64, CStdString>::const_iterator i = busiest.begin(); i != busiest.end(); ++i)
+  {
+    if (index-- == 0)
+      return i->second + ": " + Describe(protocols[i->second]);
+  }
+  return "";
+}
+
+bool CFileStats::Dump(const CStdString &file)
+{
+  CStdString dump;
+  {
+    CSingleLock lock(m_critSection);
+    for (map<CStdString, CSource *>::const_iterator i = m_sources.begin(); i != m_sources.end(); ++i)
+    {
+      CSingleLock sourceLock(i->second->section);
+      const CSource &source = *i->second;
+      dump += i->first + ": " + Describe(source) + "\n";
+      for (unsigned int op = 0; op < NUM_OPERATIONS; op++)
+      {
+        if (source.operations[op].count)
+          dump.AppendFormat("  %s time:%s\n", operationNames[op], DescribeHistogram(source.operations[op].times, "us").c_str());
+      }
+      if (source.bytesRead)
+        dump.AppendFormat("  read size:%s\n", DescribeHistogram(source.readSizes, "B").c_str());
+    }
+  }
+
+  CFile output;
+  if (!output.OpenForWrite(file, true, true))
+  {
+    CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+  output.Write(dump.c_str(), dump.size());
+  output.Close();
+  CLog::Log(LOGINFO, "%s - wrote filesystem statistics to %s", __FUNCTION__, file.c_str());
+  return true;
+}
+
+void CFileStats::Reset()
+{
+  CSingleLock lock(m_critSection);
+  for (map<CStdString, CSource *>::iterator i = m_sources.begin(); i != m_sources.end(); ++i)
+  {
+    CSingleLock sourceLock(i->second->section);
+    CSource &source = *i->second;
+    memset(source.operations, 0, sizeof(source.operations));
+    memset(source.readSizes, 0, sizeof(source.readSizes));
+    source.bytesRead = 0;
+  }
+}
+
+CFileStatsSample::CFileStatsSample(CFileStats::CSource *source, CFileStats::OPERATION op)
+{
+  m_source = source;
+  m_op = op;
+  m_start = source ? CFileStats::Now() : 0;
+  m_success = false;
+  m_size = 0;
+}
+
+CFileStatsSample::~CFileStatsSample()
+{
+  g_fileStats.AddSample(m_source, m_op, m_start, m_success, m_size);
+}
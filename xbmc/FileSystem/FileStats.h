@@ -0,0 +1,128 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/CriticalSection.h"
+
+#include <map>
+
+class CURL;
+
+namespace XFILE
+{
+/*!
+ \brief Counts the calls, bytes, seeks and time spent in the virtual filesystem.
+
+ CFile and CDirectory record every open, read, seek, stat (and exists) and
+ directory listing here, against the source it went to: the protocol, host and
+ first directory of the path (eg smb://nas/music/), or the first two
+ directories of a local path.  For each source and operation it keeps the
+ number of calls and failures, the total time and a histogram of the time
+ taken, plus a histogram of read sizes.  The histograms have power of two
+ buckets, so a sample costs a timer read either side and a few increments
+ under the source's own lock (so reads from different sources don't contend).
+
+ GetSummary() gives a line per protocol for the system info window, and
+ Dump() writes everything out (builtin FileStats.Dump).  There are at most
+ MAX_SOURCES sources - anything past that is counted against "<protocol>://*".
+ */
+class CFileStats
+{
+public:
+  enum OPERATION { OP_OPEN = 0, OP_READ, OP_SEEK, OP_STAT, OP_DIRECTORY, NUM_OPERATIONS };
+
+  struct CSource;
+
+  CFileStats();
+  ~CFileStats();
+
+  /*! \brief The source to record operations on url against
+   */
+  CSource *GetSource(const CURL &url);
+
+  /*! \brief Record an operation
+   \param start the time it started, from Now()
+   \param size bytes read, or items listed
+   */
+  void AddSample(CSource *source, OPERATION op, __int64 start, bool success, unsigned int size = 0);
+
+  static __int64 Now();
+
+  /*! \brief One line about the protocol with the index'th most time spent on it, or empty
+   */
+  CStdString GetSummary(unsigned int index);
+
+  bool Dump(const CStdString &file);
+  void Reset();
+
+  static const unsigned int NUM_BUCKETS = 24;
+
+  struct COperation
+  {
+    unsigned int count;
+    unsigned int failures;
+    __int64 time;                       // microseconds
+    unsigned int times[NUM_BUCKETS];    // bucket n counts samples under 2^n microseconds
+  };
+
+  struct CSource
+  {
+    CCriticalSection section;           // for the counts below
+    CStdString protocol;
+    COperation operations[NUM_OPERATIONS];
+    __int64 bytesRead;
+    unsigned int readSizes[NUM_BUCKETS]; // bucket n counts reads under 2^n bytes
+  };
+
+private:
+  static unsigned int Bucket(__int64 value);
+  static void Add(CSource &total, const CSource &source);
+  static CStdString Describe(const CSource &source);
+  static CStdString DescribeHistogram(const unsigned int *buckets, const char *unit);
+
+  static const unsigned int MAX_SOURCES = 64;
+
+  CCriticalSection m_critSection;       // for m_sources
+  std::map<CStdString, CSource *> m_sources;
+  double m_frequency;                   // timer ticks per microsecond
+};
+
+/*!
+ \brief Times an operation on a source, and records it when it goes out of scope
+ */
+class CFileStatsSample
+{
+public:
+  CFileStatsSample(CFileStats::CSource *source, CFileStats::OPERATION op);
+  ~CFileStatsSample();
+
+  void SetResult(bool success, unsigned int size = 0) { m_success = success; m_size = size; };
+
+private:
+  CFileStats::CSource *m_source;
+  CFileStats::OPERATION m_op;
+  __int64 m_start;
+  bool m_success;
+  unsigned int m_size;
+};
+}
+
+extern XFILE::CFileStats g_fileStats;
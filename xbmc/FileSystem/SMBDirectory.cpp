@@ -41,6 +41,7 @@
 #include "GUIDialogOK.h"
 #include "Application.h"
 #include "FileItem.h"
+#include "StringUtils.h"
 
 #ifndef _LINUX
 #include "lib/libsmb/xbLibSmb.h"
@@ -62,6 +63,54 @@ struct CachedDirEntry
 
 using namespace DIRECTORY;
 
+#ifdef _LINUX
+/* Gets the mode, size and modification time of an entry with one request to the
+   server ("system.dos_attr.*"), rather than a stat followed by a getxattr for the
+   mode.  Older libsmbclients label the times C_TIME/M_TIME rather than
+   CHANGE_TIME/WRITE_TIME, so both are accepted. */
+static bool GetDosAttributes(const CStdString &strFullName, bool &bIsDir, __int64 &iSize, __int64 &lTimeDate, bool &hidden)
+{
+  char value[1024] = {0};
+  if (smbc_getxattr(strFullName.c_str(), "system.dos_attr.*", value, sizeof(value) - 1) < 0)
+    return false;
+
+  bool haveMode = false, haveSize = false;
+  unsigned long mode = 0;
+  __int64 modified = 0, changed = 0;
+  CStdStringArray fields;
+  StringUtils::SplitString(value, ",", fields);
+  for (unsigned int i = 0; i < fields.size(); i++)
+  {
+    int colon = fields[i].Find(':');
+    if (colon <= 0)
+      continue;
+    CStdString name = fields[i].Left(colon);
+    const char *data = fields[i].c_str() + colon + 1;
+    if (name.Equals("MODE"))
+    {
+      mode = strtoul(data, NULL, 16);
+      haveMode = true;
+    }
+    else if (name.Equals("SIZE"))
+    {
+      iSize = (__int64)strtod(data, NULL);
+      haveSize = true;
+    }
+    else if (name.Equals("WRITE_TIME") || name.Equals("M_TIME"))
+      modified = strtoul(data, NULL, 10);
+    else if (name.Equals("CHANGE_TIME") || name.Equals("C_TIME"))
+      changed = strtoul(data, NULL, 10);
+  }
+  if (!haveMode || !haveSize)
+    return false;
+
+  bIsDir = (mode & SMBC_DOS_MODE_DIRECTORY) != 0;
+  hidden = (mode & SMBC_DOS_MODE_HIDDEN) != 0;
+  lTimeDate = modified ? modified : changed;
+  return true;
+}
+#endif
+
 CSMBDirectory::CSMBDirectory(void)
 {
 #ifdef _LINUX
@@ -157,6 +206,14 @@ bool CSMBDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
  
         lock.Enter();
 
+#ifdef _LINUX
+        if (GetDosAttributes(strFullName, bIsDir, iSize, lTimeDate, hidden))
+        {
+          if (g_guiSettings.GetBool("filelists.showhidden"))
+            hidden = false;
+        }
+        else
+#endif
         if( smbc_stat(strFullName.c_str(), &info) == 0 )
         {
 #ifndef _LINUX
@@ -233,6 +290,7 @@ bool CSMBDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
 
   if (m_cacheDirectory)
     g_directoryCache.SetDirectory(strPath, vecCacheItems);
+  g_directoryCache.SetListing(strPath, vecCacheItems);
 
   return true;
 }
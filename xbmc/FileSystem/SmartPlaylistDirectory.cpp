@@ -95,8 +95,15 @@ namespace DIRECTORY
       if (playlist.GetType().Equals("mixed"))
         playlist.SetType("songs");
 
-      CStdString whereOrder = playlist.GetWhereClause() + " " + playlist.GetOrderClause();
-      success = db.GetSongsByWhere("", whereOrder, items);
+      if (playlist.GetOrder() == CSmartPlaylistRule::FIELD_RANDOM)
+      { // draw from the cached ids rather than having sqlite sort the entire view
+        success = db.GetRandomSongs(playlist.GetWhereClause(), playlist.GetLimit(), std::set<long>(), items);
+      }
+      else
+      {
+        CStdString whereOrder = playlist.GetWhereClause() + " " + playlist.GetOrderClause();
+        success = db.GetSongsByWhere("", whereOrder, items);
+      }
       items.SetContent("songs");
       db.Close();
       playlist.SetType(type);
@@ -108,9 +115,14 @@ namespace DIRECTORY
       CStdString type=playlist.GetType();
       if (playlist.GetType().Equals("mixed"))
         playlist.SetType("musicvideos");
-      CStdString whereOrder = playlist.GetWhereClause() + " " + playlist.GetOrderClause();
       CFileItemList items2;
-      success2 = db.GetMusicVideosByWhere("videodb://3/2/", whereOrder, items2, false); // TODO: SMARTPLAYLISTS Don't check locks???
+      if (playlist.GetOrder() == CSmartPlaylistRule::FIELD_RANDOM)
+        success2 = db.GetRandomMusicVideos(playlist.GetWhereClause(), playlist.GetLimit(), std::set<long>(), items2);
+      else
+      {
+        CStdString whereOrder = playlist.GetWhereClause() + " " + playlist.GetOrderClause();
+        success2 = db.GetMusicVideosByWhere("videodb://3/2/", whereOrder, items2, false); // TODO: SMARTPLAYLISTS Don't check locks???
+      }
       db.Close();
       items.Append(items2);
       items.SetContent("musicvideos");
@@ -285,7 +285,7 @@ void CGUIDialogFileBrowser::OnSort()
 void CGUIDialogFileBrowser::Update(const CStdString &strDirectory)
 {
   if (m_browsingForImages && m_thumbLoader.IsLoading())
-    m_thumbLoader.StopThread();
+    m_thumbLoader.StopThread(false);
   // get selected item
   int iItem = m_viewControl.GetSelectedItem();
   CStdString strSelectedItem = "";
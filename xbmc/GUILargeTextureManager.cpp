@@ -23,77 +23,131 @@
 #include "GUILargeTextureManager.h"
 #include "Picture.h"
 #include "GUISettings.h"
+#include "Settings.h"
 #include "Surface.h"
 #include "FileItem.h"
 #include "Util.h"
 
 CGUILargeTextureManager g_largeTextureManager;
 
+// Loader jobs load queued images in priority order until there's nothing left to load.
+void CGUILargeTextureManager::CLargeTextureJob::DoWork()
+{
+  while (!IsCancelled() && m_manager->LoadNextImage())
+    ;
+}
+
 CGUILargeTextureManager::CGUILargeTextureManager()
 {
-  m_running = false;
+  m_token.reset(new CJobToken);
+  m_loaders = 0;
+  m_uploadedThisFrame = 0;
+  m_cancelled = 0;
+  m_evicted = 0;
+  m_downscaled = 0;
+  m_skinMemoryUsage = 0;
+  m_peakMemoryUsage = 0;
 }
 
 CGUILargeTextureManager::~CGUILargeTextureManager()
 {
-  StopThread();
+  m_token->Cancel();
 }
 
-// Process loop for this thread
-// Check and deallocate images that have been finished with.
-// And allocate new images that have been queued.
-// Once there's nothing queued or allocated, end the thread.
-void CGUILargeTextureManager::Process()
+// Take the highest priority image off the queue and decode it.
+// Returns false (and counts the loader as finished) once the queue is empty.
+bool CGUILargeTextureManager::LoadNextImage()
 {
-  m_running = true;
-  // lock item list
   CSingleLock lock(m_listSection);
-  while (m_queued.size() && !m_bStop)
-  { // load the top item in the queue
-    // take a copy of the details required for the load, as
-    // it may be no longer required by the time the load is complete
-    CLargeTexture *image = m_queued[0];
-    CStdString path = image->GetPath();
-    lock.Leave();
-    // load the image using our image lib
-    SDL_Surface * texture = NULL;
-    CPicture pic;
-    CFileItem file(path, false);
-    if (file.IsPicture() && !(file.IsZIP() || file.IsRAR() || file.IsCBR() || file.IsCBZ())) // ignore non-pictures
-    { // check for filename only (i.e. lookup in skin/media/)
-      CStdString loadPath(path);
-      if ((size_t)path.FindOneOf("/\\") == CStdString::npos)
-      {
-        loadPath = g_TextureManager.GetTexturePath(path);
-      }
-      texture = pic.Load(loadPath, std::min(g_graphicsContext.GetWidth(), 1024), std::min(g_graphicsContext.GetHeight(), 720));
-    }
-    // and add to our allocated list
-    lock.Enter();
-    if (m_queued.size() && m_queued[0]->GetPath() == path)
+  if (!m_queued.size())
+  {
+    m_loaders--;
+    return false;
+  }
+
+  // find the highest priority item - first queued wins amongst equals
+  listIterator next = m_queued.begin();
+  for (listIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  {
+    if ((*it)->GetPriority() < (*next)->GetPriority())
+      next = it;
+  }
+  CLargeTexture *image = *next;
+  m_queued.erase(next);
+  m_loading.push_back(image);
+
+  // take a copy of the details required for the load, as
+  // it may be no longer required by the time the load is complete
+  CStdString path = image->GetPath();
+
+  // make room for the image, loading it at a reduced size if we can't
+  int maxWidth = std::min(g_graphicsContext.GetWidth(), 1024);
+  int maxHeight = std::min(g_graphicsContext.GetHeight(), 720);
+  if (!FreeMemory(maxWidth * maxHeight * 4))
+  {
+    maxWidth /= 2;
+    maxHeight /= 2;
+    m_downscaled++;
+  }
+  lock.Leave();
+
+  LARGE_INTEGER start;
+  QueryPerformanceCounter(&start);
+
+  // load the image using our image lib
+  SDL_Surface * texture = NULL;
+  CPicture pic;
+  CFileItem file(path, false);
+  if (file.IsPicture() && !(file.IsZIP() || file.IsRAR() || file.IsCBR() || file.IsCBZ())) // ignore non-pictures
+  { // check for filename only (i.e. lookup in skin/media/)
+    CStdString loadPath(path);
+    if ((size_t)path.FindOneOf("/\\") == CStdString::npos)
     {
-      // still have the same image in the queue, so move it across to the
-      // allocated list, even if it doesn't exist
-      CLargeTexture *image = m_queued[0];
-      image->SetTexture(texture, pic.GetWidth(), pic.GetHeight(), (g_guiSettings.GetBool("pictures.useexifrotation") && pic.GetExifInfo()->Orientation) ? pic.GetExifInfo()->Orientation - 1: 0);
-      m_allocated.push_back(image);
-      m_queued.erase(m_queued.begin());
+      loadPath = g_TextureManager.GetTexturePath(path);
     }
     else
-    { // no need for the texture any more
-      SDL_FreeSurface(texture);
-      texture = NULL;
+    { // use a pre-scaled variant of cached images (fanart) if there's one big enough
+      loadPath = CPicture::GetBestThumbVariant(path, std::max(maxWidth, maxHeight));
     }
-    lock.Leave();
-    Sleep(1);
-    lock.Enter();
+    texture = pic.Load(loadPath, maxWidth, maxHeight);
+  }
+
+  LARGE_INTEGER end, freq;
+  QueryPerformanceCounter(&end);
+  QueryPerformanceFrequency(&freq);
+
+  // and add to our allocated list.  The image stays on the loading list until we're done
+  // with it, even if it's released in the meantime (ReleaseImage leaves it to us to delete).
+  lock.Enter();
+  m_loadStats.AddSample(1000.f * (end.QuadPart - start.QuadPart) / freq.QuadPart);
+  listIterator it = std::find(m_loading.begin(), m_loading.end(), image);
+  if (it != m_loading.end())
+    m_loading.erase(it);
+  if (!image->IsUnused())
+  {
+    // still required, so move it across to the allocated list, even if it doesn't exist
+    image->SetTexture(texture, pic.GetWidth(), pic.GetHeight(), (g_guiSettings.GetBool("pictures.useexifrotation") && pic.GetExifInfo()->Orientation) ? pic.GetExifInfo()->Orientation - 1: 0);
+    m_allocated.push_back(image);
+    m_peakMemoryUsage = std::max(m_peakMemoryUsage, GetMemoryUsage() + m_skinMemoryUsage);
+  }
+  else
+  { // released while we were loading - no need for the texture any more
+    if (texture)
+      SDL_FreeSurface(texture);
+    delete image;
+    m_cancelled++;
   }
-  m_running = false;
+  return true;
 }
 
 void CGUILargeTextureManager::CleanupUnusedImages()
 {
+  // the skin textures count against our budget, but g_TextureManager may
+  // only be accessed from the main thread, so grab its usage here.
+  DWORD skinMemoryUsage = g_TextureManager.GetMemoryUsage();
+
   CSingleLock lock(m_listSection);
+  m_skinMemoryUsage = skinMemoryUsage;
   // check for items to remove from allocated list, and remove
   listIterator it = m_allocated.begin();
   while (it != m_allocated.end())
@@ -104,14 +158,61 @@ void CGUILargeTextureManager::CleanupUnusedImages()
     else
       ++it;
   }
+  // and get back under budget if the skin has grown
+  FreeMemory(0);
+}
+
+// Evict unused images, least recently used first, until there is room for
+// required more bytes.  Returns false if that much room can't be made.
+bool CGUILargeTextureManager::FreeMemory(DWORD required)
+{
+  CSingleLock lock(m_listSection);
+  DWORD budget = GetBudget();
+  DWORD usage = GetMemoryUsage() + m_skinMemoryUsage;
+  while (usage + required > budget)
+  {
+    listIterator lru = m_allocated.end();
+    for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+    {
+      if ((*it)->IsUnused() && (lru == m_allocated.end() || (*it)->GetLastUsed() < (*lru)->GetLastUsed()))
+        lru = it;
+    }
+    if (lru == m_allocated.end())
+      return false; // everything left is in use
+    usage -= (*lru)->GetMemoryUsage();
+    delete *lru;
+    m_allocated.erase(lru);
+    m_evicted++;
+  }
+  return true;
+}
+
+DWORD CGUILargeTextureManager::GetBudget() const
+{
+  return (DWORD)g_advancedSettings.m_textureCacheSize * 1024 * 1024;
+}
+
+DWORD CGUILargeTextureManager::GetMemoryUsage() const
+{
+  CSingleLock lock(m_listSection);
+  DWORD memUsage = 0;
+  for (unsigned int i = 0; i < m_allocated.size(); i++)
+    memUsage += m_allocated[i]->GetMemoryUsage();
+  return memUsage;
+}
+
+void CGUILargeTextureManager::StartFrame()
+{
+  CSingleLock lock(m_listSection);
+  m_uploadedThisFrame = 0;
 }
 
 // if available, increment reference count, and return the image.
 // else, add to the queue list if appropriate.
 #ifdef HAS_SDL_2D
-SDL_Surface * CGUILargeTextureManager::GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest)
+SDL_Surface * CGUILargeTextureManager::GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest, LOAD_PRIORITY priority)
 #else
-CGLTexture * CGUILargeTextureManager::GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest)
+CGLTexture * CGUILargeTextureManager::GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest, LOAD_PRIORITY priority)
 #endif
 {
   // note: max size to load images: 2048x1024? (8MB)
@@ -123,6 +224,18 @@ CGLTexture * CGUILargeTextureManager::GetImage(const CStdString &path, int &widt
     {
       if (firstRequest)
         image->AddRef();
+      image->Touch();
+      // hand over at most UPLOAD_BUDGET_PER_FRAME bytes of new images per frame (but always at least one)
+      // so that a page of freshly decoded images doesn't hold up a single frame.
+      // The control will ask again next frame.
+      if (!image->IsUploaded() && image->GetTexture())
+      {
+        unsigned int size = image->GetTexture()->pitch * image->GetTexture()->h;
+        if (m_uploadedThisFrame && m_uploadedThisFrame + size > UPLOAD_BUDGET_PER_FRAME)
+          return NULL;
+        m_uploadedThisFrame += size;
+      }
+      image->SetUploaded();
       width = image->GetWidth();
       height = image->GetHeight();
       orientation = image->GetOrientation();
@@ -138,7 +251,7 @@ CGLTexture * CGUILargeTextureManager::GetImage(const CStdString &path, int &widt
   lock.Leave();
 
   if (firstRequest)
-    QueueImage(path);
+    QueueImage(path, priority);
 
   return NULL;
 }
@@ -156,19 +269,33 @@ void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediat
       return;
     }
   }
+  // cancel queued or in-progress loads that are no longer required
   for (listIterator it = m_queued.begin(); it != m_queued.end(); ++it)
   {
     CLargeTexture *image = *it;
-    if (image->GetPath() == path && image->DecrRef(true))
+    if (image->GetPath() == path)
     {
-      m_queued.erase(it);
+      if (image->DecrRef(true))
+      {
+        m_queued.erase(it);
+        m_cancelled++;
+      }
+      return;
+    }
+  }
+  for (listIterator it = m_loading.begin(); it != m_loading.end(); ++it)
+  {
+    CLargeTexture *image = *it;
+    if (image->GetPath() == path)
+    { // the loader still has it, and will delete it once the load is done if it's unused by then
+      image->DecrRef(false);
       return;
     }
   }
 }
 
-// queue the image, and start the background loader if necessary
-void CGUILargeTextureManager::QueueImage(const CStdString &path)
+// queue the image, and start another background loader if necessary
+void CGUILargeTextureManager::QueueImage(const CStdString &path, LOAD_PRIORITY priority)
 {
   CSingleLock lock(m_listSection);
   for (listIterator it = m_queued.begin(); it != m_queued.end(); ++it)
@@ -177,20 +304,39 @@ void CGUILargeTextureManager::QueueImage(const CStdString &path)
     if (image->GetPath() == path)
     {
       image->AddRef();
+      image->RaisePriority(priority);
       return; // already queued
     }
   }
+  for (listIterator it = m_loading.begin(); it != m_loading.end(); ++it)
+  {
+    CLargeTexture *image = *it;
+    if (image->GetPath() == path)
+    {
+      image->AddRef();
+      return; // already loading
+    }
+  }
 
   // queue the item
-  CLargeTexture *image = new CLargeTexture(path);
+  CLargeTexture *image = new CLargeTexture(path, priority);
   m_queued.push_back(image);
 
-  lock.Leave(); // done with our lock
-
-  if (!m_running)
+  // start up a loader for each queued item, up to NUM_LOADERS
+  if (m_loaders < NUM_LOADERS && m_loaders < m_queued.size())
   {
-    StopThread();
-    Create();
+    m_loaders++;
+    g_jobManager.Submit(CJobPtr(new CLargeTextureJob(this)),
+                        priority == PRIORITY_VISIBLE ? CJobManager::PRIORITY_HIGH : CJobManager::PRIORITY_LOW, m_token);
   }
 }
 
+void CGUILargeTextureManager::Dump() const
+{
+  CSingleLock lock(m_listSection);
+  CLog::Log(LOGNOTICE, "large textures: %u queued, %u loading, %u allocated, %u cancelled",
+            (unsigned int)m_queued.size(), (unsigned int)m_loading.size(), (unsigned int)m_allocated.size(), m_cancelled);
+  CLog::Log(LOGNOTICE, "texture memory: %luKB large + %luKB skin of %luKB budget, peak %luKB, %u evicted, %u downscaled",
+            GetMemoryUsage() / 1024, m_skinMemoryUsage / 1024, GetBudget() / 1024, m_peakMemoryUsage / 1024, m_evicted, m_downscaled);
+  m_loadStats.Dump("large textures");
+}
@@ -23,35 +23,61 @@
 
 #include "utils/Thread.h"
 #include "utils/CriticalSection.h"
+#include "utils/JobManager.h"
 #ifdef HAS_SDL
 #include "SDL/SDL.h"
-#include "TextureManager.h"
 #endif
+#include "TextureManager.h"
 
 #include <assert.h>
 
-class CGUILargeTextureManager : public CThread
+/*!
+ \ingroup textures
+ \brief Background loader for large (non-skin) images.
+
+ Images are decoded by up to NUM_LOADERS jobs on the job manager.  Requests are serviced in priority
+ order, and requests that are released before their decode completes are cancelled.  Handing
+ decoded images to the render thread is limited to a byte budget per frame so that a page
+ full of fanart does not stall a single frame.
+
+ Decoded images (along with the skin textures held by g_TextureManager) are kept within
+ the advancedsettings <texturecachesize> budget.  Images no longer in use are kept around
+ while there's room, and evicted least recently used first once the budget is reached.  If
+ there's still not enough room, new images are loaded at a reduced size.
+ */
+class CGUILargeTextureManager
 {
 public:
   CGUILargeTextureManager();
   virtual ~CGUILargeTextureManager();
 
-  virtual void Process();
+  enum LOAD_PRIORITY { PRIORITY_VISIBLE = 0, ///< on screen now
+                       PRIORITY_NEXT_PAGE }; ///< will be on screen shortly (delayed visibility, next page)
 
 #ifdef HAS_SDL_2D
-  SDL_Surface * GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest);
+  SDL_Surface * GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest, LOAD_PRIORITY priority = PRIORITY_VISIBLE);
 #else
-  CGLTexture  * GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest);
+  CGLTexture  * GetImage(const CStdString &path, int &width, int &height, int &orientation, bool firstRequest, LOAD_PRIORITY priority = PRIORITY_VISIBLE);
 #endif
   void ReleaseImage(const CStdString &path, bool immediately = false);
 
   void CleanupUnusedImages();
 
+  /*! \brief Reset the per-frame upload budget.  Called by the application at the start of each frame.
+   */
+  void StartFrame();
+
+  DWORD GetMemoryUsage() const;
+
+  /*! \brief Log the queue, memory and decode time statistics (builtin TextureManager.Dump)
+   */
+  void Dump() const;
+
 protected:
   class CLargeTexture
   {
   public:
-    CLargeTexture(const CStdString &path)
+    CLargeTexture(const CStdString &path, LOAD_PRIORITY priority)
     {
       m_path = path;
       m_width = 0;
@@ -60,6 +86,9 @@ protected:
       m_texture = NULL;
       m_refCount = 1;
       m_timeToDelete = 0;
+      m_priority = priority;
+      m_uploaded = false;
+      m_lastUsed = timeGetTime();
     };
 
     virtual ~CLargeTexture()
@@ -86,6 +115,7 @@ protected:
       return false;
     };
 
+    bool IsUnused() const { return m_refCount == 0; };
     bool DeleteIfRequired()
     {
       if (m_refCount == 0 && m_timeToDelete < timeGetTime())
@@ -110,9 +140,16 @@ protected:
     int GetHeight() const { return m_height; };
     int GetOrientation() const { return m_orientation; };
     const CStdString &GetPath() const { return m_path; };
+    LOAD_PRIORITY GetPriority() const { return m_priority; };
+    void RaisePriority(LOAD_PRIORITY priority) { if (priority < m_priority) m_priority = priority; };
+    bool IsUploaded() const { return m_uploaded; };
+    void SetUploaded() { m_uploaded = true; };
+    void Touch() { m_lastUsed = timeGetTime(); };
+    unsigned int GetLastUsed() const { return m_lastUsed; };
+    DWORD GetMemoryUsage() const { return m_texture ? m_texture->pitch * m_texture->h : 0; };
 
   private:
-    static const unsigned int TIME_TO_DELETE = 2000;
+    static const unsigned int TIME_TO_DELETE = 60000; // unused images are otherwise kept until the budget is needed
 
     unsigned int m_refCount;
     CStdString m_path;
@@ -121,17 +158,45 @@ protected:
     int m_height;
     int m_orientation;
     unsigned int m_timeToDelete;
+    LOAD_PRIORITY m_priority;
+    bool m_uploaded;
+    unsigned int m_lastUsed;
   };
 
-  void QueueImage(const CStdString &path);
+  class CLargeTextureJob : public CJob
+  {
+  public:
+    CLargeTextureJob(CGUILargeTextureManager *manager) : m_manager(manager) {};
+    virtual void DoWork();
+  private:
+    CGUILargeTextureManager *m_manager;
+  };
+
+  void QueueImage(const CStdString &path, LOAD_PRIORITY priority);
+  bool LoadNextImage();
+  bool FreeMemory(DWORD required);
+  DWORD GetBudget() const;
 
 private:
+  static const unsigned int NUM_LOADERS = 2;
+  static const unsigned int UPLOAD_BUDGET_PER_FRAME = 4 * 1024 * 1024; ///< bytes of decoded image data handed to the renderer per frame
+
   std::vector<CLargeTexture *> m_queued;
+  std::vector<CLargeTexture *> m_loading;
   std::vector<CLargeTexture *> m_allocated;
   typedef std::vector<CLargeTexture *>::iterator listIterator;
 
+  CJobTokenPtr m_token;       ///< for the loader jobs
+  unsigned int m_loaders;     ///< loader jobs queued or running
+  unsigned int m_uploadedThisFrame;
+  unsigned int m_cancelled;
+  unsigned int m_evicted;
+  unsigned int m_downscaled;
+  DWORD m_skinMemoryUsage;    ///< cached from g_TextureManager on the main thread
+  DWORD m_peakMemoryUsage;
+  CTextureLoadStats m_loadStats;
+
   CCriticalSection m_listSection;
-  bool m_running;
 };
 
 extern CGUILargeTextureManager g_largeTextureManager;
@@ -66,6 +66,8 @@ CGUIMediaWindow::CGUIMediaWindow(DWORD id, const char *xmlFile)
   m_vecItems->m_strPath = "?";
   m_iLastControl = -1;
   m_iSelectedItem = -1;
+  m_visibleFirst = 0;
+  m_visibleCount = 0;
 
   m_guiState.reset(CGUIViewState::GetViewState(GetID(), *m_vecItems));
 }
@@ -75,6 +77,18 @@ CGUIMediaWindow::~CGUIMediaWindow()
   delete m_vecItems;
 }
 
+void CGUIMediaWindow::Render()
+{
+  int first, count;
+  if (m_viewControl.GetVisibleRange(first, count) && (first != m_visibleFirst || count != m_visibleCount))
+  {
+    m_visibleFirst = first;
+    m_visibleCount = count;
+    OnVisibleItemsChanged(first, count);
+  }
+  CGUIWindow::Render();
+}
+
 void CGUIMediaWindow::OnWindowLoaded()
 {
   CGUIWindow::OnWindowLoaded();
@@ -46,6 +46,7 @@ public:
   virtual bool HasListItems() const { return true; };
   const CGUIViewState *GetViewState() const;
   virtual CFileItemPtr GetCurrentListItem(int offset = 0);
+  virtual void Render();
 
 protected:
   CGUIControl *GetFirstFocusableControl(int id);
@@ -78,6 +79,12 @@ protected:
   virtual void OnDeleteItem(int iItem);
   void OnRenameItem(int iItem);
 
+  /*! \brief Called when the items on screen change, so that background loaders can do those first
+   \param first the first item on screen
+   \param count the number of items that fit on screen
+   */
+  virtual void OnVisibleItemsChanged(int first, int count) {};
+
 protected:
   bool WaitForNetwork() const;
   CPoint GetContextPosition() const;
@@ -93,4 +100,8 @@ protected:
   // save control state on window exit
   int m_iLastControl;
   int m_iSelectedItem;
+
+  // items on screen at the last render
+  int m_visibleFirst;
+  int m_visibleCount;
 };
@@ -171,6 +171,19 @@ int CGUIViewControl::GetSelectedItem() const
   return GetSelectedItem(m_visibleViews[m_currentView]);
 }
 
+bool CGUIViewControl::GetVisibleRange(int &first, int &count) const
+{
+  if (m_currentView < 0 || m_currentView >= (int)m_visibleViews.size())
+    return false; // no valid current view!
+
+  CGUIMessage msg(GUI_MSG_VISIBLE_RANGE, m_parentWindow, m_visibleViews[m_currentView]->GetID());
+  g_graphicsContext.SendMessage(msg);
+
+  first = (int)msg.GetParam1();
+  count = (int)msg.GetParam2();
+  return count > 0;
+}
+
 void CGUIViewControl::SetSelectedItem(int item)
 {
   if (!m_fileItems || item < 0 || item >= m_fileItems->Size())
@@ -44,6 +44,12 @@ public:
   void SetSelectedItem(const CStdString &itemPath);
 
   int GetSelectedItem() const;
+  /*! \brief The items the current view has on screen
+   \param first the first item on screen, which may be before the first in the list
+   \param count the number of items that fit on screen
+   \return false if there's no view
+   */
+  bool GetVisibleRange(int &first, int &count) const;
   void SetFocused();
 
   bool HasControl(int controlID) const;
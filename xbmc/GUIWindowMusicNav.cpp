@@ -359,7 +359,7 @@ bool CGUIWindowMusicNav::GetDirectory(const CStdString &strDirectory, CFileItemL
     return true;
 
   if (m_thumbLoader.IsLoading())
-    m_thumbLoader.StopThread();
+    m_thumbLoader.StopThread(false);
 
   bool bResult = CGUIWindowMusicBase::GetDirectory(strDirectory, items);
   if (bResult)
@@ -41,6 +41,7 @@ public:
 
 protected:
   virtual void OnItemLoaded(CFileItem* pItem) {};
+  virtual void OnVisibleItemsChanged(int first, int count) { m_thumbLoader.SetVisibleItems(first, count); };
   // override base class methods
   virtual bool GetDirectory(const CStdString &strDirectory, CFileItemList &items);
   virtual void UpdateButtons();
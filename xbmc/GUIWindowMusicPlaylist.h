@@ -40,6 +40,7 @@ protected:
   virtual void GoParentFolder() {};
   virtual void UpdateButtons();
   virtual void OnItemLoaded(CFileItem* pItem);
+  virtual void OnVisibleItemsChanged(int first, int count) { m_musicInfoLoader.SetVisibleItems(first, count); };
   virtual bool Update(const CStdString& strDirectory);
   virtual void GetContextButtons(int itemNumber, CContextButtons &buttons);
   virtual bool OnContextButton(int itemNumber, CONTEXT_BUTTON button);
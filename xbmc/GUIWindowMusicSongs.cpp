@@ -567,7 +567,7 @@ void CGUIWindowMusicSongs::PlayItem(int iItem)
 bool CGUIWindowMusicSongs::Update(const CStdString &strDirectory)
 {
   if (m_thumbLoader.IsLoading())
-    m_thumbLoader.StopThread();
+    m_thumbLoader.StopThread(false);
 
   if (!CGUIMediaWindow::Update(strDirectory))
     return false;
@@ -35,6 +35,7 @@ public:
   void DoScan(const CStdString &strPath);
 protected:
   virtual void OnItemLoaded(CFileItem* pItem) {};
+  virtual void OnVisibleItemsChanged(int first, int count) { m_thumbLoader.SetVisibleItems(first, count); };
   virtual bool GetDirectory(const CStdString &strDirectory, CFileItemList &items);
   virtual void UpdateButtons();
   virtual bool Update(const CStdString &strDirectory);
@@ -307,7 +307,7 @@ void CGUIWindowPictures::OnPrepareFileItems(CFileItemList& items)
 bool CGUIWindowPictures::Update(const CStdString &strDirectory)
 {
   if (m_thumbLoader.IsLoading())
-    m_thumbLoader.StopThread();
+    m_thumbLoader.StopThread(false);
 
   if (!CGUIMediaWindow::Update(strDirectory))
     return false;
@@ -56,6 +56,7 @@ protected:
   void OnSlideShowRecursive();
   void AddDir(CGUIWindowSlideShow *pSlideShow, const CStdString& strPath);
   virtual void OnItemLoaded(CFileItem* pItem);
+  virtual void OnVisibleItemsChanged(int first, int count) { m_thumbLoader.SetVisibleItems(first, count); };
   virtual void LoadPlayList(const CStdString& strPlayList);
 
   CGUIDialogProgress* m_dlgProgress;
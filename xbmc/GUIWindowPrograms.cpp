@@ -284,7 +284,7 @@ bool CGUIWindowPrograms::OnContextButton(int itemNumber, CONTEXT_BUTTON button)
 bool CGUIWindowPrograms::Update(const CStdString &strDirectory)
 {
   if (m_thumbLoader.IsLoading())
-    m_thumbLoader.StopThread();
+    m_thumbLoader.StopThread(false);
 
   if (!CGUIMediaWindow::Update(strDirectory))
     return false;
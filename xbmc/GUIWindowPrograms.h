@@ -35,6 +35,7 @@ public:
   virtual bool OnMessage(CGUIMessage& message);
 protected:
   virtual void OnItemLoaded(CFileItem* pItem) {};
+  virtual void OnVisibleItemsChanged(int first, int count) { m_thumbLoader.SetVisibleItems(first, count); };
   virtual bool Update(const CStdString& strDirectory);
   virtual bool OnPlayMedia(int iItem);
   virtual bool GetDirectory(const CStdString &strDirectory, CFileItemList &items);
@@ -1496,7 +1496,7 @@ void CGUIWindowVideoBase::PlayItem(int iItem)
 bool CGUIWindowVideoBase::Update(const CStdString &strDirectory)
 {
   if (m_thumbLoader.IsLoading())
-    m_thumbLoader.StopThread();
+    m_thumbLoader.StopThread(false);
 
   if (!CGUIMediaWindow::Update(strDirectory))
     return false;
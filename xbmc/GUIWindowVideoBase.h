@@ -51,6 +51,7 @@ protected:
   virtual bool Update(const CStdString &strDirectory);
   virtual bool GetDirectory(const CStdString &strDirectory, CFileItemList &items);
   virtual void OnItemLoaded(CFileItem* pItem) {};
+  virtual void OnVisibleItemsChanged(int first, int count) { m_thumbLoader.SetVisibleItems(first, count); };
   virtual void OnPrepareFileItems(CFileItemList &items);
 
   virtual void GetContextButtons(int itemNumber, CContextButtons &buttons);
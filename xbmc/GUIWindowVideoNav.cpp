@@ -388,7 +388,7 @@ bool CGUIWindowVideoNav::GetDirectory(const CStdString &strDirectory, CFileItemL
   CFileItem directory(strDirectory, true);
 
   if (m_thumbLoader.IsLoading())
-    m_thumbLoader.StopThread();
+    m_thumbLoader.StopThread(false);
 
   m_rootDir.SetCacheDirectory(false);
   items.ClearProperties();
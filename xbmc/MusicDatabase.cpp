@@ -44,6 +44,7 @@
 #include "Settings.h"
 #include "FileItem.h"
 #include "Application.h"
+#include "utils/RandomSampler.h"
 
 using namespace std;
 using namespace AUTOPTR;
@@ -53,11 +54,11 @@ using namespace MUSICDATABASEDIRECTORY;
 using namespace MEDIA_DETECT;
 
 #define MUSIC_DATABASE_OLD_VERSION 1.6f
-#define MUSIC_DATABASE_VERSION        10
+#define MUSIC_DATABASE_VERSION        12
 #define MUSIC_DATABASE_NAME "MyMusic7.db"
 #define RECENTLY_ADDED_LIMIT  g_guiSettings.GetInt("musiclibrary.recentcount")
 #define RECENTLY_PLAYED_LIMIT g_guiSettings.GetInt("musiclibrary.recentcount")
-#define MIN_FULL_SEARCH_LENGTH 3
+#define SEARCH_SONG_LIMIT 1000
 
 using namespace CDDB;
 
@@ -87,7 +88,7 @@ bool CMusicDatabase::CreateTables()
     CLog::Log(LOGINFO, "create genre table");
     m_pDS->exec("CREATE TABLE genre ( idGenre integer primary key, strGenre text)\n");
     CLog::Log(LOGINFO, "create path table");
-    m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strHash text)\n");
+    m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strHash text, iPathHash integer)\n");
     CLog::Log(LOGINFO, "create song table");
     m_pDS->exec("CREATE TABLE song ( idSong integer primary key, idAlbum integer, idPath integer, idArtist integer, strExtraArtists text, idGenre integer, strExtraGenres text, strTitle text, iTrack integer, iDuration integer, iYear integer, dwFileNameCRC text, strFileName text, strMusicBrainzTrackID text, strMusicBrainzArtistID text, strMusicBrainzAlbumID text, strMusicBrainzAlbumArtistID text, strMusicBrainzTRMID text, iTimesPlayed integer, iStartOffset integer, iEndOffset integer, idThumb integer, lastplayed text default NULL, rating char default '0', comment text)\n");
     CLog::Log(LOGINFO, "create albuminfo table");
@@ -134,12 +135,15 @@ bool CMusicDatabase::CreateTables()
     m_pDS->exec("CREATE INDEX idxArtist ON artist(strArtist)");
     CLog::Log(LOGINFO, "create path index");
     m_pDS->exec("CREATE INDEX idxPath ON path(strPath)");
+    m_pDS->exec("CREATE UNIQUE INDEX idxPathHash ON path(iPathHash)");
     CLog::Log(LOGINFO, "create song index");
     m_pDS->exec("CREATE INDEX idxSong ON song(strTitle)");
     CLog::Log(LOGINFO, "create song index1");
     m_pDS->exec("CREATE INDEX idxSong1 ON song(iTimesPlayed)");
     CLog::Log(LOGINFO, "create song index2");
     m_pDS->exec("CREATE INDEX idxSong2 ON song(lastplayed)");
+    CLog::Log(LOGINFO, "create song index3");
+    m_pDS->exec("CREATE INDEX idxSong3 ON song(idPath)");
     CLog::Log(LOGINFO, "create thumb index");
     m_pDS->exec("CREATE INDEX idxThumb ON thumb(strThumb)");
     //m_pDS->exec("CREATE INDEX idxSong ON song(dwFileNameCRC)");
@@ -152,9 +156,13 @@ bool CMusicDatabase::CreateTables()
     CLog::Log(LOGINFO, "create albuminfo trigger");
     m_pDS->exec("CREATE TRIGGER tgrAlbumInfo AFTER delete ON albuminfo FOR EACH ROW BEGIN delete from albuminfosong where albuminfosong.idAlbumInfo=old.idAlbumInfo; END");
 
+    // search index
+    CreateSearchIndex();
+    CreateSearchTriggers();
+
     // views
     CLog::Log(LOGINFO, "create song view");
-    m_pDS->exec("create view songview as select idSong, song.strExtraArtists as strExtraArtists, song.strExtraGenres as strExtraGenres, strTitle, iTrack, iDuration, song.iYear as iYear, dwFileNameCRC, strFileName, strMusicBrainzTrackID, strMusicBrainzArtistID, strMusicBrainzAlbumID, strMusicBrainzAlbumArtistID, strMusicBrainzTRMID, iTimesPlayed, iStartOffset, iEndOffset, lastplayed, rating, comment, song.idAlbum as idAlbum, strAlbum, strPath, song.idArtist as idArtist, strArtist, song.idGenre as idGenre, strGenre, strThumb from song join album on song.idAlbum=album.idAlbum join path on song.idPath=path.idPath join artist on song.idArtist=artist.idArtist join genre on song.idGenre=genre.idGenre join thumb on song.idThumb=thumb.idThumb");
+    m_pDS->exec("create view songview as select idSong, song.strExtraArtists as strExtraArtists, song.strExtraGenres as strExtraGenres, strTitle, iTrack, iDuration, song.iYear as iYear, dwFileNameCRC, strFileName, strMusicBrainzTrackID, strMusicBrainzArtistID, strMusicBrainzAlbumID, strMusicBrainzAlbumArtistID, strMusicBrainzTRMID, iTimesPlayed, iStartOffset, iEndOffset, lastplayed, rating, comment, song.idAlbum as idAlbum, strAlbum, song.idPath as idPath, strPath, song.idArtist as idArtist, strArtist, song.idGenre as idGenre, strGenre, strThumb from song join album on song.idAlbum=album.idAlbum join path on song.idPath=path.idPath join artist on song.idArtist=artist.idArtist join genre on song.idGenre=genre.idGenre join thumb on song.idThumb=thumb.idThumb");
     CLog::Log(LOGINFO, "create album view");
     m_pDS->exec("create view albumview as select album.idAlbum as idAlbum, strAlbum, strExtraArtists, "
                 "album.idArtist as idArtist, album.strExtraGenres as strExtraGenres, album.idGenre as idGenre, "
@@ -261,6 +269,8 @@ void CMusicDatabase::AddSong(const CSong& song, bool bCheck)
 
       m_pDS->exec(strSQL.c_str());
       lSongId = (long)sqlite3_last_insert_rowid(m_pDB->getHandle());
+      AddToSearchIndex(search_song, lSongId, song.strTitle);
+      g_randomSampler.Invalidate("songs:");
     }
 
     // add extra artists and genres
@@ -330,6 +340,7 @@ long CMusicDatabase::AddAlbum(const CStdString& strAlbum1, long lArtistId, const
 
       CAlbumCache album;
       album.idAlbum = (long)sqlite3_last_insert_rowid(m_pDB->getHandle());
+      AddToSearchIndex(search_album, album.idAlbum, strAlbum);
       album.strAlbum = strAlbum;
       album.idArtist = lArtistId;
       album.strArtist = strArtist;
@@ -446,6 +457,7 @@ long CMusicDatabase::AddArtist(const CStdString& strArtist1)
       strSQL=FormatSQL("insert into artist (idArtist, strArtist) values( NULL, '%s' )", strArtist.c_str());
       m_pDS->exec(strSQL.c_str());
       int idArtist = (long)sqlite3_last_insert_rowid(m_pDB->getHandle());
+      AddToSearchIndex(search_artist, idArtist, strArtist);
       m_artistCache.insert(pair<CStdString, int>(strArtist1, idArtist));
       return idArtist;
     }
@@ -611,13 +623,13 @@ long CMusicDatabase::AddPath(const CStdString& strPath)
     if (it != m_pathCache.end())
       return it->second;
 
-    strSQL=FormatSQL( "select * from path where strPath like '%s'", strPath.c_str());
+    strSQL=FormatSQL( "select * from path where iPathHash=%I64d", HashPath(strPath));
     m_pDS->query(strSQL.c_str());
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
-      strSQL=FormatSQL("insert into path (idPath, strPath) values( NULL, '%s' )", strPath.c_str());
+      strSQL=FormatSQL("insert into path (idPath, strPath, iPathHash) values( NULL, '%s', %I64d )", strPath.c_str(), HashPath(strPath));
       m_pDS->exec(strSQL.c_str());
 
       int idPath = (long)sqlite3_last_insert_rowid(m_pDB->getHandle());
@@ -813,9 +825,9 @@ bool CMusicDatabase::GetSongByFileName(const CStdString& strFileName, CSong& son
     DWORD crc = ComputeCRC(strFileName);
 
     CStdString strSQL=FormatSQL("select * from songview "
-                                "where dwFileNameCRC='%ul' and strPath like'%s'"
+                                "where dwFileNameCRC='%ul' and idPath in (select idPath from path where iPathHash=%I64d)"
                                 , crc,
-                                strPath.c_str());
+                                HashPath(strPath));
 
     if (!m_pDS->query(strSQL.c_str())) return false;
     int iRowsFound = m_pDS->num_rows();
@@ -840,7 +852,7 @@ long CMusicDatabase::GetAlbumIdByPath(const CStdString& strPath)
 {
   try
   {
-    CStdString strSQL=FormatSQL("select distinct idAlbum from song join path on song.idPath = path.idPath where path.strPath like '%s'", strPath.c_str());
+    CStdString strSQL=FormatSQL("select distinct idAlbum from song join path on song.idPath = path.idPath where path.iPathHash=%I64d", HashPath(strPath));
     m_pDS->query(strSQL.c_str());
     if (m_pDS->eof())
       return -1;
@@ -927,15 +939,13 @@ bool CMusicDatabase::SearchArtists(const CStdString& search, CFileItemList &arti
     // Exclude "Various Artists"
     long lVariousArtistId = AddArtist(g_localizeStrings.Get(340));
 
-    CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=FormatSQL("select * from artist "
-                                "where (strArtist like '%s%%' or strArtist like '%% %s%%') and idArtist <> %i "
-                                , search.c_str(), search.c_str(), lVariousArtistId );
-    else
-      strSQL=FormatSQL("select * from artist "
-                                "where strArtist like '%s%%' and idArtist <> %i "
-                                , search.c_str(), lVariousArtistId );
+    vector<long> ids;
+    if (!SearchIndex(search_artist, search, ids) || ids.empty())
+      return false;
+
+    CStdString strSQL=FormatSQL("select * from artist "
+                                "where idArtist in %s and idArtist <> %i "
+                                , FormatIdList(ids).c_str(), lVariousArtistId );
 
     if (!m_pDS->query(strSQL.c_str())) return false;
     if (m_pDS->num_rows() == 0)
@@ -971,55 +981,6 @@ bool CMusicDatabase::SearchArtists(const CStdString& search, CFileItemList &arti
   return false;
 }
 
-bool CMusicDatabase::GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet,
-                                       const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField, 
-                                       const CStdString& strCloseField, CStdString& strResult)
-{
-  try
-  {
-    strResult = "";
-    if (NULL == m_pDB.get()) return false;
-    if (NULL == m_pDS.get()) return false;
-    CStdString strSQL=FormatSQL(strQuery);
-    if (!m_pDS->query(strSQL.c_str()))
-    {
-      strResult = m_pDB->getErrorMsg();
-      return false;
-    }
-    strResult=strOpenRecordSet;
-    while (!m_pDS->eof())
-    {
-      strResult += strOpenRecord;
-      for (int i=0; i<m_pDS->fieldCount(); i++)
-      {
-        strResult += strOpenField;
-        strResult += m_pDS->fv(i).get_asString();
-        strResult += strCloseField;
-      }
-      strResult += strCloseRecord;
-      m_pDS->next();
-    }
-    strResult += strCloseRecordSet;
-    m_pDS->close();
-    return true;
-  }
-  catch (...)
-  {
-    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, strQuery.c_str());
-  }
-  try
-  {
-    if (NULL == m_pDB.get()) return false;
-      strResult = m_pDB->getErrorMsg();
-  }
-  catch (...)
-  {
-
-  }
-
-  return false;
-}
-
 bool CMusicDatabase::GetAlbumInfo(long idAlbum, CAlbum &info, VECSONGS* songs)
 {
   try
@@ -1481,6 +1442,7 @@ bool CMusicDatabase::IncrTop100CounterByFileName(const CStdString& strFileName)
 
     CStdString sql=FormatSQL("UPDATE song SET iTimesPlayed=iTimesPlayed+1, lastplayed=CURRENT_TIMESTAMP where idSong=%ld", songID);
     m_pDS->exec(sql.c_str());
+    g_randomSampler.Invalidate("songs:"); // rules can be on the play count or last played
     return true;
   }
   catch (...)
@@ -1503,7 +1465,7 @@ bool CMusicDatabase::GetSongsByPath(const CStdString& strPath, CSongMap& songs,
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL=FormatSQL("select * from songview where strPath like '%s'", strPath.c_str() );
+    CStdString strSQL=FormatSQL("select * from songview where idPath in (select idPath from path where iPathHash=%I64d)", HashPath(strPath));
     if (!m_pDS->query(strSQL.c_str())) return false;
     int iRowsFound = m_pDS->num_rows();
     if (iRowsFound == 0)
@@ -1565,11 +1527,11 @@ bool CMusicDatabase::SearchSongs(const CStdString& search, CFileItemList &items)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=FormatSQL("select * from songview where strTitle like '%s%%' or strTitle like '%% %s%%' limit 1000", search.c_str(), search.c_str());
-    else
-      strSQL=FormatSQL("select * from songview where strTitle like '%s%%' limit 1000", search.c_str());
+    vector<long> ids;
+    if (!SearchIndex(search_song, search, ids, SEARCH_SONG_LIMIT) || ids.empty())
+      return false;
+
+    CStdString strSQL=FormatSQL("select * from songview where idSong in %s", FormatIdList(ids).c_str());
 
     if (!m_pDS->query(strSQL.c_str())) return false;
     if (m_pDS->num_rows() == 0) return false;
@@ -1601,11 +1563,11 @@ bool CMusicDatabase::SearchAlbums(const CStdString& search, CFileItemList &album
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=FormatSQL("select * from albumview where strAlbum like '%s%%' or strAlbum like '%% %s%%'", search.c_str(), search.c_str());
-    else
-      strSQL=FormatSQL("select * from albumview where strAlbum like '%s%%'", search.c_str());
+    vector<long> ids;
+    if (!SearchIndex(search_album, search, ids) || ids.empty())
+      return false;
+
+    CStdString strSQL=FormatSQL("select * from albumview where idAlbum in %s", FormatIdList(ids).c_str());
 
     if (!m_pDS->query(strSQL.c_str())) return false;
 
@@ -1816,6 +1778,7 @@ bool CMusicDatabase::CleanupSongsByIds(const CStdString &strSongIds)
     // ok, now delete these songs + all references to them from the exartistsong and exgenresong tables
     strSQL = "delete from song where idSong in " + strSongsToDelete;
     m_pDS->exec(strSQL.c_str());
+    g_randomSampler.Invalidate("songs:");
     strSQL = "delete from exartistsong where idSong in " + strSongsToDelete;
     m_pDS->exec(strSQL.c_str());
     strSQL = "delete from exgenresong where idSong in " + strSongsToDelete;
@@ -2729,7 +2692,7 @@ bool CMusicDatabase::GetAlbumFromSong(const CSong &song, CAlbum &album)
     CStdString path, file;
     CUtil::Split(song.strFileName, path, file);
 
-    CStdString strSQL = FormatSQL("select albumview.* from song join albumview on song.idAlbum = albumview.idAlbum join path on song.idPath = path.idPath where song.strFileName like '%s' and path.strPath like '%s'", file.c_str(), path.c_str());
+    CStdString strSQL = FormatSQL("select albumview.* from song join albumview on song.idAlbum = albumview.idAlbum join path on song.idPath = path.idPath where song.strFileName like '%s' and path.iPathHash=%I64d", file.c_str(), HashPath(path));
     if (!m_pDS->query(strSQL.c_str())) return false;
     int iRowsFound = m_pDS->num_rows();
     if (iRowsFound != 1)
@@ -3042,6 +3005,24 @@ bool CMusicDatabase::UpdateOldVersion(int version)
                   "left outer join thumb on album.idThumb=thumb.idThumb "
                   "left outer join albuminfo on album.idAlbum=albumInfo.idAlbum");
     }
+    if (version < 11)
+    { // word index for searching
+      BeginTransaction();
+      CreateSearchIndex();
+      CreateSearchTriggers();
+      RebuildSearchIndex();
+      CommitTransaction();
+    }
+    if (version < 12)
+    { // hashed path lookups
+      BeginTransaction();
+      m_pDS->exec("alter table path add iPathHash integer");
+      UpdatePathHashes();
+      m_pDS->exec("CREATE INDEX idxSong3 ON song(idPath)");
+      m_pDS->exec("drop view songview");
+      m_pDS->exec("create view songview as select idSong, song.strExtraArtists as strExtraArtists, song.strExtraGenres as strExtraGenres, strTitle, iTrack, iDuration, song.iYear as iYear, dwFileNameCRC, strFileName, strMusicBrainzTrackID, strMusicBrainzArtistID, strMusicBrainzAlbumID, strMusicBrainzAlbumArtistID, strMusicBrainzTRMID, iTimesPlayed, iStartOffset, iEndOffset, lastplayed, rating, comment, song.idAlbum as idAlbum, strAlbum, song.idPath as idPath, strPath, song.idArtist as idArtist, strArtist, song.idGenre as idGenre, strGenre, strThumb from song join album on song.idAlbum=album.idAlbum join path on song.idPath=path.idPath join artist on song.idArtist=artist.idArtist join genre on song.idGenre=genre.idGenre join thumb on song.idThumb=thumb.idThumb");
+      CommitTransaction();
+    }
 
     return true;
   }
@@ -3053,6 +3034,39 @@ bool CMusicDatabase::UpdateOldVersion(int version)
   return true;
 }
 
+void CMusicDatabase::CreateSearchTriggers()
+{
+  // keep the search index in step with deletions, wherever they come from
+  CLog::Log(LOGINFO, "create search index triggers");
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrSongSearch AFTER delete ON song FOR EACH ROW BEGIN delete from searchindex where iType=%i and idItem=old.idSong; END", search_song).c_str());
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrAlbumSearch AFTER delete ON album FOR EACH ROW BEGIN delete from searchindex where iType=%i and idItem=old.idAlbum; END", search_album).c_str());
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrArtistSearch AFTER delete ON artist FOR EACH ROW BEGIN delete from searchindex where iType=%i and idItem=old.idArtist; END", search_artist).c_str());
+}
+
+void CMusicDatabase::RebuildSearchIndex()
+{
+  const char *tables[] = { "select idSong, strTitle from song",
+                           "select idAlbum, strAlbum from album",
+                           "select idArtist, strArtist from artist" };
+  const int types[] = { search_song, search_album, search_artist };
+
+  CLog::Log(LOGINFO, "building search index");
+  m_pDS->exec("delete from searchindex");
+  for (unsigned int i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+  {
+    vector< pair<long, CStdString> > items;
+    m_pDS->query(tables[i]);
+    while (!m_pDS->eof())
+    {
+      items.push_back(make_pair(m_pDS->fv(0).get_asLong(), CStdString(m_pDS->fv(1).get_asString())));
+      m_pDS->next();
+    }
+    m_pDS->close();
+    for (unsigned int j = 0; j < items.size(); j++)
+      AddToSearchIndex(types[i], items[j].first, items[j].second);
+  }
+}
+
 long CMusicDatabase::AddThumb(const CStdString& strThumb1)
 {
   CStdString strSQL;
@@ -3447,39 +3461,45 @@ bool CMusicDatabase::GetAlbumById(long idAlbum, CStdString& strAlbum)
   return false;
 }
 
-bool CMusicDatabase::GetRandomSong(CFileItem* item, long& lSongId, const CStdString& strWhere)
+bool CMusicDatabase::GetRandomSongs(const CStdString& strWhere, unsigned int count, const set<long> &exclude, CFileItemList &items)
 {
   try
   {
-    lSongId = -1;
-
-    // seed random function
-    srand(timeGetTime());
-
-    int iCount = GetSongsCount(strWhere);
-    if (iCount <= 0)
-      return false;
-    int iRandom = rand() % iCount;
-
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    // We don't use FormatSQL here, as the WHERE clause is already formatted.
-    CStdString strSQL;
-    strSQL.Format("select * from songview %s order by idSong limit 1 offset %i", strWhere.c_str(), iRandom);
-    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound != 1)
+    if (!count && exclude.empty())
+    { // everything matching, just shuffled
+      CFileItemList songs;
+      if (!GetSongsByWhere("", strWhere, songs))
+        return false;
+      songs.Randomize();
+      items.Append(songs);
+      return true;
+    }
+
+    // draw from the cached ids matching this where clause, fetching them if we don't have them yet
+    CStdString key = "songs:" + strWhere;
+    vector<long> ids;
+    if (!g_randomSampler.Sample(key, count, exclude, ids))
     {
-      m_pDS->close();
-      return false;
+      vector<pair<int,long> > songIDs;
+      GetSongIDs(strWhere, songIDs);
+      vector<long> pool;
+      pool.reserve(songIDs.size());
+      for (unsigned int i = 0; i < songIDs.size(); i++)
+        pool.push_back(songIDs[i].second);
+      g_randomSampler.SetPool(key, pool);
+      g_randomSampler.Sample(key, count, exclude, ids);
     }
-    GetFileItemFromDataset(item, "");
-    lSongId = m_pDS->fv("songview.idSong").get_asLong();
-    m_pDS->close();
+    if (ids.empty())
+      return false;
+
+    CFileItemList songs;
+    if (!GetSongsByWhere("", "where songview.idSong in " + FormatIdList(ids), songs))
+      return false;
+    songs.Randomize(); // they come back in database order
+    items.Append(songs);
     return true;
   }
   catch(...)
@@ -3630,7 +3650,7 @@ bool CMusicDatabase::GetPathHash(const CStdString &path, CStdString &hash)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL=FormatSQL("select strHash from path where strPath like '%s'", path.c_str());
+    CStdString strSQL=FormatSQL("select strHash from path where iPathHash=%I64d", HashPath(path));
     m_pDS->query(strSQL.c_str());
     if (m_pDS->num_rows() == 0)
       return false;
@@ -3678,7 +3698,7 @@ bool CMusicDatabase::RemoveSongsFromPath(const CStdString &path, CSongMap &songs
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString sql=FormatSQL("select * from songview where strPath like '%s'", path.c_str() );
+    CStdString sql=FormatSQL("select * from songview where idPath in (select idPath from path where iPathHash=%I64d)", HashPath(path));
     if (!m_pDS->query(sql.c_str())) return false;
     int iRowsFound = m_pDS->num_rows();
     if (iRowsFound > 0)
@@ -3699,13 +3719,14 @@ bool CMusicDatabase::RemoveSongsFromPath(const CStdString &path, CSongMap &songs
       // and delete all songs, exartistsongs and exgenresongs
       sql = "delete from song where idSong in " + songIds;
       m_pDS->exec(sql.c_str());
+      g_randomSampler.Invalidate("songs:");
       sql = "delete from exartistsong where idSong in " + songIds;
       m_pDS->exec(sql.c_str());
       sql = "delete from exgenresong where idSong in " + songIds;
       m_pDS->exec(sql.c_str());
     }
     // and remove the path as well (it'll be re-added later on with the new hash if it's non-empty)
-    sql = FormatSQL("delete from path where strPath like '%s'", path.c_str());
+    sql = FormatSQL("delete from path where iPathHash=%I64d", HashPath(path));
     m_pDS->exec(sql.c_str());
     return iRowsFound > 0;
   }
@@ -3761,6 +3782,7 @@ bool CMusicDatabase::SetSongRating(const CStdString &filePath, char rating)
 
     CStdString sql = FormatSQL("update song set rating='%c' where idSong = %i", rating, songID);
     m_pDS->exec(sql.c_str());
+    g_randomSampler.Invalidate("songs:");
     return true;
   }
   catch (...)
@@ -3791,7 +3813,7 @@ long CMusicDatabase::GetSongIDFromPath(const CStdString &filePath)
 
     DWORD crc = ComputeCRC(filePath);
 
-    CStdString sql = FormatSQL("select idSong from song join path on song.idPath = path.idPath where song.dwFileNameCRC='%ul'and path.strPath='%s'", crc, strPath.c_str());
+    CStdString sql = FormatSQL("select idSong from song join path on song.idPath = path.idPath where song.dwFileNameCRC='%ul'and path.iPathHash=%I64d", crc, HashPath(strPath));
     if (!m_pDS->query(sql.c_str())) return -1;
 
     if (m_pDS->num_rows() == 0)
@@ -143,8 +143,6 @@ public:
   bool GetAlbumFromSong(long idSong, CAlbum &album);
   bool GetAlbumFromSong(const CSong &song, CAlbum &album);
 
-  bool GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet, 
-                         const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField, const CStdString& strCloseField, CStdString& strResult);
   bool GetTop100(const CStdString& strBaseDir, CFileItemList& items);
   bool GetTop100Albums(VECALBUMS& albums);
   bool GetTop100AlbumSongs(const CStdString& strBaseDir, CFileItemList& item);
@@ -167,7 +165,7 @@ public:
   bool GetSongsByYear(const CStdString& baseDir, CFileItemList& items, long year);
   bool GetSongsByWhere(const CStdString &baseDir, const CStdString &whereClause, CFileItemList& items);
   bool GetAlbumsByWhere(const CStdString &baseDir, const CStdString &where, const CStdString &order, CFileItemList &items);
-  bool GetRandomSong(CFileItem* item, long& lSongId, const CStdString& strWhere);
+  bool GetRandomSongs(const CStdString& strWhere, unsigned int count, const std::set<long> &exclude, CFileItemList &items);
   int GetSongsCount();
   int GetSongsCount(const CStdString& strWhere);
   unsigned int GetSongIDs(const CStdString& strWhere, std::vector<std::pair<int,long> > &songIDs);
@@ -228,7 +226,17 @@ private:
   bool SearchArtists(const CStdString& search, CFileItemList &artists);
   bool SearchAlbums(const CStdString& search, CFileItemList &albums);
   bool SearchSongs(const CStdString& strSearch, CFileItemList &songs);
+  void CreateSearchTriggers();
+  void RebuildSearchIndex();
   long GetSongIDFromPath(const CStdString &filePath);
+
+  // item types in the search index
+  enum _SearchTypes
+  {
+    search_song=1,
+    search_album,
+    search_artist
+  };
   
     // Fields should be ordered as they 
   // appear in the songview
@@ -28,6 +28,7 @@
 #include "FileSystem/MusicDatabaseDirectory/DirectoryNode.h"
 #include "Util.h"
 #include "MusicInfoTag.h"
+#include "MusicInfoTagCache.h"
 #include "FileSystem/File.h"
 #include "GUISettings.h"
 #include "FileItem.h"
@@ -66,7 +67,7 @@ void CMusicInfoLoader::OnLoaderStart()
 
   m_strPrevPath.Empty();
 
-  m_databaseHits = m_tagReads = 0;
+  m_databaseHits = m_tagReads = m_tagCacheHits = 0;
 
   if (m_pProgressCallback)
     m_pProgressCallback->SetProgressMax(m_pVecItems->GetFileCount());
@@ -152,14 +153,25 @@ bool CMusicInfoLoader::LoadItem(CFileItem* pItem)
     }
   }
   else if (g_guiSettings.GetBool("musicfiles.usetags") || pItem->IsCDDA())
-  { // Nothing found, load tag from file,
+  { // Nothing found, load tag from file (unless we've read it recently),
     // always try to load cddb info
-    // get correct tag parser
-    auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->m_strPath));
-    if (NULL != pLoader.get())
-      // get tag
-      pLoader->Load(pItem->m_strPath, *pItem->GetMusicInfoTag());
-    m_tagReads++;
+    CStdString thumb;
+    if (g_musicInfoTagCache.Get(*pItem, *pItem->GetMusicInfoTag(), thumb))
+    {
+      if (!thumb.IsEmpty())
+        pItem->SetThumbnailImage(thumb);
+      m_tagCacheHits++;
+    }
+    else
+    {
+      // get correct tag parser
+      auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->m_strPath));
+      if (NULL != pLoader.get())
+        // get tag
+        pLoader->Load(pItem->m_strPath, *pItem->GetMusicInfoTag());
+      m_tagReads++;
+      g_musicInfoTagCache.Set(*pItem, *pItem->GetMusicInfoTag(), "");
+    }
   }
 
   m_strPrevPath = strPath;
@@ -174,6 +186,9 @@ void CMusicInfoLoader::OnLoaderFinish()
   // cleanup last loaded songs from database
   m_songsMap.Clear();
 
+  CLog::Log(LOGDEBUG, "%s - %u tags from the tag cache, %u database lookups, %u tags read (tag cache hits %u, misses %u)",
+            __FUNCTION__, m_tagCacheHits, m_databaseHits, m_tagReads, g_musicInfoTagCache.GetHits(), g_musicInfoTagCache.GetMisses());
+
   // cleanup cache loaded from HD
   m_mapFileItems->Clear();
 
@@ -197,15 +212,17 @@ void CMusicInfoLoader::LoadCache(const CStdString& strFileName, CFileItemList& i
 
   if (file.Open(_P(strFileName)))
   {
-    CArchive ar(&file, CArchive::load);
+    CArchive ar(&file, CArchive::load, CArchive::compact);
     int iSize = 0;
     ar >> iSize;
-    for (int i = 0; i < iSize; i++)
+    for (int i = 0; i < iSize && !ar.IsFailed(); i++)
     {
       CFileItemPtr pItem(new CFileItem());
       ar >> *pItem;
       items.Add(pItem);
     }
+    if (ar.IsFailed())
+      items.Clear();
     ar.Close();
     file.Close();
     items.SetFastLookup(true);
@@ -223,7 +240,7 @@ void CMusicInfoLoader::SaveCache(const CStdString& strFileName, CFileItemList& i
 
   if (file.OpenForWrite(_P(strFileName)))
   {
-    CArchive ar(&file, CArchive::store);
+    CArchive ar(&file, CArchive::store, CArchive::compact);
     ar << (int)items.Size();
     for (int i = 0; i < iSize; i++)
     {
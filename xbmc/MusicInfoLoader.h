@@ -49,5 +49,6 @@ protected:
   CMusicDatabase m_musicDatabase;
   unsigned int m_databaseHits;
   unsigned int m_tagReads;
+  unsigned int m_tagCacheHits;
 };
 }
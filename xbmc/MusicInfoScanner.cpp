@@ -34,6 +34,7 @@
 #include "xbox/XKGeneral.h"
 #include "NfoFile.h"
 #include "MusicInfoTag.h"
+#include "MusicInfoTagCache.h"
 #include "GUIWindowManager.h"
 #include "GUIDialogProgress.h"
 #include "GUIDialogSelect.h"
@@ -90,11 +91,13 @@ void CMusicInfoScanner::Process()
       m_currentItem=0;
       m_itemCount=-1;
 
-      // Create the thread to count all files to be scanned
+      if (g_advancedSettings.m_bMusicLibraryIncrementalUpdate)
+        m_journal.Open(CUtil::AddFileToFolder(g_settings.GetDatabaseFolder(), "MyMusicJournal.dat"));
+
+      // list everything to be scanned in the background, which gives us the count of files
       SetPriority(THREAD_PRIORITY_IDLE);
-      CThread fileCountReader(this);
-      if (m_pObserver)
-        fileCountReader.Create();
+      vector<CStdString> roots(m_pathsToScan.begin(), m_pathsToScan.end());
+      m_walker.Start(roots, g_stSettings.m_musicExtensions + "|.jpg|.tbn", this);
 
       // Database operations should not be canceled
       // using Interupt() while scanning as it could
@@ -132,7 +135,8 @@ void CMusicInfoScanner::Process()
       //else
       //  m_musicDatabase.RollbackTransaction();
 
-      fileCountReader.StopThread();
+      m_walker.Stop();
+      m_journal.Close();
 
       m_musicDatabase.EmptyCache();
 
@@ -216,7 +220,6 @@ void CMusicInfoScanner::Start(const CStdString& strDirectory)
   }
   else
     m_pathsToScan.insert(strDirectory);
-  m_pathsToCount = m_pathsToScan;
   m_scanType = 0;
   StopThread();
   Create();
@@ -314,6 +317,7 @@ void CMusicInfoScanner::Stop()
   if (m_bCanInterrupt)
     m_musicDatabase.Interupt();
 
+  m_walker.Stop();
   StopThread();
 }
 
@@ -327,9 +331,50 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   if (m_pObserver)
     m_pObserver->OnDirectoryChanged(strDirectory);
 
+  vector<CStdString> folders;
+  int files = 0;
+  CStdString dbHash;
+  if (m_journal.IsUnchanged(strDirectory, folders, files) && m_musicDatabase.GetPathHash(strDirectory, dbHash))
+  { // nothing in it has been added, removed or renamed since it was scanned, so don't even list it
+    CLog::Log(LOGDEBUG, "%s Skipping dir '%s' as it hasn't changed", __FUNCTION__, strDirectory.c_str());
+    m_currentItem += files;
+
+    // notify our observer of our progress
+    if (m_pObserver)
+    {
+      if (m_itemCount>0)
+        m_pObserver->OnSetProgress(m_currentItem, m_itemCount);
+      m_pObserver->OnDirectoryScanned(strDirectory);
+    }
+  }
+  else
+    ScanDirectory(strDirectory, folders);
+
+  // remove this path from the list we're processing
+  set<CStdString>::iterator it = m_pathsToScan.find(strDirectory);
+  if (it != m_pathsToScan.end())
+    m_pathsToScan.erase(it);
+
+  // now scan the subfolders
+  for (unsigned int i = 0; i < folders.size(); ++i)
+  {
+    if (m_bStop)
+      break;
+    if (!DoScan(folders[i]))
+    {
+      m_bStop = true;
+    }
+  }
+
+  return !m_bStop;
+}
+
+void CMusicInfoScanner::ScanDirectory(const CStdString& strDirectory, vector<CStdString>& folders)
+{
   // load subfolder
   CFileItemList items;
-  CDirectory::GetDirectory(strDirectory, items, g_stSettings.m_musicExtensions + "|.jpg|.tbn");
+  if (!m_walker.Take(strDirectory, items))
+    CDirectory::GetDirectory(strDirectory, items, g_stSettings.m_musicExtensions + "|.jpg|.tbn");
 
   // sort and get the path hash.  Note that we don't filter .cue sheet items here as we want
   // to detect changes in the .cue sheet as well.  The .cue sheet items only need filtering
@@ -337,6 +382,15 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   items.Sort(SORT_METHOD_LABEL, SORT_ORDER_ASC);
   CStdString hash;
   GetPathHash(items, hash);
+  int files = CountFiles(items);
+
+  // if we have a directory item (non-playlist) we then recurse into that folder
+  folders.clear();
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    if (items[i]->m_bIsFolder && WalkInto(*items[i]))
+      folders.push_back(items[i]->m_strPath);
+  }
 
   // get the folder's thumb (this will cache the album thumb).
   items.SetMusicThumb(true); // true forces it to get a remote thumb
@@ -367,7 +421,7 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   else
   { // path is the same - no need to rescan
     CLog::Log(LOGDEBUG, "%s Skipping dir '%s' due to no change", __FUNCTION__, strDirectory.c_str());
-    m_currentItem += CountFiles(items, false);  // false for non-recursive
+    m_currentItem += files;
 
     // notify our observer of our progress
     if (m_pObserver)
@@ -378,30 +432,8 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
     }
   }
 
-  // remove this path from the list we're processing
-  set<CStdString>::iterator it = m_pathsToScan.find(strDirectory);
-  if (it != m_pathsToScan.end())
-    m_pathsToScan.erase(it);
-
-  // now scan the subfolders
-  for (int i = 0; i < items.Size(); ++i)
-  {
-    CFileItemPtr pItem = items[i];
-
-    if (m_bStop)
-      break;
-    // if we have a directory item (non-playlist) we then recurse into that folder
-    if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
-    {
-      CStdString strPath=pItem->m_strPath;
-      if (!DoScan(strPath))
-      {
-        m_bStop = true;
-      }
-    }
-  }
-
-  return !m_bStop;
+  if (!m_bStop)
+    m_journal.Update(strDirectory, folders, files);
 }
 
 int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString& strDirectory)
@@ -433,11 +465,14 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
       CSong *dbSong = songsMap.Find(pItem->m_strPath);
 
       CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
-      if (!tag.Loaded() )
+      CStdString thumb;
+      bool read = false;
+      if (!tag.Loaded() && !g_musicInfoTagCache.Get(*pItem, tag, thumb))
       { // read the tag from a file
         auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->m_strPath));
         if (NULL != pLoader.get())
           pLoader->Load(pItem->m_strPath, tag);
+        read = true;
       }
 
       // if we have the itemcount, notify our
@@ -459,6 +494,8 @@ int CMusicInfoScanner::RetrieveMusicInfo(CFileItemList& items, const CStdString&
         pItem->SetMusicThumb();
         song.strThumb = pItem->GetThumbnailImage();
         songsToAdd.push_back(song);
+        if (read)
+          g_musicInfoTagCache.Set(*pItem, tag, song.strThumb);
 //        CLog::Log(LOGDEBUG, "%s - Tag loaded for: %s", __FUNCTION__, spItem->m_strPath.c_str());
       }
       else
@@ -655,48 +692,35 @@ void CMusicInfoScanner::UpdateFolderThumb(const VECSONGS &songs, const CStdStrin
   }
 }
 
-// This function is run by another thread
-void CMusicInfoScanner::Run()
+// These are called by the directory walker's jobs
+bool CMusicInfoScanner::WalkInto(const CFileItem &folder)
 {
-  int count = 0;
-  while (!m_bStop && m_pathsToCount.size())
-    count+=CountFilesRecursively(*m_pathsToCount.begin());
-  m_itemCount = count;
+  return !folder.IsParentFolder() && !folder.IsPlayList();
 }
 
-// Recurse through all folders we scan and count files
-int CMusicInfoScanner::CountFilesRecursively(const CStdString& strPath)
+bool CMusicInfoScanner::IsUnchanged(const CStdString &strDirectory, vector<CStdString> &folders, int &files)
 {
-  // load subfolder
-  CFileItemList items;
-//  CLog::Log(LOGDEBUG, __FUNCTION__" - processing dir: %s", strPath.c_str());
-  CDirectory::GetDirectory(strPath, items, g_stSettings.m_musicExtensions, false);
-
-  if (m_bStop)
-    return 0;
-
-  // true for recursive counting
-  int count = CountFiles(items, true);
+  return m_journal.IsUnchanged(strDirectory, folders, files);
+}
 
-  // remove this path from the list we're processing
-  set<CStdString>::iterator it = m_pathsToCount.find(strPath);
-  if (it != m_pathsToCount.end())
-    m_pathsToCount.erase(it);
+int CMusicInfoScanner::OnDirectoryListed(const CStdString &strDirectory, const CFileItemList &items)
+{
+  return CountFiles(items);
+}
 
-//  CLog::Log(LOGDEBUG, __FUNCTION__" - finished processing dir: %s", strPath.c_str());
-  return count;
+void CMusicInfoScanner::OnWalkFinished(int files)
+{
+  m_itemCount = files;
 }
 
-int CMusicInfoScanner::CountFiles(const CFileItemList &items, bool recursive)
+int CMusicInfoScanner::CountFiles(const CFileItemList &items)
 {
   int count = 0;
   for (int i=0; i<items.Size(); ++i)
   {
     const CFileItemPtr pItem=items[i];
 
-    if (recursive && pItem->m_bIsFolder)
-      count+=CountFilesRecursively(pItem->m_strPath);
-    else if (pItem->IsAudio() && !pItem->IsPlayList() && !pItem->IsNFO())
+    if (!pItem->m_bIsFolder && pItem->IsAudio() && !pItem->IsPlayList() && !pItem->IsNFO())
       count++;
   }
   return count;
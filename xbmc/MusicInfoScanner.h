@@ -22,6 +22,8 @@
 #include "utils/Thread.h"
 #include "MusicDatabase.h"
 #include "MusicAlbumInfo.h"
+#include "FileSystem/DirectoryWalker.h"
+#include "FileSystem/DirectoryJournal.h"
 
 class CAlbum;
 class CArtist;
@@ -41,7 +43,7 @@ public:
   virtual void OnFinished() = 0;
 };
 
-class CMusicInfoScanner : CThread, public IRunnable
+class CMusicInfoScanner : CThread, public DIRECTORY::IDirectoryWalkerCallback
 {
 public:
   CMusicInfoScanner();
@@ -66,10 +68,14 @@ protected:
   int GetPathHash(const CFileItemList &items, CStdString &hash);
 
   bool DoScan(const CStdString& strDirectory);
+  void ScanDirectory(const CStdString& strDirectory, std::vector<CStdString>& folders);
 
-  virtual void Run();
-  int CountFiles(const CFileItemList& items, bool recursive);
-  int CountFilesRecursively(const CStdString& strPath);
+  // the walker lists the folders ahead of the scan and counts the files for the progress
+  virtual bool WalkInto(const CFileItem &folder);
+  virtual bool IsUnchanged(const CStdString &strDirectory, std::vector<CStdString> &folders, int &files);
+  virtual int OnDirectoryListed(const CStdString &strDirectory, const CFileItemList &items);
+  virtual void OnWalkFinished(int files);
+  static int CountFiles(const CFileItemList& items);
 
 protected:
   IMusicInfoScannerObserver* m_pObserver;
@@ -84,8 +90,9 @@ protected:
   std::set<CStdString> m_pathsToScan;
   std::set<CAlbum> m_albumsToScan;
   std::set<CArtist> m_artistsToScan;
-  std::set<CStdString> m_pathsToCount;
   std::vector<long> m_artistsScanned;
   std::vector<long> m_albumsScanned;
+  DIRECTORY::CDirectoryWalker m_walker;
+  DIRECTORY::CDirectoryJournal m_journal;   // only open for incremental updates
 };
 }
@@ -0,0 +1,134 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "MusicInfoTagCache.h"
+#include "FileItem.h"
+#include "Util.h"
+#include "utils/SingleLock.h"
+
+using namespace std;
+using namespace MUSIC_INFO;
+
+CMusicInfoTagCache g_musicInfoTagCache;
+
+CMusicInfoTagCache::CMusicInfoTagCache()
+{
+  m_hits = 0;
+  m_misses = 0;
+}
+
+bool CMusicInfoTagCache::CanCache(const CFileItem &item)
+{
+  if (item.m_bIsFolder || item.IsPlayList() || item.IsInternetStream() || item.IsMusicDb() || item.IsCDDA())
+    return false;
+  return item.m_lStartOffset == 0 && item.m_lEndOffset == 0;
+}
+
+bool CMusicInfoTagCache::Get(const CFileItem &item, CMusicInfoTag &tag, CStdString &thumb)
+{
+  if (!CanCache(item))
+    return false;
+
+  CSingleLock lock(m_critSection);
+  map<CStdString, CEntry>::iterator i = m_entries.find(item.m_strPath);
+  if (i == m_entries.end())
+  {
+    m_misses++;
+    return false;
+  }
+
+  CEntry &entry = i->second;
+  if (entry.size != item.m_dwSize || entry.dateTime != item.m_dateTime)
+  { // the file has changed
+    m_used.erase(entry.used);
+    m_entries.erase(i);
+    m_misses++;
+    return false;
+  }
+
+  m_used.splice(m_used.begin(), m_used, entry.used);
+  tag = entry.tag;
+  thumb = entry.thumb;
+  m_hits++;
+  return true;
+}
+
+void CMusicInfoTagCache::Set(const CFileItem &item, const CMusicInfoTag &tag, const CStdString &thumb)
+{
+  if (!CanCache(item) || !tag.Loaded())
+    return;
+
+  CSingleLock lock(m_critSection);
+  map<CStdString, CEntry>::iterator i = m_entries.find(item.m_strPath);
+  if (i == m_entries.end())
+  {
+    if (m_entries.size() >= MAX_ENTRIES)
+    { // drop the least recently used
+      m_entries.erase(m_used.back());
+      m_used.pop_back();
+    }
+    m_used.push_front(item.m_strPath);
+    i = m_entries.insert(make_pair(item.m_strPath, CEntry())).first;
+    i->second.used = m_used.begin();
+  }
+  else
+    m_used.splice(m_used.begin(), m_used, i->second.used);
+
+  CEntry &entry = i->second;
+  entry.dateTime = item.m_dateTime;
+  entry.size = item.m_dwSize;
+  entry.tag = tag;
+  entry.thumb = thumb;
+}
+
+void CMusicInfoTagCache::Invalidate(const CStdString &path)
+{
+  CSingleLock lock(m_critSection);
+  map<CStdString, CEntry>::iterator i = m_entries.find(path);
+  if (i != m_entries.end())
+  {
+    m_used.erase(i->second.used);
+    m_entries.erase(i);
+  }
+}
+
+void CMusicInfoTagCache::InvalidateDirectory(const CStdString &directory)
+{
+  CStdString path(directory);
+  CUtil::AddSlashAtEnd(path);
+
+  // paths below the directory sort together, straight after it
+  CSingleLock lock(m_critSection);
+  map<CStdString, CEntry>::iterator i = m_entries.lower_bound(path);
+  while (i != m_entries.end() && i->first.Left(path.size()) == path)
+  {
+    m_used.erase(i->second.used);
+    m_entries.erase(i++);
+  }
+}
+
+void CMusicInfoTagCache::Clear()
+{
+  CSingleLock lock(m_critSection);
+  m_entries.clear();
+  m_used.clear();
+}
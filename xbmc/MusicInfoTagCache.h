@@ -0,0 +1,103 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "MusicInfoTag.h"
+#include "DateTime.h"
+#include "utils/CriticalSection.h"
+
+#include <list>
+#include <map>
+
+class CFileItem;
+
+namespace MUSIC_INFO
+{
+/*!
+ \brief Keeps the tags of recently seen music files in memory.
+
+ CMusicInfoLoader reads the tags of files that aren't in the music database from
+ the files, every time their directory is shown.  Tags it reads, and tags the
+ music scanner reads, are kept here keyed by path, along with the file's size
+ and date so that a file that has changed is read again.  Only what was read
+ from the file is kept - the database stays authoritative for library songs
+ (their id, rating, playcount) so is always asked first.  The cache is cleared
+ when the music database changes (CUtil::DeleteMusicDatabaseDirectoryCache)
+ and when a profile is loaded.  The least recently used tags are dropped once
+ there are more than MAX_ENTRIES.
+
+ Cue sheet tracks share the path of their file, so they aren't kept.
+ */
+class CMusicInfoTagCache
+{
+public:
+  CMusicInfoTagCache();
+
+  /*! \brief Get the tag (and thumb) kept for a file, if the file hasn't changed since
+   \return true if the tag was found
+   */
+  bool Get(const CFileItem &item, CMusicInfoTag &tag, CStdString &thumb);
+
+  /*! \brief Keep the tag and thumb of a file
+   */
+  void Set(const CFileItem &item, const CMusicInfoTag &tag, const CStdString &thumb);
+
+  /*! \brief Forget a file, eg when it has been deleted or renamed
+   */
+  void Invalidate(const CStdString &path);
+
+  /*! \brief Forget every file in a directory and below
+   */
+  void InvalidateDirectory(const CStdString &directory);
+
+  void Clear();
+
+  unsigned int GetHits() const { return m_hits; };
+  unsigned int GetMisses() const { return m_misses; };
+
+private:
+  struct CEntry
+  {
+    CDateTime dateTime;
+    __int64 size;
+    CMusicInfoTag tag;
+    CStdString thumb;
+    std::list<CStdString>::iterator used;   // position in m_used
+  };
+
+  static bool CanCache(const CFileItem &item);
+
+#ifdef _XBOX
+  static const unsigned int MAX_ENTRIES = 1000;
+#else
+  static const unsigned int MAX_ENTRIES = 10000;
+#endif
+
+  CCriticalSection m_critSection;
+  std::map<CStdString, CEntry> m_entries;
+  std::list<CStdString> m_used;             // paths, most recently used first
+  unsigned int m_hits;
+  unsigned int m_misses;
+};
+}
+
+extern MUSIC_INFO::CMusicInfoTagCache g_musicInfoTagCache;
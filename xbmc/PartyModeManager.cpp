@@ -31,6 +31,8 @@
 #include "GUIWindowManager.h"
 #include "GUIDialogOK.h"
 #include "PlayList.h"
+#include "FileItem.h"
+#include "MusicInfoTag.h"
 
 using namespace std;
 using namespace PLAYLIST;
@@ -310,45 +312,27 @@ bool CPartyModeManager::AddRandomSongs(int iSongs /* = 0 */)
   }
 
   // add songs to fill queue
-  if (m_type.Equals("songs") || m_type.Equals("mixed"))
+  if (iSongsToAdd > 0 && (m_type.Equals("songs") || m_type.Equals("mixed")))
   {
     CMusicDatabase database;
     if (database.Open())
     {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
-      bool error(false);
-      for (int i = 0; i < iSongsToAdd; i++)
-      {
-        pair<CStdString,CStdString> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        long songID;
-        if (database.GetRandomSong(item.get(), songID, whereClause.first))
-        { // success
-          Add(item);
-          AddToHistory(1,songID);
-        }
-        else
-        {
-          error = true;
-          break;
-        }
-      }
-
-      if (error)
+      // songs are drawn from a cached list of the ids matching our filter, less those
+      // in the history, so this doesn't have to query the whole library for each song.
+      set<long> history;
+      GetHistory(1, history);
+      CFileItemList items;
+      if (!database.GetRandomSongs(m_strCurrentFilterMusic, iSongsToAdd, history, items))
       {
         database.Close();
         OnError(16034, (CStdString)"Cannot get songs from database. Aborting.");
         return false;
       }
+      for (int i = 0; i < items.Size(); i++)
+      {
+        Add(items[i]);
+        AddToHistory(1, items[i]->GetMusicInfoTag()->GetDatabaseId());
+      }
     }
     else
     {
@@ -357,45 +341,25 @@ bool CPartyModeManager::AddRandomSongs(int iSongs /* = 0 */)
     }
     database.Close();
   }
-  if (m_type.Equals("musicvideos") || m_type.Equals("mixed"))
+  if (iVidsToAdd > 0 && (m_type.Equals("musicvideos") || m_type.Equals("mixed")))
   {
     CVideoDatabase database;
     if (database.Open())
     {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
-      bool error(false);
-      for (int i = 0; i < iVidsToAdd; i++)
-      {
-        pair<CStdString,CStdString> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        long songID;
-        if (database.GetRandomMusicVideo(item.get(), songID, whereClause.second))
-        { // success
-          Add(item);
-          AddToHistory(2,songID);
-        }
-        else
-        {
-          error = true;
-          break;
-        }
-      }
-
-      if (error)
+      set<long> history;
+      GetHistory(2, history);
+      CFileItemList items;
+      if (!database.GetRandomMusicVideos(m_strCurrentFilterVideo, iVidsToAdd, history, items))
       {
         database.Close();
         OnError(16034, (CStdString)"Cannot get songs from database. Aborting.");
         return false;
       }
+      for (int i = 0; i < items.Size(); i++)
+      {
+        Add(items[i]);
+        AddToHistory(2, items[i]->GetVideoInfoTag()->m_iDbId);
+      }
     }
     else
     {
@@ -605,37 +569,13 @@ bool CPartyModeManager::AddInitialSongs(vector<pair<int,long> > &songIDs)
   return true;
 }
 
-pair<CStdString,CStdString> CPartyModeManager::GetWhereClauseWithHistory() const
+void CPartyModeManager::GetHistory(int type, set<long> &songIDs) const
 {
-  CStdString historyWhereMusic;
-  CStdString historyWhereVideo;
-  // now add this on to the normal where clause
-  if (m_history.size())
+  for (unsigned int i = 0; i < m_history.size(); i++)
   {
-    if (m_strCurrentFilterMusic.IsEmpty())
-      historyWhereMusic = "where songview.idsong not in (";
-    else
-      historyWhereMusic = m_strCurrentFilterMusic + " and songview.idsong not in (";
-    if (m_strCurrentFilterVideo.IsEmpty())
-      historyWhereVideo = "where idmvideo not in (";
-    else
-      historyWhereVideo = m_strCurrentFilterVideo + " and idmvideo not in (";
-
-    for (unsigned int i = 0; i < m_history.size(); i++)
-    {
-      CStdString number;
-      number.Format("%i,", m_history[i].second);
-      if (m_history[i].first == 1)
-        historyWhereMusic += number;
-      if (m_history[i].first == 2)
-        historyWhereVideo += number;
-    }
-    historyWhereMusic.TrimRight(",");
-    historyWhereMusic += ")";
-    historyWhereVideo.TrimRight(",");
-    historyWhereVideo += ")";
+    if (m_history[i].first == type)
+      songIDs.insert(m_history[i].second);
   }
-  return make_pair(historyWhereMusic,historyWhereVideo);
 }
 
 void CPartyModeManager::AddToHistory(int type, long songID)
@@ -647,13 +587,17 @@ void CPartyModeManager::AddToHistory(int type, long songID)
 
 void CPartyModeManager::GetRandomSelection(vector<pair<int,long> >& in, unsigned int number, vector<pair<int,long> >& out)
 {
-  // only works if we have < 32768 in the in vector
+  // partial Fisher-Yates shuffle - the chosen entries are swapped to the front of in
   srand(timeGetTime());
+  if (number > in.size())
+    number = in.size();
   for (unsigned int i = 0; i < number; i++)
   {
-    int num = rand() % in.size();
-    out.push_back(in[num]);
-    in.erase(in.begin() + num);
+    unsigned int num = i + (((unsigned int)rand() << 15) ^ (unsigned int)rand()) % (in.size() - i);
+    pair<int,long> song = in[num];
+    in[num] = in[i];
+    in[i] = song;
+    out.push_back(song);
   }
 }
 
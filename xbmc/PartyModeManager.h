@@ -21,6 +21,7 @@
  */
 
 #include <boost/shared_ptr.hpp>
+#include <set>
 
 class CFileItem; typedef boost::shared_ptr<CFileItem> CFileItemPtr;
 class CFileItemList;
@@ -68,7 +69,7 @@ private:
   int GetSongCount(int iType);
   void ClearState();
   void UpdateStats();
-  std::pair<CStdString,CStdString> GetWhereClauseWithHistory() const;
+  void GetHistory(int type, std::set<long> &songIDs) const;
   void AddToHistory(int type, long songID);
   void GetRandomSelection(std::vector<std::pair<int,long> > &in, unsigned int number, std::vector<std::pair<int, long> > &out);
 
@@ -25,9 +25,34 @@
 #include "Settings.h"
 #include "FileItem.h"
 #include "FileSystem/File.h"
+#include "Util.h"
 
 using namespace XFILE;
 
+// sizes of the pre-scaled variants kept alongside cached images: list icons, posters and fanart.
+static const int thumbVariantSizes[] = { 128, 256, 1280 };
+#define NUM_THUMB_VARIANTS (sizeof(thumbVariantSizes) / sizeof(thumbVariantSizes[0]))
+
+// what we know of the variants of each cached image, so that controls needn't stat them every
+// time they allocate.  Entries are dropped when the variants are rewritten or deleted, or the
+// thumbs refreshed (ForgetThumbVariants).
+#define MAX_THUMB_VARIANT_INFO 5000
+struct CThumbVariantInfo
+{
+  unsigned int variants; // bit i is set if the thumbVariantSizes[i] variant is up to date
+  float aspect;          // width / height of the image, 0 if not known yet
+};
+static std::map<CStdString, CThumbVariantInfo> thumbVariantInfo;
+static CCriticalSection thumbVariantSection;
+
+static void SetThumbVariantInfo(const CStdString &thumb, const CThumbVariantInfo &info)
+{
+  CSingleLock lock(thumbVariantSection);
+  if (thumbVariantInfo.size() >= MAX_THUMB_VARIANT_INFO && thumbVariantInfo.find(thumb) == thumbVariantInfo.end())
+    thumbVariantInfo.clear();
+  thumbVariantInfo[thumb] = info;
+}
+
 CPicture::CPicture(void)
 {
   ZeroMemory(&m_info, sizeof(ImageInfo));
@@ -122,6 +147,7 @@ bool CPicture::DoCreateThumbnail(const CStdString& strFileName, const CStdString
     CLog::Log(LOGERROR, "PICTURE::DoCreateThumbnail: Unable to create thumbfile %s from image %s", strThumbFileName.c_str(), strFileName.c_str());
     return false;
   }
+  CreateThumbnailVariants(strThumbFileName, g_advancedSettings.m_thumbSize);
   return true;
 }
 
@@ -136,9 +162,13 @@ bool CPicture::CacheImage(const CStdString& sourceFileName, const CStdString& de
     CLog::Log(LOGERROR, "%s Unable to create new image %s from image %s", __FUNCTION__, destFileName.c_str(), sourceFileName.c_str());
     return false;
   }
+  CreateThumbnailVariants(destFileName, 1280);
   return true;
 #else
-  return CFile::Cache(sourceFileName, destFileName);
+  if (!CFile::Cache(sourceFileName, destFileName))
+    return false;
+  CreateThumbnailVariants(destFileName, INT_MAX);
+  return true;
 #endif
 }
 
@@ -151,9 +181,163 @@ bool CPicture::CreateThumbnailFromMemory(const BYTE* pBuffer, int nBufSize, cons
     CLog::Log(LOGERROR, "PICTURE::CreateAlbumThumbnailFromMemory: exception: memfile FileType: %s\n", strExtension.c_str());
     return false;
   }
+  CreateThumbnailVariants(strThumbFileName, g_advancedSettings.m_thumbSize);
   return true;
 }
 
+// Writes the pre-scaled variants of the (already cached) image thumb that are smaller than both
+// maxSize and the image itself, and removes any left over from a previous, larger, image.
+// The variants are made from the cached image, so are cheap to produce.
+void CPicture::CreateThumbnailVariants(const CStdString &thumb, int maxSize)
+{
+  if (!m_dll.Load()) return;
+
+  // find the real size of the image - decoding at the smallest variant size is enough for that
+  ImageInfo info;
+  memset(&info, 0, sizeof(ImageInfo));
+  if (!m_dll.LoadImage(thumb.c_str(), thumbVariantSizes[0], thumbVariantSizes[0], &info))
+  {
+    CLog::Log(LOGDEBUG, "%s Unable to read %s", __FUNCTION__, thumb.c_str());
+    DeleteThumbnailVariants(thumb);
+    return;
+  }
+  int imageSize = (int)std::max(info.originalwidth, info.originalheight);
+  CThumbVariantInfo variantInfo;
+  variantInfo.variants = 0;
+  variantInfo.aspect = info.originalheight ? (float)info.originalwidth / info.originalheight : 0.0f;
+  m_dll.ReleaseImage(&info);
+  if (imageSize < maxSize)
+    maxSize = imageSize;
+
+  for (unsigned int i = 0; i < NUM_THUMB_VARIANTS; i++)
+  {
+    CStdString variant = GetThumbVariant(thumb, thumbVariantSizes[i]);
+    if (thumbVariantSizes[i] >= maxSize)
+    {
+      if (CFile::Exists(variant))
+        CFile::Delete(variant);
+      continue;
+    }
+    if (!m_dll.CreateThumbnail(thumb.c_str(), variant.c_str(), thumbVariantSizes[i], thumbVariantSizes[i], false))
+    {
+      CLog::Log(LOGDEBUG, "%s Unable to create %ipx variant of %s", __FUNCTION__, thumbVariantSizes[i], thumb.c_str());
+      CFile::Delete(variant);
+    }
+    else
+      variantInfo.variants |= 1 << i;
+  }
+  SetThumbVariantInfo(thumb, variantInfo);
+}
+
+// Removes all the pre-scaled variants of a cached image
+void CPicture::DeleteThumbnailVariants(const CStdString &thumb)
+{
+  ForgetThumbVariants(thumb);
+  for (unsigned int i = 0; i < NUM_THUMB_VARIANTS; i++)
+  {
+    CStdString variant = GetThumbVariant(thumb, thumbVariantSizes[i]);
+    if (CFile::Exists(variant))
+      CFile::Delete(variant);
+  }
+}
+
+// Returns the filename of the size pixel variant of a cached image
+CStdString CPicture::GetThumbVariant(const CStdString &thumb, int size)
+{
+  CStdString variant(thumb);
+  CStdString extension = CUtil::GetExtension(thumb);
+  CUtil::RemoveExtension(variant);
+  variant.AppendFormat("-%i%s", size, extension.c_str());
+  return variant;
+}
+
+// Returns the smallest variant of a cached image whose longer side is at least size pixels, or
+// the image itself if it isn't a cached image or no such variant exists.  Variants older than the
+// image are stale (the image has been replaced by CFile::Cache() or Copy() since) so aren't used,
+// and neither are variants of an image that has been deleted.  What's on disk is only looked at
+// the first time each image is asked for.
+CStdString CPicture::GetBestThumbVariant(const CStdString &thumb, int size)
+{
+  CStdString thumbFolder = g_settings.GetThumbnailsFolder();
+  if (thumbFolder.IsEmpty())
+    return thumb;
+  if (!thumb.Left(thumbFolder.size()).Equals(thumbFolder))
+  { // may be a translated path
+    thumbFolder = _P(thumbFolder);
+    if (!thumb.Left(thumbFolder.size()).Equals(thumbFolder))
+      return thumb;
+  }
+  if (size > thumbVariantSizes[NUM_THUMB_VARIANTS - 1])
+    return thumb;
+
+  CThumbVariantInfo info;
+  CSingleLock lock(thumbVariantSection);
+  std::map<CStdString, CThumbVariantInfo>::const_iterator it = thumbVariantInfo.find(thumb);
+  if (it != thumbVariantInfo.end())
+    info = it->second;
+  else
+  {
+    lock.Leave();
+    info.variants = 0;
+    info.aspect = 0.0f;
+    struct __stat64 thumbStat;
+    if (CFile::Stat(thumb, &thumbStat) == 0)
+    {
+      for (unsigned int i = 0; i < NUM_THUMB_VARIANTS; i++)
+      {
+        struct __stat64 variantStat;
+        if (CFile::Stat(GetThumbVariant(thumb, thumbVariantSizes[i]), &variantStat) != 0)
+          break; // none of the larger ones exist either
+#ifndef _LINUX
+        if (variantStat.st_mtime >= thumbStat.st_mtime)
+#else
+        if (variantStat._st_mtime >= thumbStat._st_mtime)
+#endif
+          info.variants |= 1 << i;
+      }
+    }
+    // keep what CreateThumbnailVariants() may have recorded meanwhile
+    lock.Enter();
+    if (thumbVariantInfo.size() >= MAX_THUMB_VARIANT_INFO)
+      thumbVariantInfo.clear();
+    info = thumbVariantInfo.insert(std::make_pair(thumb, info)).first->second;
+  }
+
+  for (unsigned int i = 0; i < NUM_THUMB_VARIANTS; i++)
+  {
+    if (size > thumbVariantSizes[i])
+      continue;
+    if (info.variants & (1 << i))
+      return GetThumbVariant(thumb, thumbVariantSizes[i]);
+    break;
+  }
+  return thumb;
+}
+
+// Returns the width / height of a cached image, if we've learnt it, or 0.  Never touches the disk.
+float CPicture::GetThumbAspect(const CStdString &thumb)
+{
+  CSingleLock lock(thumbVariantSection);
+  std::map<CStdString, CThumbVariantInfo>::const_iterator it = thumbVariantInfo.find(thumb);
+  return it != thumbVariantInfo.end() ? it->second.aspect : 0.0f;
+}
+
+// Records the shape of a cached image once it (or one of its variants) has been loaded
+void CPicture::SetThumbAspect(const CStdString &thumb, float aspect)
+{
+  CSingleLock lock(thumbVariantSection);
+  std::map<CStdString, CThumbVariantInfo>::iterator it = thumbVariantInfo.find(thumb);
+  if (it != thumbVariantInfo.end())
+    it->second.aspect = aspect;
+}
+
+// Drops what we know of the variants of a cached image, so that they're looked at again next time
+void CPicture::ForgetThumbVariants(const CStdString &thumb)
+{
+  CSingleLock lock(thumbVariantSection);
+  thumbVariantInfo.erase(thumb);
+}
+
 void CPicture::CreateFolderThumb(const CStdString *strThumbs, const CStdString &folderThumbnail)
 { // we want to mold the thumbs together into one single one
   if (!m_dll.Load()) return;
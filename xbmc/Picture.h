@@ -59,6 +59,15 @@ public:
   // caches a skin image as a thumbnail image
   bool CacheSkinImage(const CStdString &srcFile, const CStdString &destFile);
 
+  // pre-scaled copies of cached images, so that small controls needn't decode (and hold) the full image
+  void CreateThumbnailVariants(const CStdString &thumb, int maxSize);
+  static CStdString GetThumbVariant(const CStdString &thumb, int size);
+  static CStdString GetBestThumbVariant(const CStdString &thumb, int size);
+  static float GetThumbAspect(const CStdString &thumb);
+  static void SetThumbAspect(const CStdString &thumb, float aspect);
+  static void ForgetThumbVariants(const CStdString &thumb);
+  static void DeleteThumbnailVariants(const CStdString &thumb);
+
 protected:
   
 private:
@@ -33,6 +33,7 @@ using namespace XFILE;
 CPictureThumbLoader::CPictureThumbLoader()
 {
   m_regenerateThumbs = false;  
+  m_bIndependentItems = true;
 }
 
 CPictureThumbLoader::~CPictureThumbLoader()
@@ -46,6 +46,7 @@
 #include "GUIDialogYesNo.h"
 #include "FileSystem/Directory.h"
 #include "FileItem.h"
+#include "MusicInfoTagCache.h"
 #ifdef HAS_XBOX_HARDWARE
 #include "utils/MemoryUnitManager.h"
 #endif
@@ -184,6 +185,8 @@ CSettings::CSettings(void)
   g_advancedSettings.m_enableOpticalMedia = false;
   g_advancedSettings.m_cachePath = "Z:\\";
   g_advancedSettings.m_displayRemoteCodes = false;
+  g_advancedSettings.m_guiDirtyRegions = 1;
+  g_advancedSettings.m_guiVisualizeDirtyRegions = false;
 
   g_advancedSettings.m_videoStackRegExps.push_back("[ _\\.-]+cd[ _\\.-]*([0-9a-d]+)");
   g_advancedSettings.m_videoStackRegExps.push_back("[ _\\.-]+dvd[ _\\.-]*([0-9a-d]+)");
@@ -213,9 +216,13 @@ CSettings::CSettings(void)
   g_advancedSettings.m_detectAsUdf = false;
 
   g_advancedSettings.m_thumbSize = 512;
+  g_advancedSettings.m_textureCacheSize = 128;
 
   g_advancedSettings.m_sambaclienttimeout = 10;
+  g_advancedSettings.m_sambareadahead = 4;
   g_advancedSettings.m_sambadoscodepage = "";
+  g_advancedSettings.m_httpServerPort = 3001;
+  g_advancedSettings.m_httpServerThreads = 4;
   g_advancedSettings.m_musicThumbs = "folder.jpg|Folder.jpg|folder.JPG|Folder.JPG|cover.jpg|Cover.jpg|cover.jpeg";
   g_advancedSettings.m_dvdThumbs = "folder.jpg|Folder.jpg|folder.JPG|Folder.JPG";
 
@@ -225,6 +232,7 @@ CSettings::CSettings(void)
   g_advancedSettings.m_strMusicLibraryAlbumFormat = "";
   g_advancedSettings.m_strMusicLibraryAlbumFormatRight = "";
   g_advancedSettings.m_prioritiseAPEv2tags = false;
+  g_advancedSettings.m_bMusicLibraryIncrementalUpdate = false;
   g_advancedSettings.m_musicItemSeparator = " / ";
   g_advancedSettings.m_videoItemSeparator = " / ";
 
@@ -233,6 +241,7 @@ CSettings::CSettings(void)
   g_advancedSettings.m_bVideoLibraryHideRecentlyAddedItems = false;
   g_advancedSettings.m_bVideoLibraryHideEmptySeries = false;
   g_advancedSettings.m_bVideoLibraryCleanOnUpdate = false;
+  g_advancedSettings.m_bVideoLibraryIncrementalUpdate = false;
 
   g_advancedSettings.m_bUseEvilB = true;
 
@@ -1172,6 +1181,7 @@ void CSettings::LoadAdvancedSettings()
     XMLUtils::GetBoolean(pElement, "prioritiseapetags", g_advancedSettings.m_prioritiseAPEv2tags);
     XMLUtils::GetBoolean(pElement, "allitemsonbottom", g_advancedSettings.m_bMusicLibraryAllItemsOnBottom);
     XMLUtils::GetBoolean(pElement, "albumssortbyartistthenyear", g_advancedSettings.m_bMusicLibraryAlbumsSortByArtistThenYear);
+    XMLUtils::GetBoolean(pElement, "incrementalupdate", g_advancedSettings.m_bMusicLibraryIncrementalUpdate);
     GetString(pElement, "albumformat", g_advancedSettings.m_strMusicLibraryAlbumFormat);
     GetString(pElement, "albumformatright", g_advancedSettings.m_strMusicLibraryAlbumFormatRight);
     GetString(pElement, "itemseparator", g_advancedSettings.m_musicItemSeparator);
@@ -1185,6 +1195,7 @@ void CSettings::LoadAdvancedSettings()
     XMLUtils::GetBoolean(pElement, "hiderecentlyaddeditems", g_advancedSettings.m_bVideoLibraryHideRecentlyAddedItems);
     XMLUtils::GetBoolean(pElement, "hideemptyseries", g_advancedSettings.m_bVideoLibraryHideEmptySeries);
     XMLUtils::GetBoolean(pElement, "cleanonupdate", g_advancedSettings.m_bVideoLibraryCleanOnUpdate);
+    XMLUtils::GetBoolean(pElement, "incrementalupdate", g_advancedSettings.m_bVideoLibraryIncrementalUpdate);
     GetString(pElement, "itemseparator", g_advancedSettings.m_videoItemSeparator);
   }
 
@@ -1220,6 +1231,14 @@ void CSettings::LoadAdvancedSettings()
   {
     GetString(pElement,  "doscodepage",   g_advancedSettings.m_sambadoscodepage);
     GetInteger(pElement, "clienttimeout", g_advancedSettings.m_sambaclienttimeout, 5, 100);
+    GetInteger(pElement, "readahead", g_advancedSettings.m_sambareadahead, 0, 16);
+  }
+
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+  {
+    GetInteger(pElement, "port", g_advancedSettings.m_httpServerPort, 0, 65535);
+    GetInteger(pElement, "threads", g_advancedSettings.m_httpServerThreads, 1, 32);
   }
 
   if (GetInteger(pRootElement, "loglevel", g_advancedSettings.m_logLevel, LOG_LEVEL_NONE, LOG_LEVEL_MAX))
@@ -1342,6 +1361,8 @@ void CSettings::LoadAdvancedSettings()
   }
 
   XMLUtils::GetBoolean(pRootElement, "displayremotecodes", g_advancedSettings.m_displayRemoteCodes);
+  GetInteger(pRootElement, "dirtyregions", g_advancedSettings.m_guiDirtyRegions, 1, 0, 2);
+  XMLUtils::GetBoolean(pRootElement, "visualizedirtyregions", g_advancedSettings.m_guiVisualizeDirtyRegions);
 
   // TODO: Should cache path be given in terms of our predefined paths??
   //       Are we even going to have predefined paths??
@@ -1434,6 +1455,7 @@ void CSettings::LoadAdvancedSettings()
   GetInteger(pRootElement, "remoterepeat", g_advancedSettings.m_remoteRepeat, 1, INT_MAX);
   GetFloat(pRootElement, "controllerdeadzone", g_advancedSettings.m_controllerDeadzone, 0.0f, 1.0f);
   GetInteger(pRootElement, "thumbsize", g_advancedSettings.m_thumbSize, g_advancedSettings.m_thumbSize, 64, 1024);
+  GetInteger(pRootElement, "texturecachesize", g_advancedSettings.m_textureCacheSize, g_advancedSettings.m_textureCacheSize, 16, 2048);
 
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", g_advancedSettings.m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", g_advancedSettings.m_detectAsUdf);
@@ -1708,6 +1730,7 @@ bool CSettings::LoadProfile(int index)
     g_localizeStrings.Load(_P(strLanguagePath));
 
     g_infoManager.ResetCache();
+    g_musicInfoTagCache.Clear(); // tags read for the last profile
 
     if (m_iLastLoadedProfileIndex != 0)
     {
@@ -179,6 +179,8 @@ public:
     bool m_enableOpticalMedia;
     CStdString m_cachePath;
     bool m_displayRemoteCodes;
+    int m_guiDirtyRegions;              // 0 render every frame, 1 skip idle frames, 2 redraw changed regions only
+    bool m_guiVisualizeDirtyRegions;
     CStdStringArray m_videoStackRegExps;
     CStdStringArray m_tvshowStackRegExps;
     CStdString m_tvshowMultiPartStackRegExp;
@@ -191,9 +193,13 @@ public:
     bool m_detectAsUdf;
 
     int m_thumbSize;
+    int m_textureCacheSize;   // MB of decoded texture data to keep resident
 
     int m_sambaclienttimeout;
+    int m_sambareadahead;     // read-ahead threads per sequentially read file, 0 to disable
     CStdString m_sambadoscodepage;
+    int m_httpServerPort;     // port of the threaded api/streaming server, 0 to disable
+    int m_httpServerThreads;
     CStdString m_musicThumbs;
     CStdString m_dvdThumbs;
 
@@ -203,6 +209,7 @@ public:
     CStdString m_strMusicLibraryAlbumFormat;
     CStdString m_strMusicLibraryAlbumFormatRight;
     bool m_prioritiseAPEv2tags;
+    bool m_bMusicLibraryIncrementalUpdate;
     CStdString m_musicItemSeparator;
     CStdString m_videoItemSeparator;
     std::vector<CStdString> m_musicTagsFromFileFilters;
@@ -212,6 +219,7 @@ public:
     bool m_bVideoLibraryHideRecentlyAddedItems;
     bool m_bVideoLibraryHideEmptySeries;
     bool m_bVideoLibraryCleanOnUpdate;
+    bool m_bVideoLibraryIncrementalUpdate;
 
     bool m_bUseEvilB;
     std::vector<CStdString> m_vecTokens; // cleaning strings tied to language
@@ -32,11 +32,17 @@
 
 #include "cores/dvdplayer/DVDFileInfo.h"
 
+using namespace std;
 using namespace XFILE;
 using namespace DIRECTORY;
 
+map<CStdString, CVideoThumbLoader::CResult> CVideoThumbLoader::m_results;
+unsigned int CVideoThumbLoader::m_resultsUsed = 0;
+CCriticalSection CVideoThumbLoader::m_resultsSection;
+
 CVideoThumbLoader::CVideoThumbLoader() 
 {  
+  m_bIndependentItems = true;
 }
 
 CVideoThumbLoader::~CVideoThumbLoader()
@@ -52,7 +58,7 @@ void CVideoThumbLoader::OnLoaderFinish()
 {
 }
 
-bool CVideoThumbLoader::ExtractThumb(const CStdString &strPath, const CStdString &strTarget)
+bool CVideoThumbLoader::ExtractThumb(const CStdString &strPath, const CStdString &strTarget, CDVDFileInfo::CThumbScaler *scaler /* = NULL */)
 {
   if (!g_guiSettings.GetBool("myvideos.autothumb"))
     return false;
@@ -67,7 +73,64 @@ bool CVideoThumbLoader::ExtractThumb(const CStdString &strPath, const CStdString
     return false;
 
   CLog::Log(LOGDEBUG,"%s - trying to extract thumb from video file %s", __FUNCTION__, strPath.c_str());
-  return CDVDFileInfo::ExtractThumb(strPath, strTarget);
+  return CDVDFileInfo::ExtractThumb(strPath, strTarget, scaler);
+}
+
+CStdString CVideoThumbLoader::GetAutoThumb(const CFileItem &item, CStdString &strPath)
+{
+  if (!item.IsVideo() || item.IsInternetStream() || item.IsPlayList())
+    return "";
+
+  if (item.IsStack())
+    strPath = CStackDirectory::GetFirstStackedFile(item.m_strPath);
+  else
+    strPath = item.m_strPath;
+
+  // create unique thumb for auto generated thumbs
+  CStdString strDir, strFileName;
+  CUtil::Split(item.GetCachedVideoThumb(), strDir, strFileName);
+  return strDir + "auto-" + strFileName;
+}
+
+bool CVideoThumbLoader::GetResult(const CFileItem &item, CResult &result)
+{
+  CSingleLock lock(m_resultsSection);
+  map<CStdString, CResult>::iterator i = m_results.find(item.m_strPath);
+  if (i == m_results.end())
+    return false;
+
+  // the thumbs we found are in the local thumb cache, so checking they're still
+  // there is cheap - unlike looking for them again on the share
+  const CResult &found = i->second;
+  if (found.dateTime != item.m_dateTime ||
+      (!found.thumb.IsEmpty() && !CFile::Exists(found.thumb)) ||
+      (!found.fanart.IsEmpty() && !CFile::Exists(found.fanart)))
+  {
+    m_results.erase(i);
+    return false;
+  }
+  i->second.used = ++m_resultsUsed;
+  result = found;
+  return true;
+}
+
+void CVideoThumbLoader::SetResult(const CFileItem &item, const CResult &result)
+{
+  CSingleLock lock(m_resultsSection);
+  if (m_results.size() >= MAX_RESULTS && m_results.find(item.m_strPath) == m_results.end())
+  { // evict the least recently used quarter, so this doesn't happen on every new item
+    unsigned int keep = MAX_RESULTS * 3 / 4;
+    for (map<CStdString, CResult>::iterator i = m_results.begin(); i != m_results.end(); )
+    {
+      if (m_resultsUsed - i->second.used >= keep)
+        m_results.erase(i++);
+      else
+        ++i;
+    }
+  }
+  CResult &stored = m_results[item.m_strPath];
+  stored = result;
+  stored.used = ++m_resultsUsed;
 }
 
 bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
@@ -75,35 +138,52 @@ bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
   if (pItem->m_bIsShareOrDrive) return true;
   CStdString cachedThumb(pItem->GetCachedVideoThumb());
 
+  // an item we've already been through (eg when going back to a folder) gets the
+  // same thumb and fanart as last time, including finding there's none, without
+  // looking for them on the share or trying to extract a thumb again
+  CResult result;
+  bool known = GetResult(*pItem, result);
+  if (!known)
+    result.dateTime = pItem->m_dateTime;
+
   if (!pItem->HasThumbnail())
   {
-    pItem->SetUserVideoThumb();
-    if (!CFile::Exists(cachedThumb))
+    if (known && (result.thumb.IsEmpty() || result.autoThumb) && CFile::Exists(cachedThumb))
+    { // a thumb has been set since, which beats none or the auto thumb
+      pItem->SetThumbnailImage(cachedThumb);
+      result.thumb = cachedThumb;
+      result.autoThumb = false;
+      SetResult(*pItem, result);
+    }
+    else if (known)
     {
-      CStdString strPath, strFileName;
-      CUtil::Split(cachedThumb, strPath, strFileName);
-       
-      // create unique thumb for auto generated thumbs
-      cachedThumb = strPath + "auto-" + strFileName;
-      if (pItem->IsVideo() && !pItem->IsInternetStream() && !pItem->IsPlayList() && !CFile::Exists(cachedThumb))
+      if (result.autoThumb)
       {
-        if (pItem->IsStack())
-        {
-          CStackDirectory stack;
-          CVideoThumbLoader::ExtractThumb(stack.GetFirstStackedFile(pItem->m_strPath), cachedThumb);
-        }
-        else
-        {
-          CVideoThumbLoader::ExtractThumb(pItem->m_strPath, cachedThumb);
-        }
+        pItem->SetProperty("HasAutoThumb", "1");
+        pItem->SetProperty("AutoThumbImage", result.thumb);
       }
-  
-      if (CFile::Exists(cachedThumb))
+      if (!result.thumb.IsEmpty())
+        pItem->SetThumbnailImage(result.thumb);
+    }
+    else
+    {
+      pItem->SetUserVideoThumb();
+      if (!CFile::Exists(cachedThumb))
       {
-        pItem->SetProperty("HasAutoThumb", "1");
-        pItem->SetProperty("AutoThumbImage", cachedThumb);
-        pItem->SetThumbnailImage(cachedThumb);
+        CStdString strPath;
+        cachedThumb = GetAutoThumb(*pItem, strPath);
+        if (!cachedThumb.IsEmpty() && !CFile::Exists(cachedThumb))
+          CVideoThumbLoader::ExtractThumb(strPath, cachedThumb);
+  
+        if (!cachedThumb.IsEmpty() && CFile::Exists(cachedThumb))
+        {
+          pItem->SetProperty("HasAutoThumb", "1");
+          pItem->SetProperty("AutoThumbImage", cachedThumb);
+          pItem->SetThumbnailImage(cachedThumb);
+          result.autoThumb = true;
+        }
       }
+      result.thumb = pItem->GetThumbnailImage();
     }
   }
   else
@@ -127,11 +207,27 @@ bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
 
   if (!pItem->HasProperty("fanart_image"))
   {
-    pItem->CacheFanart();
-    if (CFile::Exists(pItem->GetCachedFanart()))
-      pItem->SetProperty("fanart_image",pItem->GetCachedFanart());
+    if (known)
+    {
+      if (!result.fanart.IsEmpty())
+        pItem->SetProperty("fanart_image", result.fanart);
+      else if (CFile::Exists(pItem->GetCachedFanart()))
+        pItem->SetProperty("fanart_image", pItem->GetCachedFanart());
+    }
+    else
+    {
+      pItem->CacheFanart();
+      if (CFile::Exists(pItem->GetCachedFanart()))
+      {
+        pItem->SetProperty("fanart_image",pItem->GetCachedFanart());
+        result.fanart = pItem->GetCachedFanart();
+      }
+    }
   }                          
 
+  if (!known)
+    SetResult(*pItem, result);
+
 //  if (pItem->IsVideo() && !pItem->IsInternetStream())
 //    CDVDPlayer::GetFileMetaData(pItem->m_strPath, pItem);
 
@@ -140,10 +236,12 @@ bool CVideoThumbLoader::LoadItem(CFileItem* pItem)
 
 CProgramThumbLoader::CProgramThumbLoader()
 {
+  m_bIndependentItems = true;
 }
 
 CProgramThumbLoader::~CProgramThumbLoader()
 {
+  StopThread();
 }
 
 bool CProgramThumbLoader::LoadItem(CFileItem *pItem)
@@ -156,10 +254,12 @@ bool CProgramThumbLoader::LoadItem(CFileItem *pItem)
 
 CMusicThumbLoader::CMusicThumbLoader()
 {
+  m_bIndependentItems = true;
 }
 
 CMusicThumbLoader::~CMusicThumbLoader()
 {
+  StopThread();
 }
 
 bool CMusicThumbLoader::LoadItem(CFileItem* pItem)
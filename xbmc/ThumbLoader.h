@@ -22,10 +22,15 @@
 #ifndef THUMBLOADER_H
 #define THUMBLOADER_H
 #include "BackgroundInfoLoader.h"
+#include "DateTime.h"
+#include "utils/CriticalSection.h"
+
+#include <map>
 
 #include "cores/ffmpeg/DllAvFormat.h"
 #include "cores/ffmpeg/DllAvCodec.h"
 #include "cores/ffmpeg/DllSwScale.h"
+#include "cores/dvdplayer/DVDFileInfo.h"
 
 class CVideoThumbLoader : public CBackgroundInfoLoader
 {
@@ -33,7 +38,13 @@ public:
   CVideoThumbLoader();
   virtual ~CVideoThumbLoader();
   virtual bool LoadItem(CFileItem* pItem);
-  bool ExtractThumb(const CStdString &strPath, const CStdString &strTarget);
+  static bool ExtractThumb(const CStdString &strPath, const CStdString &strTarget, CDVDFileInfo::CThumbScaler *scaler = NULL);
+
+  /*! \brief The thumb generated from the video itself for an item that has no other thumb.
+   \param strPath is set to the file to extract it from
+   \return the thumb, or empty if the item isn't a video a thumb can be extracted from
+   */
+  static CStdString GetAutoThumb(const CFileItem &item, CStdString &strPath);
 
 protected:
   virtual void OnLoaderStart() ;
@@ -43,6 +54,27 @@ protected:
   DllAvCodec  m_dllAvCodec;
   DllAvUtil   m_dllAvUtil;
   DllSwScale  m_dllSwScale;
+
+private:
+  /*! \brief What LoadItem found for an item, shared between all the loaders
+   */
+  struct CResult
+  {
+    CResult() : autoThumb(false), used(0) {}
+    CDateTime dateTime;   // the item's date when it was loaded
+    CStdString thumb;     // cached thumb, or empty if there's none
+    bool autoThumb;       // thumb was extracted from the video
+    CStdString fanart;    // cached fanart, or empty if there's none
+    unsigned int used;    // m_resultsUsed when it was last stored or found
+  };
+
+  static bool GetResult(const CFileItem &item, CResult &result);
+  static void SetResult(const CFileItem &item, const CResult &result);
+
+  static const unsigned int MAX_RESULTS = 5000;
+  static std::map<CStdString, CResult> m_results;
+  static unsigned int m_resultsUsed;
+  static CCriticalSection m_resultsSection;
 };
 
 class CProgramThumbLoader : public CBackgroundInfoLoader
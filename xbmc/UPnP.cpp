@@ -174,6 +174,7 @@ public:
         // urls will contain full paths to local files
         m_Path = "";
         m_DirDelimiter = "\\";
+        m_PublishedUpdateID = 0;
     }
 
     // PLT_MediaServer methods
@@ -197,6 +198,8 @@ public:
                                  NPT_String                    uri_path,
                                  NPT_String                    file_path);
 
+    // events SystemUpdateID if it has changed
+    void PublishUpdateID(DWORD update_id);
 
 private:
     NPT_String       BuildHttpUri(const char* host, 
@@ -212,10 +215,32 @@ private:
                            const NPT_HttpRequestContext& context,
                            const char*                   parent_id = NULL);
 
+    // Renderers page through big containers a few items per Browse, so the listing of
+    // the last few containers browsed is kept, along with the DIDL of each item once it
+    // has been built (for containers that aren't too big).  Entries are dropped when the library changes (see
+    // CUtil::GetLibraryUpdateID), after LIBRARY_CACHE_LIFETIME ms for library containers (as not every
+    // change to the library is counted, eg playcounts) and after BROWSE_CACHE_LIFETIME ms for anything
+    // outside the library, which we aren't told about changes to.
+    struct CBrowseCacheEntry {
+        NPT_String                id;
+        CFileItemList             items;
+        DWORD                     update_id;
+        DWORD                     created;
+        DWORD                     last_used;
+        NPT_String                didl_key;   // filter and host the didl was built for
+        std::vector<NPT_String>   didl;
+        CCriticalSection          lock;       // held while building didl
+    };
+    typedef boost::shared_ptr<CBrowseCacheEntry> CBrowseCacheEntryPtr;
+
+    CBrowseCacheEntryPtr GetCacheEntry(const NPT_String& id, DWORD update_id);
+    void                 AddCacheEntry(CBrowseCacheEntryPtr entry);
+
     NPT_Result       BuildResponse(PLT_ActionReference&          action,
                                    CFileItemList&                items,
                                    const NPT_HttpRequestContext& context,
-                                   const char*                   parent_id);
+                                   const char*                   parent_id,
+                                   CBrowseCacheEntry*            cache = NULL);
 
 
     static NPT_String GetParentFolder(NPT_String file_path) {       
@@ -226,6 +251,14 @@ private:
     }
 
     static NPT_String GetProtocolInfo(const CFileItem* item, const NPT_String& protocol);
+
+    static const unsigned int         BROWSE_CACHE_SIZE = 4;
+    static const unsigned int         DIDL_CACHE_MAX_ITEMS = 5000; // didl is around 1k an item
+    static const DWORD                BROWSE_CACHE_LIFETIME = 30000;
+    static const DWORD                LIBRARY_CACHE_LIFETIME = 300000;
+    std::list<CBrowseCacheEntryPtr>   m_BrowseCache;   // most recently used first
+    CCriticalSection                  m_BrowseCacheLock;
+    DWORD                             m_PublishedUpdateID;
 };
 
 /*----------------------------------------------------------------------
@@ -894,9 +927,8 @@ CUPnPServer::OnBrowseMetadata(PLT_ActionReference&          action,
     NPT_CHECK(action->SetArgumentValue("NumberReturned", "1"));
     NPT_CHECK(action->SetArgumentValue("TotalMatches", "1"));
 
-    // update ID may be wrong here, it should be the one of the container?
-    NPT_CHECK(action->SetArgumentValue("UpdateId", "1"));
-    // TODO: We need to keep track of the overall updateID of the CDS
+    // we don't track changes per container, so report the system update id
+    NPT_CHECK(action->SetArgumentValue("UpdateId", NPT_String::FromInteger(CUtil::GetLibraryUpdateID())));
 
     return NPT_SUCCESS;
 }
@@ -925,23 +957,90 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
         // Xbox 360 asking for photos
     }
 
-    items.m_strPath = id;
-    if (!items.Load()) {
-        // cache anything that takes more than a second to retrieve
-        DWORD time = GetTickCount() + 1000;
+    DWORD update_id = CUtil::GetLibraryUpdateID();
+    PublishUpdateID(update_id);
 
-        if (id.StartsWith("virtualpath://")) {
-            CUPnPVirtualPathDirectory dir;
-            dir.GetDirectory((const char*)id, items);
-        } else {
-            CDirectory::GetDirectory((const char*)id, items);
+    CBrowseCacheEntryPtr entry = GetCacheEntry(id, update_id);
+    if (!entry) {
+        entry.reset(new CBrowseCacheEntry);
+        entry->id = id;
+        entry->update_id = update_id;
+
+        CFileItemList& items = entry->items;
+        items.m_strPath = id;
+        if (!items.Load()) {
+            // cache anything that takes more than a second to retrieve
+            DWORD time = GetTickCount() + 1000;
+
+            if (id.StartsWith("virtualpath://")) {
+                CUPnPVirtualPathDirectory dir;
+                dir.GetDirectory((const char*)id, items);
+            } else {
+                CDirectory::GetDirectory((const char*)id, items);
+            }
+            if(items.CacheToDiscAlways() || (items.CacheToDiscIfSlow() && time < GetTickCount()))
+              items.Save();
         }
-        if(items.CacheToDiscAlways() || (items.CacheToDiscIfSlow() && time < GetTickCount()))
-          items.Save();
+        AddCacheEntry(entry);
     }
 
+    return BuildResponse(action, entry->items, context, id, entry.get());
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetCacheEntry
++---------------------------------------------------------------------*/
+CUPnPServer::CBrowseCacheEntryPtr
+CUPnPServer::GetCacheEntry(const NPT_String& id, DWORD update_id)
+{
+    CSingleLock lock(m_BrowseCacheLock);
+    DWORD now = timeGetTime();
+    for (std::list<CBrowseCacheEntryPtr>::iterator it = m_BrowseCache.begin(); it != m_BrowseCache.end(); ++it) {
+        CBrowseCacheEntryPtr entry = *it;
+        if (entry->id != id) continue;
+
+        m_BrowseCache.erase(it);
+        bool library = id.StartsWith("musicdb://") || id.StartsWith("videodb://");
+        DWORD lifetime = library ? LIBRARY_CACHE_LIFETIME : BROWSE_CACHE_LIFETIME;
+        if (entry->update_id != update_id || now - entry->created > lifetime)
+            return CBrowseCacheEntryPtr();
+
+        entry->last_used = now;
+        m_BrowseCache.push_front(entry);
+        return entry;
+    }
+    return CBrowseCacheEntryPtr();
+}
 
-    return BuildResponse(action, items, context, id);
+/*----------------------------------------------------------------------
+|   CUPnPServer::AddCacheEntry
++---------------------------------------------------------------------*/
+void
+CUPnPServer::AddCacheEntry(CBrowseCacheEntryPtr entry)
+{
+    CSingleLock lock(m_BrowseCacheLock);
+    entry->created = entry->last_used = timeGetTime();
+    if (entry->items.Size() <= (int)DIDL_CACHE_MAX_ITEMS)
+        entry->didl.resize(entry->items.Size());
+    m_BrowseCache.push_front(entry);
+    while (m_BrowseCache.size() > BROWSE_CACHE_SIZE)
+        m_BrowseCache.pop_back();
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::PublishUpdateID
++---------------------------------------------------------------------*/
+void
+CUPnPServer::PublishUpdateID(DWORD update_id)
+{
+    CSingleLock lock(m_BrowseCacheLock);
+    if (update_id == m_PublishedUpdateID) return;
+    m_PublishedUpdateID = update_id;
+
+    // evented, so control points know to throw away what they have browsed
+    PLT_Service* service = NULL;
+    if (NPT_SUCCEEDED(FindServiceByType("urn:schemas-upnp-org:service:ContentDirectory:1", service)))
+        service->SetStateVariable("SystemUpdateID", NPT_String::FromInteger(update_id));
 }
 
 /*----------------------------------------------------------------------
@@ -951,7 +1050,8 @@ NPT_Result
 CUPnPServer::BuildResponse(PLT_ActionReference&          action, 
                            CFileItemList&                items, 
                            const NPT_HttpRequestContext& context, 
-                           const char*                   parent_id)
+                           const char*                   parent_id,
+                           CBrowseCacheEntry*            cache)
 {
     NPT_String filter;
     NPT_String startingInd;
@@ -965,20 +1065,40 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
     NPT_CHECK_SEVERE(startingInd.ToInteger(start_index));
     NPT_CHECK_SEVERE(reqCount.ToInteger(req_count));
         
+    // a RequestedCount of 0 means everything
+    if (req_count == 0) req_count = items.Size();
+    start_index = min(start_index, (unsigned long)items.Size());
     stop_index = min(start_index + req_count, (unsigned long)items.Size());
 
+    // the didl depends on the filter, and the host is part of the resource urls
+    CCriticalSection no_cache;
+    CSingleLock lock(cache ? cache->lock : no_cache);
+    std::vector<NPT_String>* cached_didl = (cache && cache->didl.size()) ? &cache->didl : NULL;
+    if (cached_didl) {
+        NPT_String didl_key = filter + "|" + context.GetLocalAddress().GetIpAddress().ToString();
+        if (cache->didl_key != didl_key) {
+            cache->didl_key = didl_key;
+            cached_didl->assign(cached_didl->size(), NPT_String());
+        }
+    }
+
     NPT_String didl = didl_header;
     PLT_MediaObjectReference item;
     for (unsigned long i=start_index; i < stop_index; ++i) {
-        item = Build(items[i], true, context, parent_id);
-        if (item.IsNull()) {
-            /* create a dummy object */
-            item = new PLT_MediaObject();
-            item->m_Title = items[i]->GetLabel();
-        }
-
         NPT_String tmp;
-        NPT_CHECK(PLT_Didl::ToDidl(*item.AsPointer(), filter, tmp));
+        if (cached_didl && !(*cached_didl)[i].IsEmpty()) {
+            tmp = (*cached_didl)[i];
+        } else {
+            item = Build(items[i], true, context, parent_id);
+            if (item.IsNull()) {
+                /* create a dummy object */
+                item = new PLT_MediaObject();
+                item->m_Title = items[i]->GetLabel();
+            }
+
+            NPT_CHECK(PLT_Didl::ToDidl(*item.AsPointer(), filter, tmp));
+            if (cached_didl) (*cached_didl)[i] = tmp;
+        }
 
         // Neptunes string growing is dead slow for small additions
         if(didl.GetCapacity() < tmp.GetLength() + didl.GetLength()) {
@@ -992,7 +1112,7 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
     NPT_CHECK(action->SetArgumentValue("Result", didl));
     NPT_CHECK(action->SetArgumentValue("NumberReturned", NPT_String::FromInteger(stop_index - start_index)));
     NPT_CHECK(action->SetArgumentValue("TotalMatches", NPT_String::FromInteger(items.Size())));
-    NPT_CHECK(action->SetArgumentValue("UpdateId", "1"));
+    NPT_CHECK(action->SetArgumentValue("UpdateId", NPT_String::FromInteger(CUtil::GetLibraryUpdateID())));
     return NPT_SUCCESS;
 }
 
@@ -1584,6 +1704,12 @@ void CUPnP::StopRenderer()
 /*----------------------------------------------------------------------
 |   CUPnP::UpdateState
 +---------------------------------------------------------------------*/
+void CUPnP::UpdateServerState()
+{
+  if (!m_ServerHolder->m_Device.IsNull())
+      ((CUPnPServer*)m_ServerHolder->m_Device.AsPointer())->PublishUpdateID(CUtil::GetLibraryUpdateID());
+}
+
 void CUPnP::UpdateState()
 {
   if (!m_RendererHolder->m_Device.IsNull())
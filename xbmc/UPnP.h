@@ -39,6 +39,7 @@ public:
     // server
     void StartServer();
     void StopServer();
+    void UpdateServerState(); // events library changes to control points
 
     // client
     void StartClient();
@@ -48,6 +48,7 @@
 #include "FileSystem/VirtualPathDirectory.h"
 #include "FileSystem/MultiPathDirectory.h"
 #include "FileSystem/DirectoryCache.h"
+#include "FileSystem/FileStats.h"
 #include "ThumbnailCache.h"
 #include "FileSystem/ZipManager.h"
 #include "FileSystem/RarManager.h"
@@ -75,6 +76,7 @@
 #include "GUIDialogMusicScan.h"
 #include "GUIDialogFileBrowser.h"
 #include "GUIDialogVideoScan.h"
+#include "DirtyRegionTracker.h"
 #include "utils/fstrcmp.h"
 #include "utils/Trainer.h"
 #ifdef HAS_XBOX_HARDWARE
@@ -116,6 +118,10 @@
 #include "GUIDialogKeyboard.h"
 #include "FileSystem/File.h"
 #include "PlayList.h"
+#include "GUIProfiler.h"
+#include "utils/LibraryViewCache.h"
+#include "GUILargeTextureManager.h"
+#include "MusicInfoTagCache.h"
 
 using namespace std;
 
@@ -135,6 +141,7 @@ static const __int64 SECS_BETWEEN_EPOCHS = 11644473600LL;
 static const __int64 SECS_TO_100NS = 10000000;
 
 HANDLE CUtil::m_hCurrentCpuUsage = NULL;
+static LONG libraryUpdateID = 1;
 
 using namespace AUTOPTR;
 using namespace MEDIA_DETECT;
@@ -3217,6 +3224,7 @@ void CUtil::TakeScreenshot(const char* fn, bool flashScreen)
 #ifdef HAS_XBOX_D3D
     if (SUCCEEDED(g_graphicsContext.Get3DDevice()->GetBackBuffer( -1, D3DBACKBUFFER_TYPE_MONO, &lpSurface)))
 #else
+    g_dirtyRegionTracker.MarkDirty(); // the whole frame has to be in the back buffer
     g_application.RenderNoPresent();
     if (SUCCEEDED(g_graphicsContext.Get3DDevice()->GetBackBuffer( 0, D3DBACKBUFFER_TYPE_MONO, &lpSurface)))
 #endif
@@ -3257,6 +3265,7 @@ void CUtil::TakeScreenshot(const char* fn, bool flashScreen)
       g_renderManager.SetupScreenshot();
 #endif
     }
+    g_dirtyRegionTracker.MarkDirty(); // the whole frame has to be in the back buffer
     g_application.RenderNoPresent();
 
     GLint viewport[4];
@@ -3626,6 +3635,13 @@ const BUILT_IN commands[] = {
   { "Container.SortDirection",    false,  "Toggle the sort direction" },
   { "Control.Move",               true,   "Tells the specified control to 'move' to another entry specified by offset" },
   { "SendClick",                  true,   "Send a click message from the given control to the given window" },
+#ifdef HAS_GUI_PROFILER
+  { "GUIProfiler.Toggle",         false,  "Toggle the GUI render profiler overlay" },
+  { "GUIProfiler.Dump",           false,  "Write the GUI render profile as a Chrome trace, optionally to the given file" },
+#endif
+  { "TextureManager.Dump",        false,  "Log the texture memory usage and decode times" },
+  { "FileStats.Dump",             false,  "Write the filesystem I/O statistics, optionally to the given file" },
+  { "FileStats.Reset",            false,  "Clear the filesystem I/O statistics" },
 };
 
 bool CUtil::IsBuiltIn(const CStdString& execString)
@@ -4267,6 +4283,35 @@ int CUtil::ExecBuiltIn(const CStdString& execString)
     }
   }
 #endif
+#ifdef HAS_GUI_PROFILER
+  else if (execute.Equals("guiprofiler.toggle"))
+  {
+    g_guiProfiler.ToggleOverlay();
+  }
+  else if (execute.Equals("guiprofiler.dump"))
+  {
+    CStdString file = strParameterCaseIntact;
+    if (file.IsEmpty())
+      AddFileToFolder(g_stSettings.m_logFolder, "guiprofile.json", file);
+    g_guiProfiler.DumpTrace(file);
+  }
+#endif
+  else if (execute.Equals("texturemanager.dump"))
+  {
+    g_TextureManager.Dump();
+    g_largeTextureManager.Dump();
+  }
+  else if (execute.Equals("filestats.dump"))
+  {
+    CStdString file = strParameterCaseIntact;
+    if (file.IsEmpty())
+      AddFileToFolder(g_stSettings.m_logFolder, "filestats.txt", file);
+    g_fileStats.Dump(file);
+  }
+  else if (execute.Equals("filestats.reset"))
+  {
+    g_fileStats.Reset();
+  }
   else if (execute.Equals("playdvd"))
   {
     CAutorun::PlayDisc();
@@ -4829,15 +4874,25 @@ CStdString CUtil::VideoPlaylistsLocation()
 void CUtil::DeleteMusicDatabaseDirectoryCache()
 {
   CUtil::DeleteDirectoryCache("mdb");
+  g_libraryViewCache.Invalidate("mdb");
+  g_musicInfoTagCache.Clear();
 }
 
 void CUtil::DeleteVideoDatabaseDirectoryCache()
 {
   CUtil::DeleteDirectoryCache("vdb");
+  g_libraryViewCache.Invalidate("vdb");
+}
+
+DWORD CUtil::GetLibraryUpdateID()
+{
+  return (DWORD)libraryUpdateID;
 }
 
 void CUtil::DeleteDirectoryCache(const CStdString strType /* = ""*/)
 {
+  InterlockedIncrement(&libraryUpdateID);
+
   WIN32_FIND_DATA wfd;
   memset(&wfd, 0, sizeof(wfd));
 
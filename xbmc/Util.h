@@ -295,6 +295,8 @@ public:
   static void DeleteDirectoryCache(const CStdString strType = "");
   static void DeleteMusicDatabaseDirectoryCache();
   static void DeleteVideoDatabaseDirectoryCache();
+  // changes whenever the database directory caches are cleared, ie when the library changes
+  static DWORD GetLibraryUpdateID();
   static CStdString MusicPlaylistsLocation();
   static CStdString VideoPlaylistsLocation();
   static CStdString SubstitutePath(const CStdString& strFileName);
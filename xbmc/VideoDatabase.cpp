@@ -36,6 +36,7 @@
 #include "FileSystem/File.h"
 #include "GUIDialogProgress.h"
 #include "FileItem.h"
+#include "utils/RandomSampler.h"
 
 using namespace std;
 using namespace dbiplus;
@@ -43,7 +44,7 @@ using namespace XFILE;
 using namespace DIRECTORY;
 using namespace VIDEO;
 
-#define VIDEO_DATABASE_VERSION 22
+#define VIDEO_DATABASE_VERSION 24
 #define VIDEO_DATABASE_OLD_VERSION 3.f
 #define VIDEO_DATABASE_NAME "MyVideos34.db"
 #define RECENTLY_ADDED_LIMIT  g_guiSettings.GetInt("videolibrary.recentcount")
@@ -140,8 +141,9 @@ bool CVideoDatabase::CreateTables()
     m_pDS->exec("CREATE TABLE actors ( idActor integer primary key, strActor text, strThumb text )\n");
 
     CLog::Log(LOGINFO, "create path table");
-    m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text)\n");
+    m_pDS->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, iPathHash integer)\n");
     m_pDS->exec("CREATE UNIQUE INDEX ix_path ON path ( strPath )\n");
+    m_pDS->exec("CREATE UNIQUE INDEX idxPathHash ON path ( iPathHash )\n");
 
     CLog::Log(LOGINFO, "create files table");
     m_pDS->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text)\n");
@@ -293,6 +295,10 @@ bool CVideoDatabase::CreateTables()
     CLog::Log(LOGINFO, "create movieview");
     m_pDS->exec("create view movieview as select movie.*,files.strFileName as strFileName,path.strPath as strPath "
                 "from movie join files on files.idFile=movie.idFile join path on path.idPath=files.idPath");
+
+    // search index
+    CreateSearchIndex();
+    CreateSearchTriggers();
   }
   catch (...)
   {
@@ -319,7 +325,7 @@ long CVideoDatabase::GetPathId(const CStdString& strPath)
 
     CUtil::AddSlashAtEnd(strPath1);
 
-    strSQL=FormatSQL("select idPath from path where strPath like '%s'",strPath1.c_str());
+    strSQL=FormatSQL("select idPath from path where iPathHash=%I64d",HashPath(strPath1));
     m_pDS->query(strSQL.c_str());
     if (!m_pDS->eof())
       lPathId = m_pDS->fv("path.idPath").get_asLong();
@@ -445,7 +451,7 @@ long CVideoDatabase::AddPath(const CStdString& strPath)
 
     CUtil::AddSlashAtEnd(strPath1);
 
-    strSQL=FormatSQL("insert into path (idPath, strPath, strContent, strScraper) values (NULL,'%s','','')", strPath1.c_str());
+    strSQL=FormatSQL("insert into path (idPath, strPath, strContent, strScraper, iPathHash) values (NULL,'%s','','',%I64d)", strPath1.c_str(), HashPath(strPath1));
     m_pDS->exec(strSQL.c_str());
     lPathId = (long)sqlite3_last_insert_rowid( m_pDB->getHandle() );
     return lPathId;
@@ -465,7 +471,7 @@ bool CVideoDatabase::GetPathHash(const CStdString &path, CStdString &hash)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL=FormatSQL("select strHash from path where strPath like '%s'", path.c_str());
+    CStdString strSQL=FormatSQL("select strHash from path where iPathHash=%I64d", HashPath(path));
     m_pDS->query(strSQL.c_str());
     if (m_pDS->num_rows() == 0)
       return false;
@@ -736,7 +742,7 @@ long CVideoDatabase::GetTvShowId(const CStdString& strPath)
 
     while (iFound == 0 && CUtil::GetParentPath(strPath1, strParent))
     {
-      strSQL=FormatSQL("select idShow from path,tvshowlinkpath where tvshowlinkpath.idpath = path.idpath and strPath like '%s'",strParent.c_str());
+      strSQL=FormatSQL("select idShow from path,tvshowlinkpath where tvshowlinkpath.idpath = path.idpath and iPathHash=%I64d",HashPath(strParent));
       m_pDS->query(strSQL.c_str());
       if (!m_pDS->eof())
       {
@@ -883,7 +889,7 @@ long CVideoDatabase::AddTvShow(const CStdString& strPath)
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
     
-    CStdString strSQL=FormatSQL("select tvshowlinkpath.idShow from path,tvshowlinkpath where path.strPath like '%s' and path.idPath = tvshowlinkpath.idPath",strPath.c_str());
+    CStdString strSQL=FormatSQL("select tvshowlinkpath.idShow from path,tvshowlinkpath where path.iPathHash=%I64d and path.idPath = tvshowlinkpath.idPath",HashPath(strPath));
     m_pDS->query(strSQL.c_str());
     if (m_pDS->num_rows() != 0)
       return m_pDS->fv("tvshowlinkpath.idShow").get_asLong();
@@ -1019,6 +1025,7 @@ long CVideoDatabase::AddActor(const CStdString& strActor, const CStdString& strT
       strSQL=FormatSQL("insert into Actors (idActor, strActor, strThumb) values( NULL, '%s','%s')", strActor.c_str(),strThumb.c_str());
       m_pDS->exec(strSQL.c_str());
       long lActorId = (long)sqlite3_last_insert_rowid(m_pDB->getHandle());
+      AddToSearchIndex(search_actor, lActorId, strActor);
       return lActorId;
     }
     else
@@ -1640,6 +1647,9 @@ void CVideoDatabase::SetDetailsForMovie(const CStdString& strFilenameAndPath, co
     CStdString sql = "update movie set " + GetValueString(details, VIDEODB_ID_MIN, VIDEODB_ID_MAX, DbMovieOffsets);
     sql += FormatSQL(" where idMovie=%u", lMovieId);
     m_pDS->exec(sql.c_str());
+
+    RemoveFromSearchIndex(search_movie, lMovieId);
+    AddToSearchIndex(search_movie, lMovieId, details.m_strTitle);
   }
   catch (...)
   {
@@ -1685,6 +1695,9 @@ long CVideoDatabase::SetDetailsForTvShow(const CStdString& strPath, const CVideo
     CStdString sql = "update tvshow set " + GetValueString(details, VIDEODB_ID_TV_MIN, VIDEODB_ID_TV_MAX, DbTvShowOffsets);
     sql += FormatSQL("where idShow=%u", lTvShowId);
     m_pDS->exec(sql.c_str());
+
+    RemoveFromSearchIndex(search_tvshow, lTvShowId);
+    AddToSearchIndex(search_tvshow, lTvShowId, details.m_strTitle);
     return lTvShowId;
   }
   catch (...)
@@ -1745,6 +1758,11 @@ long CVideoDatabase::SetDetailsForEpisode(const CStdString& strFilenameAndPath,
     CStdString sql = "update episode set " + GetValueString(details, VIDEODB_ID_EPISODE_MIN, VIDEODB_ID_EPISODE_MAX, DbEpisodeOffsets);
     sql += FormatSQL("where idEpisode=%u", lEpisodeId);
     m_pDS->exec(sql.c_str());
+
+    RemoveFromSearchIndex(search_episode, lEpisodeId);
+    RemoveFromSearchIndex(search_episode_plot, lEpisodeId);
+    AddToSearchIndex(search_episode, lEpisodeId, details.m_strTitle);
+    AddToSearchIndex(search_episode_plot, lEpisodeId, details.m_strPlot);
     return lEpisodeId;
   }
   catch (...)
@@ -1812,6 +1830,10 @@ void CVideoDatabase::SetDetailsForMusicVideo(const CStdString& strFilenameAndPat
     CStdString sql = "update musicvideo set " + GetValueString(details, VIDEODB_ID_MUSICVIDEO_MIN, VIDEODB_ID_MUSICVIDEO_MAX, DbMusicVideoOffsets);
     sql += FormatSQL(" where idMVideo=%u", lMVideoId);
     m_pDS->exec(sql.c_str());
+    g_randomSampler.Invalidate("musicvideos:");
+
+    RemoveFromSearchIndex(search_musicvideo, lMVideoId);
+    AddToSearchIndex(search_musicvideo, lMVideoId, details.m_strTitle);
   }
   catch (...)
   {
@@ -2305,6 +2327,7 @@ void CVideoDatabase::DeleteMusicVideo(const CStdString& strFilenameAndPath)
 
     strSQL=FormatSQL("delete from musicvideo where idmvideo=%i", lMVideoId);
     m_pDS->exec(strSQL.c_str());
+    g_randomSampler.Invalidate("musicvideos:");
 
     CStdString strPath, strFileName;
     SplitPath(strFilenameAndPath,strPath,strFileName);
@@ -2489,7 +2512,7 @@ bool CVideoDatabase::GetVideoSettings(const CStdString &strFilenameAndPath, CVid
     if (NULL == m_pDS.get()) return false;
     CStdString strPath, strFileName;
     CUtil::Split(strFilenameAndPath, strPath, strFileName);
-    CStdString strSQL=FormatSQL("select * from settings, files, path where settings.idfile=files.idfile and path.idpath=files.idpath and path.strPath like '%s' and files.strFileName like '%s'", strPath.c_str() , strFileName.c_str());
+    CStdString strSQL=FormatSQL("select * from settings, files, path where settings.idfile=files.idfile and path.idpath=files.idpath and path.iPathHash=%I64d and files.strFileName like '%s'", HashPath(strPath), strFileName.c_str());
 #else
     long lFileId = GetFileId(strFilenameAndPath);
     if (lFileId < 0) return false;
@@ -3088,6 +3111,17 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
     }
     if (iVersion < 22) // reverse audio/subtitle offsets
       m_pDS->exec("update settings set SubtitleDelay=-SubtitleDelay and AudioDelay=-AudioDelay");
+    if (iVersion < 23)
+    { // word index for searching
+      CreateSearchIndex();
+      CreateSearchTriggers();
+      RebuildSearchIndex();
+    }
+    if (iVersion < 24)
+    { // hashed path lookups
+      m_pDS->exec("alter table path add iPathHash integer");
+      UpdatePathHashes();
+    }
   }
   catch (...)
   {
@@ -3099,6 +3133,44 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
   return true;
 }
 
+void CVideoDatabase::CreateSearchTriggers()
+{
+  // keep the search index in step with deletions, wherever they come from
+  CLog::Log(LOGINFO, "create search index triggers");
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrMovieSearch AFTER delete ON movie FOR EACH ROW BEGIN delete from searchindex where iType=%i and idItem=old.idMovie; END", search_movie).c_str());
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrTvShowSearch AFTER delete ON tvshow FOR EACH ROW BEGIN delete from searchindex where iType=%i and idItem=old.idShow; END", search_tvshow).c_str());
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrEpisodeSearch AFTER delete ON episode FOR EACH ROW BEGIN delete from searchindex where (iType=%i or iType=%i) and idItem=old.idEpisode; END", search_episode, search_episode_plot).c_str());
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrMusicVideoSearch AFTER delete ON musicvideo FOR EACH ROW BEGIN delete from searchindex where iType=%i and idItem=old.idMVideo; END", search_musicvideo).c_str());
+  m_pDS->exec(FormatSQL("CREATE TRIGGER tgrActorSearch AFTER delete ON actors FOR EACH ROW BEGIN delete from searchindex where iType=%i and idItem=old.idActor; END", search_actor).c_str());
+}
+
+void CVideoDatabase::RebuildSearchIndex()
+{
+  CStdString tables[] = { FormatSQL("select idMovie, c%02d from movie", VIDEODB_ID_TITLE),
+                          FormatSQL("select idShow, c%02d from tvshow", VIDEODB_ID_TV_TITLE),
+                          FormatSQL("select idEpisode, c%02d from episode", VIDEODB_ID_EPISODE_TITLE),
+                          FormatSQL("select idEpisode, c%02d from episode", VIDEODB_ID_EPISODE_PLOT),
+                          FormatSQL("select idMVideo, c%02d from musicvideo", VIDEODB_ID_MUSICVIDEO_TITLE),
+                          "select idActor, strActor from actors" };
+  const int types[] = { search_movie, search_tvshow, search_episode, search_episode_plot, search_musicvideo, search_actor };
+
+  CLog::Log(LOGINFO, "building search index");
+  m_pDS->exec("delete from searchindex");
+  for (unsigned int i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+  {
+    vector< pair<long, CStdString> > items;
+    m_pDS->query(tables[i].c_str());
+    while (!m_pDS->eof())
+    {
+      items.push_back(make_pair(m_pDS->fv(0).get_asLong(), CStdString(m_pDS->fv(1).get_asString())));
+      m_pDS->next();
+    }
+    m_pDS->close();
+    for (unsigned int j = 0; j < items.size(); j++)
+      AddToSearchIndex(types[i], items[j].first, items[j].second);
+  }
+}
+
 void CVideoDatabase::UpdateFanart(const CFileItem &item, VIDEODB_CONTENT_TYPE type)
 {
   if (NULL == m_pDB.get()) return;
@@ -3165,6 +3237,8 @@ void CVideoDatabase::MarkAsWatched(const CFileItem &item)
       strSQL.Format("UPDATE musicvideo set c%02d=1 WHERE idMVideo=%u", VIDEODB_ID_MUSICVIDEO_PLAYCOUNT, id);
 
     m_pDS->exec(strSQL.c_str());
+    if (type == VIDEODB_CONTENT_MUSICVIDEOS)
+      g_randomSampler.Invalidate("musicvideos:");
   }
   catch (...)
   {
@@ -3183,14 +3257,20 @@ void CVideoDatabase::MarkAsUnWatched(const CFileItem &item)
     if (!item.HasVideoInfoTag() || item.GetVideoInfoTag()->m_iDbId < 0) return; // not in the db, or at least we don't have the info for it
 
     CStdString strSQL;
+    bool musicVideo = false;
     if (item.GetVideoInfoTag()->m_iSeason > -1 && !item.m_bIsFolder) // episode
       strSQL = FormatSQL("UPDATE episode set c%02d=NULL WHERE idEpisode=%u", VIDEODB_ID_EPISODE_PLAYCOUNT, item.GetVideoInfoTag()->m_iDbId);
     else if (!item.GetVideoInfoTag()->m_strArtist.IsEmpty())
+    {
       strSQL = FormatSQL("UPDATE musicvideo set c%02d=NULL WHERE idMVideo=%u", VIDEODB_ID_MUSICVIDEO_PLAYCOUNT, item.GetVideoInfoTag()->m_iDbId);
+      musicVideo = true;
+    }
     else
       strSQL = FormatSQL("UPDATE movie set c%02d=NULL WHERE idMovie=%u", VIDEODB_ID_PLAYCOUNT, item.GetVideoInfoTag()->m_iDbId);
 
     m_pDS->exec(strSQL.c_str());
+    if (musicVideo)
+      g_randomSampler.Invalidate("musicvideos:");
   }
   catch (...)
   {
@@ -3205,27 +3285,38 @@ void CVideoDatabase::UpdateMovieTitle(long lMovieId, const CStdString& strNewMov
     if (NULL == m_pDB.get()) return ;
     if (NULL == m_pDS.get()) return ;
     CStdString strSQL;
+    int searchType = 0;
     if (iType == VIDEODB_CONTENT_MOVIES)    
     {
       CLog::Log(LOGINFO, "Changing Movie:id:%ld New Title:%s", lMovieId, strNewMovieTitle.c_str());
       strSQL = FormatSQL("UPDATE movie SET c%02d='%s' WHERE idMovie=%i", VIDEODB_ID_TITLE, strNewMovieTitle.c_str(), lMovieId );
+      searchType = search_movie;
     }
     else if (iType == VIDEODB_CONTENT_EPISODES)
     {
       CLog::Log(LOGINFO, "Changing Episode:id:%ld New Title:%s", lMovieId, strNewMovieTitle.c_str());
       strSQL = FormatSQL("UPDATE episode SET c%02d='%s' WHERE idEpisode=%i", VIDEODB_ID_EPISODE_TITLE, strNewMovieTitle.c_str(), lMovieId );
+      searchType = search_episode;
     }
     else if (iType == VIDEODB_CONTENT_TVSHOWS)
     {
       CLog::Log(LOGINFO, "Changing TvShow:id:%ld New Title:%s", lMovieId, strNewMovieTitle.c_str());
       strSQL = FormatSQL("UPDATE tvshow SET c%02d='%s' WHERE idShow=%i", VIDEODB_ID_TV_TITLE, strNewMovieTitle.c_str(), lMovieId );
+      searchType = search_tvshow;
     }
     else if (iType == VIDEODB_CONTENT_MUSICVIDEOS)
     {
       CLog::Log(LOGINFO, "Changing MusicVideo:id:%ld New Title:%s", lMovieId, strNewMovieTitle.c_str());
       strSQL = FormatSQL("UPDATE musicvideo SET c%02d='%s' WHERE idMVideo=%i", VIDEODB_ID_MUSICVIDEO_TITLE, strNewMovieTitle.c_str(), lMovieId );
+      searchType = search_musicvideo;
     }
     m_pDS->exec(strSQL.c_str());
+
+    if (searchType)
+    { // keep the title search index in step with the new title
+      RemoveFromSearchIndex(searchType, lMovieId);
+      AddToSearchIndex(searchType, lMovieId, strNewMovieTitle);
+    }
   }
   catch (...)
   {
@@ -4452,7 +4543,7 @@ bool CVideoDatabase::GetScraperForPath(const CStdString& strPath, SScraperInfo&
       {
         iFound++;
 
-        CStdString strSQL=FormatSQL("select path.strContent,path.strScraper,path.scanRecursive,path.useFolderNames,path.strSettings from path where strPath like '%s'",strParent.c_str());
+        CStdString strSQL=FormatSQL("select path.strContent,path.strScraper,path.scanRecursive,path.useFolderNames,path.strSettings from path where iPathHash=%I64d",HashPath(strParent));
         m_pDS->query(strSQL.c_str());
         if (!m_pDS->eof())
         {
@@ -4605,10 +4696,14 @@ void CVideoDatabase::GetMovieActorsByName(const CStdString& strSearch, CFileItem
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    vector<long> ids;
+    if (!SearchIndex(search_actor, strSearch, ids) || ids.empty())
+      return;
+
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL=FormatSQL("select actors.idactor,actors.strActor,path.strPath from actorlinkmovie,actors,movie,files,path where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idmovie=movie.idmovie and files.idFile = movie.idFile and files.idPath = path.idPath and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=FormatSQL("select actors.idactor,actors.strActor,path.strPath from actorlinkmovie,actors,movie,files,path where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idmovie=movie.idmovie and files.idFile = movie.idFile and files.idPath = path.idPath and actors.idActor in %s",FormatIdList(ids).c_str());
     else
-      strSQL=FormatSQL("select actors.idactor,actors.strActor from actorlinkmovie,actors,movie where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idmovie=movie.idmovie and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=FormatSQL("select actors.idactor,actors.strActor from actorlinkmovie,actors,movie where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idmovie=movie.idmovie and actors.idActor in %s",FormatIdList(ids).c_str());
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -4645,10 +4740,14 @@ void CVideoDatabase::GetTvShowsActorsByName(const CStdString& strSearch, CFileIt
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    vector<long> ids;
+    if (!SearchIndex(search_actor, strSearch, ids) || ids.empty())
+      return;
+
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL=FormatSQL("select actors.idactor,actors.strActor,path.strPath from actorlinktvshow,actors,tvshow,path,tvshowlinkpath where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idshow=tvshow.idshow and tvshowlinkpath.idpath=tvshow.idshow and tvshowlinkpath.idpath=path.idpath and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=FormatSQL("select actors.idactor,actors.strActor,path.strPath from actorlinktvshow,actors,tvshow,path,tvshowlinkpath where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idshow=tvshow.idshow and tvshowlinkpath.idpath=tvshow.idshow and tvshowlinkpath.idpath=path.idpath and actors.idActor in %s",FormatIdList(ids).c_str());
     else
-      strSQL=FormatSQL("select actors.idactor,actors.strActor from actorlinktvshow,actors,tvshow where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idshow=tvshow.idshow and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=FormatSQL("select actors.idactor,actors.strActor from actorlinktvshow,actors,tvshow where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idshow=tvshow.idshow and actors.idActor in %s",FormatIdList(ids).c_str());
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -4687,11 +4786,16 @@ void CVideoDatabase::GetMusicVideoArtistsByName(const CStdString& strSearch, CFi
 
     CStdString strLike; 
     if (!strSearch.IsEmpty())
-      strLike = "and actors.strActor like '%%%s%%'";
+    {
+      vector<long> ids;
+      if (!SearchIndex(search_actor, strSearch, ids) || ids.empty())
+        return;
+      strLike = "and actors.idActor in " + FormatIdList(ids);
+    }
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL=FormatSQL("select actors.idactor,actors.strActor,path.strPath from artistlinkmusicvideo,actors,musicvideo,files,path where actors.idActor=artistlinkmusicvideo.idartist and artistlinkmusicvideo.idmvideo=musicvideo.idmvideo and files.idFile = musicvideo.idFile and files.idPath = path.idPath "+strLike,strSearch.c_str());
+      strSQL=FormatSQL("select actors.idactor,actors.strActor,path.strPath from artistlinkmusicvideo,actors,musicvideo,files,path where actors.idActor=artistlinkmusicvideo.idartist and artistlinkmusicvideo.idmvideo=musicvideo.idmvideo and files.idFile = musicvideo.idFile and files.idPath = path.idPath "+strLike);
     else
-      strSQL=FormatSQL("select distinct actors.idactor,actors.strActor from artistlinkmusicvideo,actors where actors.idActor=artistlinkmusicvideo.idartist "+strLike,strSearch.c_str());
+      strSQL=FormatSQL("select distinct actors.idactor,actors.strActor from artistlinkmusicvideo,actors where actors.idActor=artistlinkmusicvideo.idartist "+strLike);
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -4945,41 +5049,45 @@ unsigned int CVideoDatabase::GetMusicVideoIDs(const CStdString& strWhere, vector
   return 0;
 }
 
-bool CVideoDatabase::GetRandomMusicVideo(CFileItem* item, long& lSongId, const CStdString& strWhere)
+bool CVideoDatabase::GetRandomMusicVideos(const CStdString& strWhere, unsigned int count, const set<long> &exclude, CFileItemList &items)
 {
   try
   {
-    lSongId = -1;
-
-    // seed random function
-    srand(timeGetTime());
-
-    int iCount = GetMusicVideoCount(strWhere);
-    if (iCount <= 0)
-      return false;
-    int iRandom = rand() % iCount;
-
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    // We don't use FormatSQL here, as the WHERE clause is already formatted.
-    CStdString strSQL;
-    strSQL.Format("select * from musicvideoview %s order by idMVideo limit 1 offset %i",strWhere.c_str(),iRandom);
-    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound != 1)
+    if (!count && exclude.empty())
+    { // everything matching, just shuffled
+      CFileItemList mvideos;
+      if (!GetMusicVideosByWhere("videodb://3/2/", strWhere, mvideos))
+        return false;
+      mvideos.Randomize();
+      items.Append(mvideos);
+      return true;
+    }
+
+    // draw from the cached ids matching this where clause, fetching them if we don't have them yet
+    CStdString key = "musicvideos:" + strWhere;
+    vector<long> ids;
+    if (!g_randomSampler.Sample(key, count, exclude, ids))
     {
-      m_pDS->close();
-      return false;
+      vector<pair<int,long> > mvideoIDs;
+      GetMusicVideoIDs(strWhere, mvideoIDs);
+      vector<long> pool;
+      pool.reserve(mvideoIDs.size());
+      for (unsigned int i = 0; i < mvideoIDs.size(); i++)
+        pool.push_back(mvideoIDs[i].second);
+      g_randomSampler.SetPool(key, pool);
+      g_randomSampler.Sample(key, count, exclude, ids);
     }
-    *item->GetVideoInfoTag() = GetDetailsForMusicVideo(m_pDS);
-    item->m_strPath.Format("videodb://3/2/%ld",item->GetVideoInfoTag()->m_iDbId);
-    lSongId = m_pDS->fv("idmvideo").get_asLong();
-    item->SetLabel(item->GetVideoInfoTag()->m_strTitle);
-    m_pDS->close();
+    if (ids.empty())
+      return false;
+
+    CFileItemList mvideos;
+    if (!GetMusicVideosByWhere("videodb://3/2/", "where idmvideo in " + FormatIdList(ids), mvideos))
+      return false;
+    mvideos.Randomize(); // they come back in database order
+    items.Append(mvideos);
     return true;
   }
   catch(...)
@@ -5043,10 +5151,14 @@ void CVideoDatabase::GetMoviesByName(const CStdString& strSearch, CFileItemList&
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    vector<long> ids;
+    if (!SearchIndex(search_movie, strSearch, ids) || ids.empty())
+      return;
+
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = FormatSQL("select movie.idmovie,movie.c%02d,path.strPath from movie,file,path where file.idfile=movie.idfile and file.idPath=path.idPath and movie.c%02d like '%%%s%%'",VIDEODB_ID_TITLE,VIDEODB_ID_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select movie.idmovie,movie.c%02d,path.strPath from movie,file,path where file.idfile=movie.idfile and file.idPath=path.idPath and movie.idMovie in %s",VIDEODB_ID_TITLE,FormatIdList(ids).c_str());
     else
-      strSQL = FormatSQL("select movie.idmovie,movie.c%02d from movie where movie.c%02d like '%%%s%%'",VIDEODB_ID_TITLE,VIDEODB_ID_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select movie.idmovie,movie.c%02d from movie where movie.idMovie in %s",VIDEODB_ID_TITLE,FormatIdList(ids).c_str());
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -5084,10 +5196,14 @@ void CVideoDatabase::GetTvShowsByName(const CStdString& strSearch, CFileItemList
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    vector<long> ids;
+    if (!SearchIndex(search_tvshow, strSearch, ids) || ids.empty())
+      return;
+
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = FormatSQL("select tvshow.idshow,tvshow.c%02d,path.strPath from tvshow,path,tvshowlinkpath where tvshowlinkpath.idpath=path.idpath and tvshow.c%02d like '%%%s%%'",VIDEODB_ID_TV_TITLE,VIDEODB_ID_TV_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select tvshow.idshow,tvshow.c%02d,path.strPath from tvshow,path,tvshowlinkpath where tvshowlinkpath.idpath=path.idpath and tvshow.idShow in %s",VIDEODB_ID_TV_TITLE,FormatIdList(ids).c_str());
     else
-      strSQL = FormatSQL("select tvshow.idshow,tvshow.c%02d from tvshow where tvshow.c%02d like '%%%s%%'",VIDEODB_ID_TV_TITLE,VIDEODB_ID_TV_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select tvshow.idshow,tvshow.c%02d from tvshow where tvshow.idShow in %s",VIDEODB_ID_TV_TITLE,FormatIdList(ids).c_str());
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -5125,10 +5241,14 @@ void CVideoDatabase::GetEpisodesByName(const CStdString& strSearch, CFileItemLis
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    vector<long> ids;
+    if (!SearchIndex(search_episode, strSearch, ids) || ids.empty())
+      return;
+
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode.c%02d,tvshowlinkepisode.idshow,tvshow.c%02d,path.strPath from episode,file,path,tvshowlinkepisode,tvshow where file.idfile=episode.idfile and tvshowlinkepisode.idepisode=episode.idepisode and tvshowlinkepisode.idshow=tvshow.idshow and file.idPath=path.idPath and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode.c%02d,tvshowlinkepisode.idshow,tvshow.c%02d,path.strPath from episode,file,path,tvshowlinkepisode,tvshow where file.idfile=episode.idfile and tvshowlinkepisode.idepisode=episode.idepisode and tvshowlinkepisode.idshow=tvshow.idshow and file.idPath=path.idPath and episode.idEpisode in %s",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,FormatIdList(ids).c_str());
     else
-      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode.c%02d,tvshowlinkepisode.idshow,tvshow.c%02d from episode,tvshowlinkepisode,tvshow where tvshowlinkepisode.idepisode=episode.idepisode and tvshow.idshow=tvshowlinkepisode.idshow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode.c%02d,tvshowlinkepisode.idshow,tvshow.c%02d from episode,tvshowlinkepisode,tvshow where tvshowlinkepisode.idepisode=episode.idepisode and tvshow.idshow=tvshowlinkepisode.idshow and episode.idEpisode in %s",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,FormatIdList(ids).c_str());
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -5167,10 +5287,14 @@ void CVideoDatabase::GetMusicVideosByName(const CStdString& strSearch, CFileItem
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    vector<long> ids;
+    if (!SearchIndex(search_musicvideo, strSearch, ids) || ids.empty())
+      return;
+
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = FormatSQL("select musicvideo.idmvideo,musicvideo.c%02d,path.strPath from musicvideo,file,path where file.idfile=musicvideo.idfile and file.idPath=path.idPath and musicvideo.%c02d like '%%%s%%'",VIDEODB_ID_MUSICVIDEO_TITLE,VIDEODB_ID_MUSICVIDEO_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select musicvideo.idmvideo,musicvideo.c%02d,path.strPath from musicvideo,file,path where file.idfile=musicvideo.idfile and file.idPath=path.idPath and musicvideo.idMVideo in %s",VIDEODB_ID_MUSICVIDEO_TITLE,FormatIdList(ids).c_str());
     else
-      strSQL = FormatSQL("select musicvideo.idmvideo,musicvideo.c%02d from musicvideo where musicvideo.c%02d like '%%%s%%'",VIDEODB_ID_MUSICVIDEO_TITLE,VIDEODB_ID_MUSICVIDEO_TITLE,strSearch.c_str());
+      strSQL = FormatSQL("select musicvideo.idmvideo,musicvideo.c%02d from musicvideo where musicvideo.idMVideo in %s",VIDEODB_ID_MUSICVIDEO_TITLE,FormatIdList(ids).c_str());
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -5214,10 +5338,14 @@ void CVideoDatabase::GetEpisodesByPlot(const CStdString& strSearch, CFileItemLis
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    vector<long> ids;
+    if (!SearchIndex(search_episode_plot, strSearch, ids) || ids.empty())
+      return;
+
     if (g_settings.m_vecProfiles[0].getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode,c%02d,tvshowlinkepisode.idshow,tvshow.c%02d,path.strPath from episode,file,path,tvshowlinkepisode,tvshow where file.idepisode=episode.idepisode and tvshowlinkepisode.idepisode=episode.idepisode and file.idPath=path.idPath and tvshow.idshow=tvshowlinkepisode.idshow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_PLOT,strSearch.c_str());
+      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode,c%02d,tvshowlinkepisode.idshow,tvshow.c%02d,path.strPath from episode,file,path,tvshowlinkepisode,tvshow where file.idepisode=episode.idepisode and tvshowlinkepisode.idepisode=episode.idepisode and file.idPath=path.idPath and tvshow.idshow=tvshowlinkepisode.idshow and episode.idEpisode in %s",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,FormatIdList(ids).c_str());
     else
-      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode.c%02d,tvshowlinkepisode.idshow,tvshow.c%02d from episode,tvshowlinkepisode,tvshow where tvshowlinkepisode.idepisode=episode.idepisode and tvshow.idshow=tvshowlinkepisode.idshow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_PLOT,strSearch.c_str());
+      strSQL = FormatSQL("select episode.idepisode,episode.c%02d,episode.c%02d,tvshowlinkepisode.idshow,tvshow.c%02d from episode,tvshowlinkepisode,tvshow where tvshowlinkepisode.idepisode=episode.idepisode and tvshow.idshow=tvshowlinkepisode.idshow and episode.idEpisode in %s",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,FormatIdList(ids).c_str());
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -5608,6 +5736,7 @@ void CVideoDatabase::CleanDatabase(IVideoInfoScannerObserver* pObserver, const s
     CLog::Log(LOGDEBUG, "%s Cleaning musicvideo table", __FUNCTION__);
     sql = "delete from musicvideo where idmvideo in " + musicVideosToDelete;
     m_pDS->exec(sql.c_str());
+    g_randomSampler.Invalidate("musicvideos:");
 
     CLog::Log(LOGDEBUG, "%s Cleaning artistlinkmusicvideo table", __FUNCTION__);
     sql = "delete from artistlinkmusicvideo where idMVideo in " + musicVideosToDelete;
@@ -6039,52 +6168,6 @@ void CVideoDatabase::ImportFromXML(const CStdString &xmlFile)
     progress->Close();
 }
 
-bool CVideoDatabase::GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet,
-                                       const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField, const CStdString& strCloseField, CStdString& strResult)
-{
-  try
-  {
-    strResult = "";
-    if (NULL == m_pDB.get()) return false;
-    if (NULL == m_pDS.get()) return false;
-    CStdString strSQL=FormatSQL(strQuery);
-    if (!m_pDS->query(strSQL.c_str()))
-    {
-      strResult = m_pDB->getErrorMsg();
-      return false;
-    }
-    strResult=strOpenRecordSet;
-    while (!m_pDS->eof())
-    {
-      strResult += strOpenRecord;
-      for (int i=0; i<m_pDS->fieldCount(); i++)
-      {
-        strResult += strOpenField + CStdString(m_pDS->fv(i).get_asString()) + strCloseField;
-      }
-      strResult += strCloseRecord;
-      m_pDS->next();
-    }
-    strResult += strCloseRecordSet;
-    m_pDS->close();
-    return true;
-  }
-  catch (...)
-  {
-    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
-  }
-  try
-  {
-    if (NULL == m_pDB.get()) return false;
-    strResult = m_pDB->getErrorMsg();
-  }
-  catch (...)
-  {
-
-  }
-
-  return false;
-}
-
 void CVideoDatabase::ConstructPath(CStdString& strDest, const CStdString& strPath, const CStdString& strFileName)
 {
   if (CUtil::IsStack(strFileName) || strFileName.Mid(0,6).Equals("rar://") || strFileName.Mid(0,6).Equals("zip://"))
@@ -400,8 +400,6 @@ public:
   bool IsLinkedToTvshow(long idMovie);
   bool GetLinksToTvShow(long idMovie, std::vector<long>& ids);
 
-  bool GetArbitraryQuery(const CStdString& strQuery, const CStdString& strOpenRecordSet, const CStdString& strCloseRecordSet, 
-                         const CStdString& strOpenRecord, const CStdString& strCloseRecord, const CStdString& strOpenField, const CStdString& strCloseField, CStdString& strResult);
 
   // general browsing
   bool GetGenresNav(const CStdString& strBaseDir, CFileItemList& items, long idContent=-1);
@@ -440,7 +438,7 @@ public:
   // partymode
   int GetMusicVideoCount(const CStdString& strWhere);
   unsigned int GetMusicVideoIDs(const CStdString& strWhere, std::vector<std::pair<int,long> > &songIDs);
-  bool GetRandomMusicVideo(CFileItem* item, long& lSongId, const CStdString& strWhere);
+  bool GetRandomMusicVideos(const CStdString& strWhere, unsigned int count, const std::set<long> &exclude, CFileItemList &items);
 
 protected:
   long GetFileId(const CStdString& strFilenameAndPath);
@@ -499,4 +497,9 @@ private:
 
   bool GetStackedTvShowList(long idShow, CStdString& strIn);
   void Stack(CFileItemList& items, VIDEODB_CONTENT_TYPE cType = VIDEODB_CONTENT_TVSHOWS);
+
+  void CreateSearchTriggers();
+  void RebuildSearchIndex();
+
+  enum _SearchTypes { search_movie=1, search_tvshow, search_episode, search_episode_plot, search_musicvideo, search_actor };
 };
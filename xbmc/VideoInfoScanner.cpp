@@ -35,6 +35,7 @@
 #include "GUIDialogProgress.h"
 #include "Settings.h"
 #include "FileItem.h"
+#include "VideoThumbExtractor.h"
 
 #define REGEXSAMPLEFILE "[-\\._ ](sample|trailer)[-\\._ ]"
 
@@ -78,11 +79,15 @@ namespace VIDEO
       m_currentItem=0;
       m_itemCount=-1;
 
-      // Create the thread to count all files to be scanned
+      if (g_advancedSettings.m_bVideoLibraryIncrementalUpdate)
+        m_journal.Open(CUtil::AddFileToFolder(g_settings.GetDatabaseFolder(), "MyVideosJournal.dat"));
+
+      // list everything to be scanned in the background, which gives us the count of files
       SetPriority(THREAD_PRIORITY_IDLE);
-      CThread fileCountReader(this);    
-      if (m_pObserver)
-        fileCountReader.Create();
+      vector<CStdString> roots;
+      for (map<CStdString,SScanSettings>::iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); it++)
+        roots.push_back(it->first);
+      m_walker.Start(roots, g_stSettings.m_videoExtensions, this);
 
       // Database operations should not be canceled
       // using Interupt() while scanning as it could
@@ -111,7 +116,8 @@ namespace VIDEO
         }
       }
 
-      fileCountReader.StopThread();
+      m_walker.Stop();
+      m_journal.Close();
 
       m_database.Close();
       CLog::Log(LOGDEBUG, "%s - Finished scan", __FUNCTION__);
@@ -170,6 +176,7 @@ namespace VIDEO
     if (m_bCanInterrupt)
       m_database.Interupt();
 
+    m_walker.Stop();
     StopThread();
   }
 
@@ -203,15 +210,28 @@ namespace VIDEO
       bSkip = true;
 
     CStdString hash, dbHash;
-    if (m_info.strContent.Equals("movies"))
+    vector<CStdString> folders;
+    int numFilesInFolder = 0;
+    bool bUnchanged = false;
+    if ((m_info.strContent.Equals("movies") || m_info.strContent.Equals("musicvideos")) &&
+        m_journal.IsUnchanged(strDirectory, folders, numFilesInFolder) &&
+        !m_bUpdateAll && m_database.GetPathHash(strDirectory, dbHash))
+    { // nothing in it has been added, removed or renamed since it was scanned, so don't even list it
+      CLog::Log(LOGDEBUG, "%s Skipping dir '%s' as it hasn't changed", __FUNCTION__, strDirectory.c_str());
+      m_currentItem += numFilesInFolder;
+      if (m_pObserver && m_itemCount>0)
+        m_pObserver->OnSetProgress(m_currentItem, m_itemCount);
+      bSkip = bUnchanged = true;
+    }
+    else if (m_info.strContent.Equals("movies"))
     {
       if (m_pObserver)
         m_pObserver->OnStateChanged(FETCHING_MOVIE_INFO);
 
-      CDirectory::GetDirectory(strDirectory,items,g_stSettings.m_videoExtensions);
+      GetDirectory(strDirectory, items);
       items.m_strPath = strDirectory;
       items.Stack();
-      int numFilesInFolder = GetPathHash(items, hash);
+      numFilesInFolder = GetPathHash(items, hash);
 
       if (!m_database.GetPathHash(strDirectory, dbHash) || dbHash != hash)
       { // path has changed - rescan
@@ -242,7 +262,7 @@ namespace VIDEO
 
       if (iFound == 1 && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory,items,g_stSettings.m_videoExtensions);
+        GetDirectory(strDirectory, items);
         items.m_strPath = strDirectory;
         GetPathHash(items, hash);
         bSkip = true;
@@ -268,10 +288,10 @@ namespace VIDEO
       if (m_pObserver)
         m_pObserver->OnStateChanged(FETCHING_MUSICVIDEO_INFO);
 
-      CDirectory::GetDirectory(strDirectory,items,g_stSettings.m_videoExtensions);
+      GetDirectory(strDirectory, items);
       items.m_strPath = strDirectory;
 
-      int numFilesInFolder = GetPathHash(items, hash);
+      numFilesInFolder = GetPathHash(items, hash);
       if (!m_database.GetPathHash(strDirectory, dbHash) || dbHash != hash)
       { // path has changed - rescan
         if (dbHash.IsEmpty())
@@ -325,17 +345,27 @@ namespace VIDEO
       m_pObserver->OnDirectoryScanned(strDirectory);
     CLog::Log(LOGDEBUG, "%s - Finished dir: %s", __FUNCTION__, strDirectory.c_str());
 
-    for (int i = 0; i < items.Size(); ++i)
+    if (!bUnchanged)
     {
-      CFileItemPtr pItem = items[i];
+      // if we have a directory item (non-playlist) we then recurse into that folder
+      folders.clear();
+      for (int i = 0; i < items.Size(); ++i)
+      {
+        if (items[i]->m_bIsFolder && WalkInto(*items[i]))
+          folders.push_back(items[i]->m_strPath);
+      }
+      if (!m_bStop && (m_info.strContent.Equals("movies") || m_info.strContent.Equals("musicvideos")))
+        m_journal.Update(strDirectory, folders, numFilesInFolder);
+    }
 
+    for (unsigned int i = 0; i < folders.size(); ++i)
+    {
       if (m_bStop)
         break;
 
-      // if we have a directory item (non-playlist) we then recurse into that folder
-      if (pItem->m_bIsFolder && !pItem->GetLabel().Equals("sample") && !pItem->GetLabel().Equals("subs") && !pItem->IsParentFolder() && !pItem->IsPlayList() && settings.recurse > 0 && !m_info.strContent.Equals("tvshows")) // do not recurse for tv shows - we have already looked recursively for episodes
+      if (settings.recurse > 0 && !m_info.strContent.Equals("tvshows")) // do not recurse for tv shows - we have already looked recursively for episodes
       {
-        CStdString strPath=pItem->m_strPath;
+        CStdString strPath=folders[i];
 
         // do not process items which will be scanned by main loop
         std::map<CStdString,VIDEO::SScanSettings>::iterator it = m_pathsToScan.find(strPath);
@@ -652,42 +682,63 @@ namespace VIDEO
     return true;
   }
 
-  // This function is run by another thread
-  void CVideoInfoScanner::Run()
+  // Use the walker's listing if it has it, which it normally will as it walks
+  // the same folders (and more, as it doesn't know the scraper settings)
+  void CVideoInfoScanner::GetDirectory(const CStdString& strDirectory, CFileItemList& items)
   {
-    int count = 0;
-    while (!m_bStop && m_pathsToCount.size())
-      count+=CountFiles(*m_pathsToCount.begin());
-    m_itemCount = count;
+    if (!m_walker.Take(strDirectory, items))
+      CDirectory::GetDirectory(strDirectory, items, g_stSettings.m_videoExtensions);
   }
 
-  // Recurse through all folders we scan and count files
-  int CVideoInfoScanner::CountFiles(const CStdString& strPath)
+  // As CUtil::GetRecursiveListing, but using the walker's listings where it has them
+  void CVideoInfoScanner::GetRecursiveListing(const CStdString& strDirectory, CFileItemList& items)
   {
-    int count=0;
-    // load subfolder
-    CFileItemList items;
-    CLog::Log(LOGDEBUG, "%s - processing dir: %s", __FUNCTION__, strPath.c_str());
-    CDirectory::GetDirectory(strPath, items, g_stSettings.m_videoExtensions, true);
-    if (m_info.strContent.Equals("movies"))
-      items.Stack();
-
-    for (int i=0; i<items.Size(); ++i)
+    CFileItemList myItems;
+    GetDirectory(strDirectory, myItems);
+    for (int i = 0; i < myItems.Size(); ++i)
     {
-      CFileItemPtr pItem=items[i];
+      if (myItems[i]->m_bIsFolder)
+        GetRecursiveListing(myItems[i]->m_strPath, items);
+      else if (!myItems[i]->IsRAR() && !myItems[i]->IsZIP())
+        items.Add(myItems[i]);
+    }
+  }
 
-      if (m_bStop)
-        return 0;
+  // These are called by the directory walker's jobs
+  bool CVideoInfoScanner::WalkInto(const CFileItem &folder)
+  {
+    return !folder.GetLabel().Equals("sample") && !folder.GetLabel().Equals("subs") && !folder.IsParentFolder() && !folder.IsPlayList();
+  }
 
-      if (pItem->m_bIsFolder)
-        count+=CountFiles(pItem->m_strPath);
-      else if (pItem->IsVideo() && !pItem->IsPlayList() && !pItem->IsNFO())
-        count++;
+  bool CVideoInfoScanner::IsUnchanged(const CStdString &strDirectory, vector<CStdString> &folders, int &files)
+  {
+    return !m_bUpdateAll && m_journal.IsUnchanged(strDirectory, folders, files);
+  }
+
+  int CVideoInfoScanner::OnDirectoryListed(const CStdString &strDirectory, const CFileItemList &items)
+  {
+    // parts of a stack count once, as the scan stacks them.  CFileItemList::Stack() changes
+    // the items (and the scan will do that on its own copy), so just look at the names.
+    set<CStdString> stacks;
+    int count = 0;
+    for (int i=0; i<items.Size(); ++i)
+    {
+      const CFileItemPtr pItem=items[i];
+      if (pItem->m_bIsFolder || !pItem->IsVideo() || pItem->IsPlayList() || pItem->IsNFO())
+        continue;
+      CStdString title, volume;
+      if (CUtil::GetVolumeFromFileName(pItem->GetLabel(), title, volume) && !stacks.insert(title).second)
+        continue;
+      count++;
     }
-    CLog::Log(LOGDEBUG, "%s - finished processing dir: %s", __FUNCTION__, strPath.c_str());
     return count;
   }
 
+  void CVideoInfoScanner::OnWalkFinished(int files)
+  {
+    m_itemCount = files;
+  }
+
   void CVideoInfoScanner::EnumerateSeriesFolder(const CFileItem* item, IMDB_EPISODELIST& episodeList)
   {
     CFileItemList items;
@@ -700,7 +751,7 @@ namespace VIDEO
 
     if (item->m_bIsFolder)
     {
-      CUtil::GetRecursiveListing(item->m_strPath,items,g_stSettings.m_videoExtensions,true);
+      GetRecursiveListing(item->m_strPath,items);
       CStdString hash, dbHash;
       int numFilesInFolder = GetPathHash(items, hash);
 
@@ -892,6 +943,11 @@ namespace VIDEO
       }
     }
 
+    // no thumb from the scraper - extract one from the video in the background
+    // rather than when the item is first shown
+    if (!pItem->m_bIsFolder && (strThumb.IsEmpty() || !CFile::Exists(strThumb)))
+      g_videoThumbExtractor.Add(*pItem);
+
     if (bApplyToDir)
     {
       CStdString strCheck=pItem->m_strPath;
@@ -23,6 +23,8 @@
 #include "VideoDatabase.h"
 #include "ScraperSettings.h"
 #include "NfoFile.h"
+#include "FileSystem/DirectoryWalker.h"
+#include "FileSystem/DirectoryJournal.h"
 
 class CIMDB;
 
@@ -50,7 +52,7 @@ namespace VIDEO
     virtual void OnFinished() = 0;
   };
 
-  class CVideoInfoScanner : CThread, public IRunnable
+  class CVideoInfoScanner : CThread, public DIRECTORY::IDirectoryWalkerCallback
   {
   public:
     CVideoInfoScanner();
@@ -77,9 +79,14 @@ namespace VIDEO
   protected:
     virtual void Process();
     bool DoScan(const CStdString& strDirectory, SScanSettings settings);
+    void GetDirectory(const CStdString& strDirectory, CFileItemList& items);
+    void GetRecursiveListing(const CStdString& strDirectory, CFileItemList& items);
 
-    virtual void Run();
-    int CountFiles(const CStdString& strPath);
+    // the walker lists the folders ahead of the scan and counts the files for the progress
+    virtual bool WalkInto(const CFileItem &folder);
+    virtual bool IsUnchanged(const CStdString &strDirectory, std::vector<CStdString> &folders, int &files);
+    virtual int OnDirectoryListed(const CStdString &strDirectory, const CFileItemList &items);
+    virtual void OnWalkFinished(int files);
     void FetchSeasonThumbs(long lTvShowId);
     void FetchActorThumbs(const std::vector<SActorInfo>& actors);
     static int GetPathHash(const CFileItemList &items, CStdString &hash);
@@ -96,8 +103,9 @@ namespace VIDEO
     CVideoDatabase m_database;
     SScraperInfo m_info;
     std::map<CStdString,SScanSettings> m_pathsToScan;
-    std::set<CStdString> m_pathsToCount;
     std::vector<long> m_pathsToClean;
+    DIRECTORY::CDirectoryWalker m_walker;
+    DIRECTORY::CDirectoryJournal m_journal;   // only open for incremental updates
   };
 }
 
@@ -0,0 +1,191 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "VideoThumbExtractor.h"
+#include "ThumbLoader.h"
+#include "FileItem.h"
+#include "Util.h"
+#include "GUISettings.h"
+#include "Application.h"
+#include "FileSystem/File.h"
+#include "utils/SingleLock.h"
+#include "utils/CPUInfo.h"
+
+using namespace std;
+using namespace XFILE;
+
+CVideoThumbExtractor g_videoThumbExtractor;
+
+CVideoThumbExtractor::CVideoThumbExtractor()
+{
+  m_activeJobs = 0;
+  m_remoteJobs = 0;
+  m_stop = false;
+  m_batchStart = 0;
+  m_batchExtracted = 0;
+  m_batchFailed = 0;
+  m_batchDropped = 0;
+}
+
+CVideoThumbExtractor::~CVideoThumbExtractor()
+{
+  Stop();
+}
+
+bool CVideoThumbExtractor::Add(const CFileItem &item)
+{
+  if (!g_guiSettings.GetBool("myvideos.autothumb"))
+    return true;
+  if (item.m_bIsFolder || item.HasThumbnail() || !item.GetUserVideoThumb().IsEmpty())
+    return true;
+
+  CThumbJob job;
+  job.thumb = CVideoThumbLoader::GetAutoThumb(item, job.path);
+  if (job.thumb.IsEmpty() || CFile::Exists(item.GetCachedVideoThumb()) || CFile::Exists(job.thumb))
+    return true;
+  job.remote = CUtil::IsRemote(job.path);
+
+  CSingleLock lock(m_critSection);
+  if (m_stop)
+    return false;
+  if (m_thumbs.find(job.thumb) != m_thumbs.end())
+    return true;
+  if (m_queue.size() >= MAX_QUEUE)
+  {
+    if (!m_batchDropped++)
+      CLog::Log(LOGNOTICE, "%s - queue of %u files is full, skipping %s and any more until it drains", __FUNCTION__, MAX_QUEUE, job.path.c_str());
+    return false;
+  }
+
+  if (m_workers.empty())
+  {
+    unsigned int workers = g_cpuInfo.getCPUCount() > 1 ? g_cpuInfo.getCPUCount() - 1 : 1;
+    for (unsigned int i = 0; i < workers; i++)
+    {
+      CThread *worker = new CThread(this);
+      worker->Create();
+      worker->SetName("VideoThumbExtractor worker");
+      worker->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
+      m_workers.push_back(worker);
+    }
+    CLog::Log(LOGDEBUG, "%s - started %u workers", __FUNCTION__, workers);
+  }
+
+  if (m_queue.empty() && !m_activeJobs)
+  {
+    m_batchStart = timeGetTime();
+    m_batchExtracted = m_batchFailed = m_batchDropped = 0;
+  }
+  m_queue.push_back(job);
+  m_thumbs.insert(job.thumb);
+  m_jobEvent.Set();
+  return true;
+}
+
+void CVideoThumbExtractor::Stop()
+{
+  vector<CThread *> workers;
+  {
+    CSingleLock lock(m_critSection);
+    m_stop = true;
+    m_queue.clear();
+    workers.swap(m_workers);
+  }
+  // waits for any extraction in progress
+  for (unsigned int i = 0; i < workers.size(); i++)
+  {
+    m_jobEvent.Set();
+    workers[i]->StopThread();
+    delete workers[i];
+  }
+}
+
+bool CVideoThumbExtractor::GetJob(CThumbJob &job)
+{
+  CSingleLock lock(m_critSection);
+  for (deque<CThumbJob>::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+  {
+    // leave remote files for later if the network is busy with another one
+    if (it->remote && m_remoteJobs >= MAX_REMOTE_JOBS)
+      continue;
+
+    job = *it;
+    m_queue.erase(it);
+    if (job.remote)
+      m_remoteJobs++;
+    m_activeJobs++;
+
+    // the event only wakes one worker
+    if (!m_queue.empty())
+      m_jobEvent.Set();
+    return true;
+  }
+  return false;
+}
+
+void CVideoThumbExtractor::JobDone(const CThumbJob &job, bool extracted)
+{
+  CSingleLock lock(m_critSection);
+  if (job.remote)
+    m_remoteJobs--;
+  m_activeJobs--;
+  m_thumbs.erase(job.thumb);
+  if (extracted)
+    m_batchExtracted++;
+  else
+    m_batchFailed++;
+
+  if (!m_queue.empty())
+    m_jobEvent.Set();
+  else if (!m_activeJobs)
+  {
+    DWORD elapsed = timeGetTime() - m_batchStart;
+    CLog::Log(LOGNOTICE, "%s - extracted %u thumbs (%u failed, %u skipped as the queue was full) in %lu ms, %.1f thumbs per minute", __FUNCTION__,
+              m_batchExtracted, m_batchFailed, m_batchDropped, elapsed, elapsed ? m_batchExtracted * 60000.0 / elapsed : 0.0);
+  }
+}
+
+void CVideoThumbExtractor::Run()
+{
+  CDVDFileInfo::CThumbScaler scaler;
+  while (!m_stop)
+  {
+    // don't compete with video playback for the disk, network or cpu
+    if (g_application.IsPlayingVideo())
+    {
+      m_jobEvent.WaitMSec(1000);
+      continue;
+    }
+
+    CThumbJob job;
+    if (!GetJob(job))
+    {
+      m_jobEvent.WaitMSec(1000);
+      continue;
+    }
+
+    bool extracted = false;
+    if (!CFile::Exists(job.thumb))
+      extracted = CVideoThumbLoader::ExtractThumb(job.path, job.thumb, &scaler);
+    JobDone(job, extracted);
+  }
+}
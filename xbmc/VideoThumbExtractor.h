@@ -0,0 +1,93 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "utils/CriticalSection.h"
+#include "utils/Thread.h"
+
+#include <deque>
+#include <set>
+#include <vector>
+
+class CFileItem;
+
+/*!
+ \brief Extracts auto thumbs for a batch of videos on a pool of worker threads.
+
+ CVideoThumbLoader only extracts thumbs for the directory on screen, one file
+ at a time.  Anything queued here (eg everything the video scanner just added)
+ is extracted in the background by one worker per core, less one left for the
+ GUI.  A batch can take hours, so the workers are our own below normal priority
+ threads rather than jobs on g_jobManager, where they'd hold up the workers
+ needed for what's on screen.  Each worker keeps its own
+ CDVDFileInfo::CThumbScaler.  To avoid flooding network shares with seeks, at
+ most MAX_REMOTE_JOBS files from remote sources are read at once.  The queue is
+ capped at MAX_QUEUE files, and extraction pauses while a video is playing.
+ When the queue drains, the throughput for the batch is logged.
+ */
+class CVideoThumbExtractor : public IRunnable
+{
+public:
+  CVideoThumbExtractor();
+  virtual ~CVideoThumbExtractor();
+
+  /*! \brief Queue extraction of the auto thumb for item, if it needs one
+   \return false if the queue is full
+   */
+  bool Add(const CFileItem &item);
+  void Stop();
+
+  // IRunnable entry point for the workers
+  virtual void Run();
+
+private:
+  struct CThumbJob
+  {
+    CStdString path;
+    CStdString thumb;
+    bool remote;
+  };
+
+  bool GetJob(CThumbJob &job);
+  void JobDone(const CThumbJob &job, bool extracted);
+
+  static const unsigned int MAX_QUEUE = 2000;
+  static const unsigned int MAX_REMOTE_JOBS = 1;
+
+  CCriticalSection m_critSection;
+  std::deque<CThumbJob> m_queue;
+  CEvent m_jobEvent;
+  std::set<CStdString> m_thumbs;       // thumbs queued or being extracted
+  std::vector<CThread *> m_workers;
+  unsigned int m_activeJobs;
+  unsigned int m_remoteJobs;
+  bool m_stop;
+
+  // current batch
+  DWORD m_batchStart;
+  unsigned int m_batchExtracted;
+  unsigned int m_batchFailed;
+  unsigned int m_batchDropped;         // files not queued as the queue was full
+};
+
+extern CVideoThumbExtractor g_videoThumbExtractor;
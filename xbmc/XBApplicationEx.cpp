@@ -21,6 +21,7 @@
 #define MEASURE_FUNCTION
 #endif
 #include "GUIFontManager.h"
+#include "DirtyRegionTracker.h"
 #ifdef HAS_SDL_JOYSTICK
 #include "common/SDLJoystick.h"
 #endif
@@ -387,6 +388,11 @@ void CXBApplicationEx::ReadInput()
       {
         m_AppActive = event.active.gain != 0;
       }
+      g_dirtyRegionTracker.MarkDirty();
+      break;
+    case SDL_VIDEOEXPOSE:
+      // the window has to be redrawn, even if nothing in it changed
+      g_dirtyRegionTracker.MarkDirty();
       break;
     case SDL_MOUSEBUTTONDOWN:
       // mouse scroll wheel.
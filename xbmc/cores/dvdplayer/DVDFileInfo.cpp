@@ -65,9 +65,75 @@ bool CDVDFileInfo::GetFileDuration(const CStdString &path, int& duration)
     return false;
 }
 
-bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &strTarget)
+// give up on a file if the decoder hasn't produced a picture after this many
+// video packets from the keyframe we seeked to
+#define MAX_THUMB_PACKETS 250
+
+CDVDFileInfo::CThumbScaler::CThumbScaler()
+{
+  m_dllSwScale = NULL;
+  m_context = NULL;
+  m_srcWidth = m_srcHeight = m_dstWidth = m_dstHeight = 0;
+}
+
+CDVDFileInfo::CThumbScaler::~CThumbScaler()
+{
+  if (m_dllSwScale)
+  {
+    if (m_context)
+      m_dllSwScale->sws_freeContext(m_context);
+    m_dllSwScale->Unload();
+    delete m_dllSwScale;
+  }
+}
+
+bool CDVDFileInfo::CThumbScaler::Scale(const DVDVideoPicture &picture, int width, int height, BYTE *pOutBuf)
+{
+  if (!m_dllSwScale)
+  {
+    m_dllSwScale = new DllSwScale;
+    if (!m_dllSwScale->Load())
+    {
+      delete m_dllSwScale;
+      m_dllSwScale = NULL;
+      return false;
+    }
+  }
+
+  if (m_context && (m_srcWidth != picture.iWidth || m_srcHeight != picture.iHeight ||
+                    m_dstWidth != width || m_dstHeight != height))
+  {
+    m_dllSwScale->sws_freeContext(m_context);
+    m_context = NULL;
+  }
+  if (!m_context)
+  {
+    m_context = m_dllSwScale->sws_getContext(picture.iWidth, picture.iHeight,
+          PIX_FMT_YUV420P, width, height, PIX_FMT_RGB32, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+    if (!m_context)
+      return false;
+    m_srcWidth = picture.iWidth;
+    m_srcHeight = picture.iHeight;
+    m_dstWidth = width;
+    m_dstHeight = height;
+  }
+
+  uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2] };
+  int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2] };
+  uint8_t *dst[] = { pOutBuf, 0, 0 };
+  int     dstStride[] = { width*4, 0, 0 };
+
+  m_dllSwScale->sws_scale(m_context, src, srcStride, 0, picture.iHeight, dst, dstStride);
+  return true;
+}
+
+bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &strTarget, CThumbScaler *scaler /* = NULL */)
 {
   int nTime = timeGetTime();
+  CThumbScaler localScaler;
+  if (!scaler)
+    scaler = &localScaler;
+
   CDVDInputStream *pInputStream = CDVDFactoryInputStream::CreateInputStream(NULL, strPath, "");
   if (!pInputStream)
   {
@@ -141,7 +207,8 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
         DemuxPacket* pPacket = NULL;
   
         bool bHasFrame = false;
-        while (!bHasFrame)
+        int nPackets = 0;
+        while (!bHasFrame && nPackets++ < MAX_THUMB_PACKETS)
         {
           bool bFound = false;
           do
@@ -174,28 +241,14 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, const CStdString &str
                 double aspect = (double)picture.iWidth / (double)picture.iHeight;
                 int nHeight = (int)((double)g_advancedSettings.m_thumbSize / aspect);
 
-                DllSwScale dllSwScale;
-                dllSwScale.Load();
-
-                BYTE *pOutBuf = (BYTE*)new int[nWidth * nHeight * 4];
-                struct SwsContext *context = dllSwScale.sws_getContext(picture.iWidth, picture.iHeight, 
-                      PIX_FMT_YUV420P, nWidth, nHeight, PIX_FMT_RGB32, SWS_FAST_BILINEAR, NULL, NULL, NULL);
-                uint8_t *src[] = { picture.data[0], picture.data[1], picture.data[2] };
-                int     srcStride[] = { picture.iLineSize[0], picture.iLineSize[1], picture.iLineSize[2] };
-                uint8_t *dst[] = { pOutBuf, 0, 0 };
-                int     dstStride[] = { nWidth*4, 0, 0 };
-
-                if (context)
+                BYTE *pOutBuf = new BYTE[nWidth * nHeight * 4];
+                if (scaler->Scale(picture, nWidth, nHeight, pOutBuf))
                 {
-                  dllSwScale.sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);  
-                  dllSwScale.sws_freeContext(context);
-
                   CPicture out;
                   out.CreateThumbnailFromSurface(pOutBuf, nWidth, nHeight, nWidth * 4, strTarget);
                   bOk = true; 
                 }
 
-                dllSwScale.Unload();                
                 delete [] pOutBuf;
               }
               else 
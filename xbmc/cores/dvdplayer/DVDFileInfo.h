@@ -23,10 +23,30 @@
 #include "StdString.h"
 
 class CFileItem;
+class DllSwScale;
+struct SwsContext;
+struct stDVDVideoPicture;
+
 class CDVDFileInfo
 {
 public:
-  static bool ExtractThumb(const CStdString &strPath, const CStdString &strTarget);
+  /*! \brief Scales decoded pictures to thumbs.  Keeps the swscale library loaded and
+   the last scaler context around, so that extracting a batch of thumbs on one thread
+   doesn't set them up again for every file.  Not thread safe - use one per thread.
+   */
+  class CThumbScaler
+  {
+  public:
+    CThumbScaler();
+    ~CThumbScaler();
+    bool Scale(const stDVDVideoPicture &picture, int width, int height, BYTE *pOutBuf);
+  private:
+    DllSwScale *m_dllSwScale;
+    struct SwsContext *m_context;
+    int m_srcWidth, m_srcHeight, m_dstWidth, m_dstHeight;
+  };
+
+  static bool ExtractThumb(const CStdString &strPath, const CStdString &strTarget, CThumbScaler *scaler = NULL);
   
   // GetFileMetaData will fill pItem's properties according to what can be extracted from the file.
   static void GetFileMetaData(const CStdString &strPath, CFileItem *pItem); 
@@ -0,0 +1,806 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "HttpServer.h"
+#include "XBMChttp.h"
+#include "includes.h"
+#include "Util.h"
+#include "Settings.h"
+#include "URL.h"
+#include "SingleLock.h"
+#include "FileSystem/File.h"
+
+#include <algorithm>
+
+#ifdef _LINUX
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(__APPLE__)
+#include <sys/sendfile.h>
+#define HAS_SENDFILE
+#endif
+#endif
+
+#ifndef PRId64
+#ifdef _MSC_VER
+#define PRId64 "I64d"
+#else
+#define PRId64 "lld"
+#endif
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define NO_EID -1
+
+// On Linux an fd_set is a bitmap indexed by descriptor, so a descriptor of FD_SETSIZE or
+// more can't go in one.  Winsock's is a list of up to FD_SETSIZE sockets, which Process()
+// limits instead.
+static inline bool CanSelect(SOCKET socket)
+{
+#ifdef _LINUX
+  return socket < FD_SETSIZE;
+#else
+  return true;
+#endif
+}
+
+// a path with forward slashes, no user details and a trailing slash, for prefix matching
+static CStdString ComparablePath(const CStdString &path)
+{
+  CURL url(_P(path));
+  CStdString result;
+  url.GetURLWithoutUserDetails(result);
+  CUtil::ForceForwardSlashes(result);
+  if (!CUtil::HasSlashAtEnd(result))
+    result += "/";
+  return result;
+}
+
+using namespace std;
+using namespace XFILE;
+
+// Buffers up to SEND_CHUNK_SIZE of output before sending it on as a chunk.  If the
+// output all fits in the buffer it goes out as a plain response instead.
+class CHttpServer::CChunkedWriter : public IHttpResponseWriter
+{
+public:
+  CChunkedWriter(SOCKET socket, bool chunked, bool keepAlive)
+  {
+    m_socket = socket;
+    m_chunked = chunked;
+    m_keepAlive = keepAlive;
+    m_headerSent = false;
+    m_failed = false;
+  }
+
+  virtual bool Write(const CStdString &data)
+  {
+    m_buffer += data;
+    if (m_buffer.size() >= SEND_CHUNK_SIZE)
+      return Flush();
+    return !m_failed;
+  }
+
+  bool Finish()
+  {
+    if (!m_headerSent)
+    { // it all fits, no need for chunks
+      CStdString header;
+      header.Format("HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: %u\r\nCache-Control: no-cache\r\nConnection: %s\r\n\r\n",
+                    (unsigned int)m_buffer.size(), m_keepAlive ? "keep-alive" : "close");
+      return Send(m_socket, (header + m_buffer).c_str(), header.size() + m_buffer.size());
+    }
+    if (!Flush())
+      return false;
+    return !m_chunked || Send(m_socket, "0\r\n\r\n", 5);
+  }
+
+private:
+  bool Flush()
+  {
+    if (m_failed)
+      return false;
+    if (!m_headerSent)
+    {
+      CStdString header;
+      header.Format("HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nCache-Control: no-cache\r\n%sConnection: %s\r\n\r\n",
+                    m_chunked ? "Transfer-Encoding: chunked\r\n" : "", m_keepAlive ? "keep-alive" : "close");
+      m_failed = !Send(m_socket, header.c_str(), header.size());
+      m_headerSent = true;
+    }
+    if (!m_failed && m_buffer.size())
+    {
+      if (m_chunked)
+      {
+        CStdString size;
+        size.Format("%x\r\n", (unsigned int)m_buffer.size());
+        m_buffer = size + m_buffer + "\r\n";
+      }
+      m_failed = !Send(m_socket, m_buffer.c_str(), m_buffer.size());
+    }
+    m_buffer.clear();
+    return !m_failed;
+  }
+
+  SOCKET m_socket;
+  bool m_chunked;
+  bool m_keepAlive;
+  bool m_headerSent;
+  bool m_failed;
+  CStdString m_buffer;
+};
+
+CHttpServer::CHttpServer()
+{
+  m_listenSocket = INVALID_SOCKET;
+  m_port = 0;
+}
+
+CHttpServer::~CHttpServer()
+{
+  Stop();
+}
+
+bool CHttpServer::Start(int port, unsigned int threads)
+{
+  if (m_listenSocket != INVALID_SOCKET)
+    return true;
+
+  m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (m_listenSocket == INVALID_SOCKET)
+  {
+    CLog::Log(LOGERROR, "%s - unable to create socket", __FUNCTION__);
+    return false;
+  }
+
+  int reuse = 1;
+  setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(m_listenSocket, (sockaddr *)&addr, sizeof(addr)) == SOCKET_ERROR ||
+      listen(m_listenSocket, SOMAXCONN) == SOCKET_ERROR)
+  {
+    CLog::Log(LOGERROR, "%s - unable to listen on port %i", __FUNCTION__, port);
+    closesocket(m_listenSocket);
+    m_listenSocket = INVALID_SOCKET;
+    return false;
+  }
+  m_port = port;
+
+  m_bStop = false;
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    CThread *worker = new CThread(this);
+    worker->Create();
+    worker->SetName("HttpServer worker");
+    m_workers.push_back(worker);
+  }
+  Create();
+  SetName("HttpServer");
+
+  CLog::Log(LOGNOTICE, "HttpServer: listening on port %i with %u workers", port, threads);
+  return true;
+}
+
+void CHttpServer::Stop()
+{
+  if (m_listenSocket == INVALID_SOCKET)
+    return;
+
+  StopThread();
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    m_queueEvent.Set();
+    m_workers[i]->StopThread();
+    delete m_workers[i];
+  }
+  m_workers.clear();
+
+  CSingleLock lock(m_queueSection);
+  for (unsigned int i = 0; i < m_idle.size(); i++)
+    CloseConnection(m_idle[i]);
+  m_idle.clear();
+  for (unsigned int i = 0; i < m_queue.size(); i++)
+    CloseConnection(m_queue[i]);
+  m_queue.clear();
+
+  closesocket(m_listenSocket);
+  m_listenSocket = INVALID_SOCKET;
+  CLog::Log(LOGNOTICE, "HttpServer: stopped");
+}
+
+void CHttpServer::SetPassword(const CStdString &password)
+{
+  CSingleLock lock(m_authSection);
+  if (password.IsEmpty())
+    m_authorization.clear();
+  else
+    m_authorization = "Basic " + Base64("plex:" + password);
+}
+
+void CHttpServer::Process()
+{
+  while (!m_bStop)
+  {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(m_listenSocket, &readSet);
+    SOCKET maxSocket = m_listenSocket;
+
+    // only the listener removes idle connections, so the copy stays valid after unlocking
+    vector<CConnection *> idle;
+    {
+      CSingleLock lock(m_queueSection);
+      DWORD now = timeGetTime();
+      vector<CConnection *>::iterator it = m_idle.begin();
+      while (it != m_idle.end())
+      { // a client gets REQUEST_TIMEOUT to finish sending a request it has started
+        if ((*it)->requestStart ? now - (*it)->requestStart > REQUEST_TIMEOUT : now - (*it)->lastActive > KEEPALIVE_TIMEOUT)
+        {
+          CloseConnection(*it);
+          it = m_idle.erase(it);
+        }
+        else
+          ++it;
+      }
+      for (unsigned int i = 0; i < m_idle.size() && idle.size() < FD_SETSIZE - 1; i++)
+      {
+        FD_SET(m_idle[i]->socket, &readSet);
+        if (m_idle[i]->socket > maxSocket)
+          maxSocket = m_idle[i]->socket;
+        idle.push_back(m_idle[i]);
+      }
+    }
+
+    timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = 20000;
+    if (select((int)maxSocket + 1, &readSet, NULL, NULL, &tv) <= 0)
+      continue;
+
+    vector<CConnection *> ready;
+    if (FD_ISSET(m_listenSocket, &readSet))
+    {
+      SOCKET socket = accept(m_listenSocket, NULL, NULL);
+      if (socket != INVALID_SOCKET && !CanSelect(socket))
+      {
+        CLog::Log(LOGWARNING, "%s - too many connections, refusing one", __FUNCTION__);
+        closesocket(socket);
+      }
+      else if (socket != INVALID_SOCKET)
+      {
+        int noDelay = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+        // a client that stops reading can only hold up a worker for so long
+#ifdef _LINUX
+        timeval sendTimeout;
+        sendTimeout.tv_sec = SEND_TIMEOUT / 1000;
+        sendTimeout.tv_usec = (SEND_TIMEOUT % 1000) * 1000;
+#else
+        DWORD sendTimeout = SEND_TIMEOUT;
+#endif
+        setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, (const char *)&sendTimeout, sizeof(sendTimeout));
+        CConnection *connection = new CConnection;
+        connection->socket = socket;
+        connection->requests = 0;
+        connection->lastActive = timeGetTime();
+        connection->requestStart = 0;
+        ready.push_back(connection);
+      }
+    }
+    for (unsigned int i = 0; i < idle.size(); i++)
+    {
+      if (FD_ISSET(idle[i]->socket, &readSet))
+        ready.push_back(idle[i]);
+    }
+
+    if (ready.size())
+    {
+      CSingleLock lock(m_queueSection);
+      for (unsigned int i = 0; i < ready.size(); i++)
+      {
+        vector<CConnection *>::iterator it = find(m_idle.begin(), m_idle.end(), ready[i]);
+        if (it != m_idle.end())
+          m_idle.erase(it);
+        m_queue.push_back(ready[i]);
+      }
+      m_queueEvent.Set();
+    }
+  }
+}
+
+void CHttpServer::Run()
+{
+  while (!m_bStop)
+  {
+    CConnection *connection = NULL;
+    {
+      CSingleLock lock(m_queueSection);
+      if (m_queue.size())
+      {
+        connection = m_queue.front();
+        m_queue.pop_front();
+        if (m_queue.size())
+          m_queueEvent.Set(); // auto reset, so pass it on to the next worker
+      }
+    }
+    if (!connection)
+    {
+      m_queueEvent.WaitMSec(500);
+      continue;
+    }
+
+    // answer every request the client has sent, pipelined or not.  Workers never wait
+    // on the client: a request that isn't all here yet goes back to the listener, which
+    // hands the connection out again when there is more.
+    bool keepAlive = true;
+    while (keepAlive && !m_bStop)
+    {
+      CRequest request;
+      RequestState state = ReadRequest(connection, request);
+      if (state == REQUEST_INCOMPLETE)
+        break;
+      connection->requestStart = 0;
+      keepAlive = state == REQUEST_READY && HandleRequest(connection, request);
+    }
+
+    if (keepAlive && !m_bStop)
+    {
+      connection->lastActive = timeGetTime();
+      if (connection->buffer.size() && !connection->requestStart)
+        connection->requestStart = connection->lastActive;
+      CSingleLock lock(m_queueSection);
+      m_idle.push_back(connection);
+    }
+    else
+      CloseConnection(connection);
+  }
+}
+
+void CHttpServer::CloseConnection(CConnection *connection)
+{
+  closesocket(connection->socket);
+  delete connection;
+}
+
+int CHttpServer::ReadData(CConnection *connection)
+{
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  FD_SET(connection->socket, &readSet);
+  timeval tv;
+  tv.tv_sec = 0;
+  tv.tv_usec = 0;
+  int ready = select((int)connection->socket + 1, &readSet, NULL, NULL, &tv);
+  if (ready <= 0)
+    return ready < 0 ? -1 : 0;
+
+  char buffer[4096];
+  int size = recv(connection->socket, buffer, sizeof(buffer), 0);
+  if (size <= 0)
+    return -1;
+  connection->buffer.append(buffer, size);
+  return 1;
+}
+
+CHttpServer::RequestState CHttpServer::ReadRequest(CConnection *connection, CRequest &request)
+{
+  // nothing is taken off the buffer until the whole request is here, so an incomplete
+  // one is just parsed again once the rest arrives
+  int end;
+  while ((end = connection->buffer.Find("\r\n\r\n")) < 0)
+  {
+    if (connection->buffer.size() > MAX_HEADER_SIZE)
+      return REQUEST_FAILED;
+    int read = ReadData(connection);
+    if (read <= 0)
+      return read < 0 ? REQUEST_FAILED : REQUEST_INCOMPLETE;
+  }
+
+  CStdStringArray lines;
+  StringUtils::SplitString(connection->buffer.Left(end), "\r\n", lines);
+  if (lines.size() == 0)
+    return REQUEST_FAILED;
+
+  CStdStringArray requestLine;
+  if (StringUtils::SplitString(lines[0], " ", requestLine) != 3)
+    return REQUEST_FAILED;
+  request.method = requestLine[0];
+  request.version = requestLine[2];
+  int query = requestLine[1].Find('?');
+  if (query >= 0)
+  {
+    request.path = requestLine[1].Left(query);
+    request.query = requestLine[1].Mid(query + 1);
+  }
+  else
+    request.path = requestLine[1];
+
+  for (unsigned int i = 1; i < lines.size(); i++)
+  {
+    int colon = lines[i].Find(':');
+    if (colon <= 0)
+      continue;
+    CStdString name = lines[i].Left(colon);
+    CStdString value = lines[i].Mid(colon + 1);
+    name.ToLower();
+    value.Trim();
+    request.headers[name] = value;
+  }
+
+  int length = atoi(request.GetHeader("content-length").c_str());
+  if (length < 0 || length > (int)MAX_BODY_SIZE)
+    return REQUEST_FAILED;
+  while ((int)connection->buffer.size() < end + 4 + length)
+  {
+    int read = ReadData(connection);
+    if (read <= 0)
+      return read < 0 ? REQUEST_FAILED : REQUEST_INCOMPLETE;
+  }
+  request.body = connection->buffer.Mid(end + 4, length);
+  connection->buffer.erase(0, end + 4 + length);
+  return REQUEST_READY;
+}
+
+bool CHttpServer::HandleRequest(CConnection *connection, const CRequest &request)
+{
+  connection->requests++;
+
+  CStdString connectionHeader = request.GetHeader("connection");
+  bool keepAlive;
+  if (request.version.Equals("HTTP/1.1"))
+    keepAlive = !connectionHeader.Equals("close");
+  else
+    keepAlive = connectionHeader.Equals("keep-alive");
+  if (connection->requests >= MAX_KEEPALIVE_REQUESTS)
+    keepAlive = false;
+
+  {
+    CSingleLock lock(m_authSection);
+    if (!m_authorization.IsEmpty() && request.GetHeader("authorization") != m_authorization)
+    {
+      lock.Leave();
+      CStdString header;
+      header.Format("HTTP/1.1 401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"XBMC\"\r\n"
+                    "Content-Length: 0\r\nConnection: %s\r\n\r\n", keepAlive ? "keep-alive" : "close");
+      return Send(connection->socket, header.c_str(), header.size()) && keepAlive;
+    }
+  }
+
+  if (!request.method.Equals("GET") && !request.method.Equals("HEAD") && !request.method.Equals("POST"))
+    return SendError(connection, 501, false);
+
+  if (request.path.Equals("/xbmcCmds/xbmcHttp"))
+    return HandleApi(connection, request, keepAlive);
+  if (request.path.Left(5).Equals("/vfs/"))
+    return HandleFile(connection, request, keepAlive);
+  return SendError(connection, 404, keepAlive);
+}
+
+bool CHttpServer::HandleApi(CConnection *connection, const CRequest &request, bool keepAlive)
+{
+  if (!pXbmcHttpShim || !m_pXbmcHttp)
+    return SendError(connection, 503, false);
+
+  CStdString command = request.GetVar("command");
+  CStdString parameter = request.GetVar("parameter");
+  pXbmcHttpShim->checkForFunctionTypeParas(command, parameter);
+  if (!request.method.Equals("HEAD") && m_pXbmcHttp->IsStreamable(command))
+  { // HTTP/1.0 has no chunked encoding, so the end of the response is marked by closing
+    bool chunked = request.version.Equals("HTTP/1.1");
+    if (!chunked)
+      keepAlive = false;
+    CChunkedWriter writer(connection->socket, chunked, keepAlive);
+    CXbmcHttp::CResponseFormat format = m_pXbmcHttp->GetResponseFormat();
+    if (format.incWebHeader)
+      writer.Write("<html>\n");
+    if (!m_pXbmcHttp->StreamCommand(command, parameter, format, writer))
+      return false;
+    if (format.incWebFooter)
+      writer.Write("</html>\n");
+    return writer.Finish() && keepAlive;
+  }
+
+  CStdString response = pXbmcHttpShim->xbmcProcessCommand(NO_EID, NULL, (char_t *)command.c_str(), (char_t *)parameter.c_str(), true);
+  CXbmcHttp::CResponseFormat format = m_pXbmcHttp->GetResponseFormat();
+  if (format.incWebHeader)
+    response = "<html>\n" + response;
+  if (format.incWebFooter)
+    response += "</html>\n";
+  return SendResponse(connection, 200, "text/html", response, keepAlive, request.method.Equals("HEAD"));
+}
+
+bool CHttpServer::HandleFile(CConnection *connection, const CRequest &request, bool keepAlive)
+{
+  CStdString file = request.path.Mid(5);
+  CUtil::UrlDecode(file);
+  if (!IsServable(file))
+    return SendError(connection, 403, keepAlive);
+
+  CFile input;
+  if (file.IsEmpty() || !input.Open(file))
+    return SendError(connection, 404, keepAlive);
+
+  __int64 length = input.GetLength();
+  __int64 start = 0;
+  __int64 end = length - 1;
+  bool partial = false;
+
+  // single ranges only - multipart responses aren't worth it for media players
+  CStdString range = request.GetHeader("range");
+  if (range.Left(6).Equals("bytes=") && range.Find(',') < 0)
+  {
+    CStdString spec = range.Mid(6);
+    int dash = spec.Find('-');
+    if (dash >= 0)
+    {
+      CStdString first = spec.Left(dash);
+      CStdString last = spec.Mid(dash + 1);
+      if (first.IsEmpty())
+      { // suffix range - the last n bytes
+        __int64 suffix = _atoi64(last.c_str());
+        start = suffix < length ? length - suffix : 0;
+        if (suffix <= 0)
+          start = length;
+      }
+      else
+      {
+        start = _atoi64(first.c_str());
+        if (!last.IsEmpty() && _atoi64(last.c_str()) < end)
+          end = _atoi64(last.c_str());
+      }
+      if (start >= length || start > end)
+      {
+        CStdString header;
+        header.Format("HTTP/1.1 416 Requested Range Not Satisfiable\r\nContent-Range: bytes */%"PRId64"\r\n"
+                      "Content-Length: 0\r\nConnection: %s\r\n\r\n", length, keepAlive ? "keep-alive" : "close");
+        return Send(connection->socket, header.c_str(), header.size()) && keepAlive;
+      }
+      partial = true;
+    }
+  }
+
+  __int64 size = end - start + 1;
+  CStdString header;
+  header.Format("HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %"PRId64"\r\nAccept-Ranges: bytes\r\n",
+                partial ? "206 Partial Content" : "200 OK", ContentType(file).c_str(), size);
+  if (partial)
+  {
+    CStdString contentRange;
+    contentRange.Format("Content-Range: bytes %"PRId64"-%"PRId64"/%"PRId64"\r\n", start, end, length);
+    header += contentRange;
+  }
+  header += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+  if (!Send(connection->socket, header.c_str(), header.size()))
+    return false;
+  if (request.method.Equals("HEAD") || size <= 0)
+    return keepAlive;
+
+#ifdef HAS_SENDFILE
+  // local files go straight from the page cache to the socket
+  CStdString translated = _P(file);
+  if (CURL(translated).IsLocal())
+  {
+    int fd = open(translated.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+      input.Close();
+      off_t offset = (off_t)start;
+      __int64 remaining = size;
+      while (remaining > 0 && !m_bStop)
+      {
+        ssize_t sent = sendfile(connection->socket, fd, &offset, (size_t)(remaining < SEND_CHUNK_SIZE * 8 ? remaining : SEND_CHUNK_SIZE * 8));
+        if (sent <= 0)
+          break;
+        remaining -= sent;
+      }
+      close(fd);
+      return remaining == 0 && keepAlive;
+    }
+  }
+#endif
+
+  if (start && input.Seek(start) != start)
+    return false;
+  char *buffer = new char[SEND_CHUNK_SIZE];
+  __int64 remaining = size;
+  while (remaining > 0 && !m_bStop)
+  {
+    unsigned int read = input.Read(buffer, remaining < SEND_CHUNK_SIZE ? remaining : SEND_CHUNK_SIZE);
+    if (!read || !Send(connection->socket, buffer, read))
+      break;
+    remaining -= read;
+  }
+  delete[] buffer;
+  input.Close();
+  return remaining == 0 && keepAlive;
+}
+
+bool CHttpServer::IsServable(const CStdString &file)
+{
+  if (file.IsEmpty())
+    return false;
+  CStdString path = ComparablePath(file);
+  if (path.Find("/../") >= 0)
+    return false;
+
+  CStdString thumbs = ComparablePath(g_settings.GetThumbnailsFolder());
+  if (path.Left(thumbs.size()).Equals(thumbs))
+    return true;
+
+  const VECSOURCES *sources[] = { &g_settings.m_videoSources, &g_settings.m_musicSources,
+                                  &g_settings.m_pictureSources, &g_settings.m_fileSources };
+  for (unsigned int i = 0; i < sizeof(sources) / sizeof(sources[0]); i++)
+  {
+    for (unsigned int j = 0; j < sources[i]->size(); j++)
+    {
+      const CMediaSource &source = sources[i]->at(j);
+      vector<CStdString> paths = source.vecPaths;
+      paths.insert(paths.begin(), source.strPath);
+      for (unsigned int k = 0; k < paths.size(); k++)
+      {
+        if (paths[k].IsEmpty())
+          continue;
+        CStdString root = ComparablePath(paths[k]);
+        if (path.Left(root.size()).Equals(root))
+          return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool CHttpServer::SendResponse(CConnection *connection, int status, const CStdString &contentType,
+                               const CStdString &body, bool keepAlive, bool headOnly)
+{
+  CStdString header;
+  header.Format("HTTP/1.1 %i %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nCache-Control: no-cache\r\nConnection: %s\r\n\r\n",
+                status, StatusText(status).c_str(), contentType.c_str(), (unsigned int)body.size(), keepAlive ? "keep-alive" : "close");
+  if (!headOnly)
+    header += body;
+  return Send(connection->socket, header.c_str(), header.size()) && keepAlive;
+}
+
+bool CHttpServer::SendError(CConnection *connection, int status, bool keepAlive)
+{
+  CStdString body;
+  body.Format("<html><body><h1>%i %s</h1></body></html>\n", status, StatusText(status).c_str());
+  return SendResponse(connection, status, "text/html", body, keepAlive);
+}
+
+bool CHttpServer::Send(SOCKET socket, const char *data, unsigned int size)
+{
+  while (size)
+  {
+    int sent = send(socket, data, size, SEND_FLAGS);
+    if (sent <= 0)
+      return false;
+    data += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+CStdString CHttpServer::StatusText(int status)
+{
+  switch (status)
+  {
+  case 200: return "OK";
+  case 403: return "Forbidden";
+  case 404: return "Not Found";
+  case 501: return "Not Implemented";
+  case 503: return "Service Unavailable";
+  default: return "Error";
+  }
+}
+
+CStdString CHttpServer::ContentType(const CStdString &file)
+{
+  CStdString extension;
+  CUtil::GetExtension(file, extension);
+  extension.ToLower();
+  if (extension == ".jpg" || extension == ".jpeg" || extension == ".tbn")
+    return "image/jpeg";
+  if (extension == ".png")
+    return "image/png";
+  if (extension == ".gif")
+    return "image/gif";
+  if (extension == ".mp3")
+    return "audio/mpeg";
+  if (extension == ".flac")
+    return "audio/flac";
+  if (extension == ".m4a" || extension == ".aac")
+    return "audio/mp4";
+  if (extension == ".mp4" || extension == ".m4v" || extension == ".mov")
+    return "video/mp4";
+  if (extension == ".avi")
+    return "video/x-msvideo";
+  if (extension == ".mkv")
+    return "video/x-matroska";
+  if (extension == ".txt" || extension == ".nfo" || extension == ".log")
+    return "text/plain";
+  if (extension == ".xml")
+    return "text/xml";
+  return "application/octet-stream";
+}
+
+CStdString CHttpServer::Base64(const CStdString &data)
+{
+  static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  CStdString result;
+  for (unsigned int i = 0; i < data.size(); i += 3)
+  {
+    unsigned int left = data.size() - i;
+    unsigned int block = (unsigned char)data[i] << 16;
+    if (left > 1) block |= (unsigned char)data[i + 1] << 8;
+    if (left > 2) block |= (unsigned char)data[i + 2];
+    result += table[(block >> 18) & 0x3f];
+    result += table[(block >> 12) & 0x3f];
+    result += left > 1 ? table[(block >> 6) & 0x3f] : '=';
+    result += left > 2 ? table[block & 0x3f] : '=';
+  }
+  return result;
+}
+
+CStdString CHttpServer::CRequest::GetHeader(const CStdString &name) const
+{
+  map<CStdString, CStdString>::const_iterator it = headers.find(name);
+  if (it != headers.end())
+    return it->second;
+  return "";
+}
+
+CStdString CHttpServer::CRequest::GetVar(const CStdString &name) const
+{
+  // form posts take precedence over the query string, as in GoAhead
+  CStdString vars = query;
+  if (method.Equals("POST") && GetHeader("content-type").Left(33).Equals("application/x-www-form-urlencoded"))
+    vars = body + "&" + query;
+
+  CStdStringArray pairs;
+  StringUtils::SplitString(vars, "&", pairs);
+  for (unsigned int i = 0; i < pairs.size(); i++)
+  {
+    int equals = pairs[i].Find('=');
+    if (equals < 0 || !pairs[i].Left(equals).Equals(name))
+      continue;
+    CStdString value = pairs[i].Mid(equals + 1);
+    CUtil::UrlDecode(value);
+    return value;
+  }
+  return "";
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "Thread.h"
+#include "CriticalSection.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+/*!
+ \brief HTTP/1.1 server for the HTTP API and for streaming files and thumbnails.
+
+ The GoAhead server handles one request at a time on a single thread, which makes
+ it a poor fit for streaming media or thumbnails to several clients at once.  This
+ server runs alongside it (GoAhead still serves the web interface, ASP pages and
+ forms) on its own port.
+
+ The listening thread waits on the listen socket and on all idle keep-alive
+ connections, and hands any connection with data pending to a pool of worker
+ threads.  Workers parse a request, answer it and give the connection back to the
+ listener, so a slow download only ever ties up one worker.
+
+   /xbmcCmds/xbmcHttp?command=...&parameter=...   HTTP API command.  Commands that only read
+                                                  files and the databases (see
+                                                  CXbmcHttp::IsStreamable) run on the worker and
+                                                  are sent as they are produced, with chunked
+                                                  encoding.  The rest run on the application
+                                                  thread, as they touch the GUI and players.
+   /vfs/<url encoded path>                        a file under one of the media sources or the
+                                                  thumbnails folder, with Range support
+
+ Workers never wait for a client to send the rest of a request; the listener holds the
+ connection until it has, or until REQUEST_TIMEOUT.
+ */
+class CHttpServer : public CThread, public IRunnable
+{
+public:
+  CHttpServer();
+  virtual ~CHttpServer();
+
+  bool Start(int port, unsigned int threads);
+  void Stop();
+
+  /*! \brief Require basic auth as user "plex" with this password, or no auth if empty
+   */
+  void SetPassword(const CStdString &password);
+
+  // IRunnable entry point for the workers
+  virtual void Run();
+
+protected:
+  virtual void Process();
+
+private:
+  class CChunkedWriter;
+
+  struct CConnection
+  {
+    SOCKET socket;
+    unsigned int requests;   // requests served so far
+    DWORD lastActive;
+    DWORD requestStart;      // when an unfinished request was first seen, 0 if none
+    CStdString buffer;       // data read past the end of the last request
+  };
+
+  enum RequestState
+  {
+    REQUEST_READY,
+    REQUEST_INCOMPLETE,      // the rest hasn't arrived yet
+    REQUEST_FAILED
+  };
+
+  struct CRequest
+  {
+    CStdString method;
+    CStdString path;
+    CStdString query;
+    CStdString version;
+    std::map<CStdString, CStdString> headers;   // names are lower case
+    CStdString body;
+
+    CStdString GetHeader(const CStdString &name) const;
+    CStdString GetVar(const CStdString &name) const;
+  };
+
+  void CloseConnection(CConnection *connection);
+  RequestState ReadRequest(CConnection *connection, CRequest &request);
+  int ReadData(CConnection *connection);   // 1 if read, 0 if nothing waiting, -1 if closed
+  bool HandleRequest(CConnection *connection, const CRequest &request);
+
+  bool HandleApi(CConnection *connection, const CRequest &request, bool keepAlive);
+  bool HandleFile(CConnection *connection, const CRequest &request, bool keepAlive);
+  static bool IsServable(const CStdString &file);
+  bool SendResponse(CConnection *connection, int status, const CStdString &contentType,
+                    const CStdString &body, bool keepAlive, bool headOnly = false);
+  bool SendError(CConnection *connection, int status, bool keepAlive);
+
+  static bool Send(SOCKET socket, const char *data, unsigned int size);
+  static CStdString StatusText(int status);
+  static CStdString ContentType(const CStdString &file);
+  static CStdString Base64(const CStdString &data);
+
+  static const unsigned int MAX_HEADER_SIZE = 16384;
+  static const unsigned int MAX_BODY_SIZE = 65536;
+  static const unsigned int MAX_KEEPALIVE_REQUESTS = 100;
+  static const DWORD KEEPALIVE_TIMEOUT = 15000;
+  static const DWORD REQUEST_TIMEOUT = 10000;
+  static const DWORD SEND_TIMEOUT = 30000;
+  static const unsigned int SEND_CHUNK_SIZE = 128 * 1024;
+
+  SOCKET m_listenSocket;
+  int m_port;
+  std::vector<CThread *> m_workers;
+
+  CCriticalSection m_queueSection;
+  std::deque<CConnection *> m_queue;    // connections with a request waiting for a worker
+  CEvent m_queueEvent;
+  std::vector<CConnection *> m_idle;    // keep-alive connections waiting for a request
+
+  CCriticalSection m_authSection;
+  CStdString m_authorization;           // expected "Basic ..." value, empty for no auth
+};
@@ -20,6 +20,8 @@
 #include "XBMCweb.h"
 #include "XBMCConfiguration.h"
 #include "XBMChttp.h"
+#include "HttpServer.h"
+#include "Settings.h"
 #include "includes.h"
 
 using namespace std;
@@ -72,6 +74,7 @@ CWebServer::CWebServer()
     m_pXbmcHttp = new CXbmcHttp();
   m_port = 80;					/* Server port */
   m_szPassword[0] = '\0';
+  m_pHttpServer = NULL;
 
   m_hEvent = CreateEvent(NULL, true, false, NULL);
 }
@@ -128,6 +131,18 @@ bool CWebServer::Start(const char *szLocalAddress, int port, const char_t* web,
   if (m_ThreadHandle == NULL) return false;  
 
   CThread::SetName("Webserver");
+
+  if (g_advancedSettings.m_httpServerPort > 0)
+  {
+    m_pHttpServer = new CHttpServer();
+    m_pHttpServer->SetPassword(g_guiSettings.GetString("servers.webserverpassword"));
+    if (!m_pHttpServer->Start(g_advancedSettings.m_httpServerPort, g_advancedSettings.m_httpServerThreads))
+    {
+      delete m_pHttpServer;
+      m_pHttpServer = NULL;
+    }
+  }
+
   if( wait )
   {    
     // wait until the webserver is ready
@@ -143,6 +158,13 @@ bool CWebServer::Start(const char *szLocalAddress, int port, const char_t* web,
 
 void CWebServer::Stop()
 {
+  if (m_pHttpServer)
+  {
+    m_pHttpServer->Stop();
+    delete m_pHttpServer;
+    m_pHttpServer = NULL;
+  }
+
   m_bFinished = true;
   
   StopThread();
@@ -343,6 +365,7 @@ void CWebServer::SetPassword(const char* strPassword)
 
   // save password in member var for later usage by GetPassword()
   if (strPassword) strcpy(m_szPassword, strPassword);
+  if (m_pHttpServer) m_pHttpServer->SetPassword(strPassword ? strPassword : "");
   
   // if password !NULL and greater then 0, enable user access
   if (strPassword && strlen(strPassword) > 0)
@@ -51,6 +51,8 @@ int XbmcWebsHttpAPIConfigSetOption(CStdString& response, int argc, char_t **argv
 }
 #endif 
 
+class CHttpServer;
+
 // group for default xbox user
 #define WEBSERVER_UM_GROUP "sys_xbox"
 
@@ -84,4 +86,5 @@ protected:
 	bool						m_bFinished;				/* Finished flag */
 	bool						m_bStarted;				/* Started flag */
 	HANDLE					m_hEvent;
+	CHttpServer*    m_pHttpServer;      /* threaded api and streaming server */
 };
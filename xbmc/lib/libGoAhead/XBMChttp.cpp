@@ -44,6 +44,7 @@
 #include "PictureInfoTag.h"
 #include "FileItem.h"
 #include "Settings.h"
+#include "SingleLock.h"
 
 using namespace std;
 using namespace MUSIC_GRABBER;
@@ -104,6 +105,40 @@ CXbmcHttp::~CXbmcHttp()
   CLog::Log(LOGDEBUG, "xbmcHttp ends");
 }
 
+// collects the output of a command into a string for SetResponse
+class CStringResponseWriter : public IHttpResponseWriter
+{
+public:
+  virtual bool Write(const CStdString &data) { response += data; return true; };
+  CStdString response;
+};
+
+// adds the closing tag for closeFinalTag once the output is complete
+class CFinalTagWriter : public IHttpResponseWriter
+{
+public:
+  CFinalTagWriter(IHttpResponseWriter &writer, const CStdString &closeTag) : m_writer(writer), m_closeTag(closeTag) {};
+  virtual bool Write(const CStdString &data)
+  {
+    if (data.IsEmpty())
+      return true;
+    m_tail += data;
+    if (m_tail.size() > m_closeTag.size())
+      m_tail = m_tail.Right(m_closeTag.size());
+    return m_writer.Write(data);
+  };
+  bool Finish()
+  {
+    if (m_tail.size() < m_closeTag.size() || m_tail != m_closeTag)
+      return m_writer.Write(m_closeTag);
+    return true;
+  };
+private:
+  IHttpResponseWriter &m_writer;
+  CStdString m_closeTag;
+  CStdString m_tail;
+};
+
 /*
 ** encode
 **
@@ -111,46 +146,69 @@ CXbmcHttp::~CXbmcHttp()
 */
 CStdString CXbmcHttp::encodeFileToBase64(const CStdString &inFilename, int linesize )
 {
-  unsigned char in[3];//, out[4];
-  int len, blocksout = 0;
+  CStringResponseWriter writer;
+  encodeFileToBase64(inFilename, linesize, closeTag, writer);
+  return writer.response;
+}
+
+// as above, but the output is written a chunk at a time rather than built up in one string
+bool CXbmcHttp::encodeFileToBase64(const CStdString &inFilename, int linesize, const CStdString &lineEnd, IHttpResponseWriter &writer)
+{
+  int blocksout = 0;
   CStdString strBase64="";
+  bool success = true;
 
 //  Translation Table as described in RFC1113
   static const char cb64[]="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+  // read in large chunks rather than 3 bytes at a time - thumbnails are fetched this way a lot
+  static const unsigned int chunkSize = 3 * 16384;
   CFile file;
-  bool bOutput=false;
   if (file.Open(inFilename.c_str())) 
   {
-    while( file.GetPosition() != file.GetLength() ) 
+    __int64 length = file.GetLength();
+    strBase64.reserve(chunkSize / 3 * 4 + (linesize > 0 ? (chunkSize / linesize + 1) * (lineEnd.size() + 1) : lineEnd.size()));
+    unsigned char *buffer = new unsigned char[chunkSize + 2];
+    __int64 done = 0;
+    while (done < length && success)
     {
-      memset(in, 0, sizeof(in));
-      len = file.Read(in, 3);
-      if( len ) 
+      int len = 0;
+      while (len < (int)chunkSize)
+      { // keep the chunks a multiple of 3 so blocks never straddle two reads
+        int read = file.Read(buffer + len, chunkSize - len);
+        if (read <= 0)
+          break;
+        len += read;
+      }
+      if (len <= 0)
+        break;
+      done += len;
+      buffer[len] = buffer[len + 1] = 0;
+      for (int i = 0; i < len; i += 3)
       {
-		    strBase64 += cb64[ in[0] >> 2 ];
+        unsigned char *in = buffer + i;
+        int left = len - i;
+        strBase64 += cb64[ in[0] >> 2 ];
         strBase64 += cb64[ ((in[0] & 0x03) << 4) | ((in[1] & 0xf0) >> 4) ];
-        strBase64 += (unsigned char) (len > 1 ? cb64[ ((in[1] & 0x0f) << 2) | ((in[2] & 0xc0) >> 6) ] : '=');
-        strBase64 += (unsigned char) (len > 2 ? cb64[ in[2] & 0x3f ] : '=');
+        strBase64 += (unsigned char) (left > 1 ? cb64[ ((in[1] & 0x0f) << 2) | ((in[2] & 0xc0) >> 6) ] : '=');
+        strBase64 += (unsigned char) (left > 2 ? cb64[ in[2] & 0x3f ] : '=');
         blocksout++;
+        bool last = (done >= length && i + 3 >= len);
+        if ((linesize == 0 && last) || (linesize > 0 && (blocksout >= (linesize/4) || last)))
+        {
+          if( linesize > 0 )
+            strBase64 += "\r";
+          strBase64 += lineEnd ;
+          blocksout = 0;
+        }
       }
-      if(linesize == 0 && file.GetPosition() == file.GetLength())
-        bOutput=true;
-      else if ((linesize > 0) && (blocksout >= (linesize/4) || (file.GetPosition() == file.GetLength())))
-        bOutput=true;
-      if (bOutput)
-      {
-        if( blocksout && linesize > 0 )
-          strBase64 += "\r";
-        if( blocksout )
-          strBase64 += closeTag ;
-        blocksout = 0;
-        bOutput=false;
-      }
+      success = writer.Write(strBase64);
+      strBase64.clear();
     }
+    delete[] buffer;
     file.Close();
   }
-  return strBase64;
+  return success;
 }
 
 /*
@@ -228,6 +286,7 @@ __int64 CXbmcHttp::fileSize(const CStdString &filename)
 
 void CXbmcHttp::resetTags()
 {
+  CSingleLock lock(m_formatSection);
   openTag="<li>"; 
   closeTag="\n";
   userHeader="";
@@ -352,6 +411,13 @@ int CXbmcHttp::SetResponse(const CStdString &response)
 }
 
 int CXbmcHttp::displayDir(int numParas, CStdString paras[]) 
+{
+  CStringResponseWriter writer;
+  displayDir(numParas, paras, GetResponseFormat(), writer);
+  return SetResponse(writer.response);
+}
+
+bool CXbmcHttp::displayDir(int numParas, CStdString paras[], const CResponseFormat &format, IHttpResponseWriter &writer)
 {
   //mask = ".mp3|.wma" or one of "[music]", "[video]", "[pictures]", "[files]"-> matching files
   //mask = "*" or "/" -> just folders
@@ -360,19 +426,20 @@ int CXbmcHttp::displayDir(int numParas, CStdString paras[])
   //option = "size" -> just return the number of entries
 
   CFileItemList dirItems;
-  CStdString output="";
 
   CStdString  folder, mask="", option="";
   int lineStart=0, numLines=-1;
 
   if (numParas==0)
   {
-    return SetResponse(openTag+"Error:Missing folder");
+    writer.Write(format.openTag+"Error:Missing folder");
+    return false;
   }
   folder=paras[0];
   if (folder.length()<1)
   {
-    return SetResponse(openTag+"Error:Missing folder");
+    writer.Write(format.openTag+"Error:Missing folder");
+    return false;
   }
   if (numParas>1)
     mask=procMask(paras[1]);
@@ -385,23 +452,30 @@ int CXbmcHttp::displayDir(int numParas, CStdString paras[])
   IDirectory *pDirectory = CFactoryDirectory::Create(folder);
   if (!pDirectory) 
   {
-    return SetResponse(openTag+"Error");  
+    writer.Write(format.openTag+"Error");
+    return false;
   }
   pDirectory->SetMask(mask);
-  if (!pDirectory->GetDirectory(folder,dirItems))
+  bool success = pDirectory->GetDirectory(folder,dirItems);
+  delete pDirectory;
+  if (!success)
   {
-    return SetResponse(openTag+"Error:Not folder");
+    writer.Write(format.openTag+"Error:Not folder");
+    return false;
   }
   if (option=="size")
   {
 	CStdString tmp;
 	tmp.Format("%i",dirItems.Size());
-    return SetResponse(openTag+tmp);
+    return writer.Write(format.openTag+tmp);
   }
   dirItems.Sort(SORT_METHOD_LABEL, SORT_ORDER_ASC);
   CStdString aLine="";
   if (lineStart>dirItems.Size() || lineStart<0)
-    return SetResponse(openTag+"Error:Line start value out of range");
+  {
+    writer.Write(format.openTag+"Error:Line start value out of range");
+    return false;
+  }
   if (numLines==-1)
     numLines=dirItems.Size();
   if ((numLines+lineStart)>dirItems.Size())
@@ -411,23 +485,188 @@ int CXbmcHttp::displayDir(int numParas, CStdString paras[])
     CFileItemPtr itm = dirItems[i];
     if (mask=="*" || mask=="/" || (mask =="" && itm->m_bIsFolder))
       if (!CUtil::HasSlashAtEnd(itm->m_strPath))
-        aLine=closeTag+openTag + itm->m_strPath + "\\" ;
+        aLine=format.closeTag+format.openTag + itm->m_strPath + "\\" ;
       else
-        aLine=closeTag+openTag + itm->m_strPath ;
+        aLine=format.closeTag+format.openTag + itm->m_strPath ;
     else
       if (!itm->m_bIsFolder)
-        aLine=closeTag+openTag + itm->m_strPath;
+        aLine=format.closeTag+format.openTag + itm->m_strPath;
     if (aLine!="")
     {
-      if (option=="1" || option=="showdate") {
-        output+=aLine+"  ;" + itm->m_dateTime.GetAsLocalizedDateTime();
-      }
-      else
-        output+=aLine;
+      if (option=="1" || option=="showdate")
+        aLine+="  ;" + itm->m_dateTime.GetAsLocalizedDateTime();
+      if (!writer.Write(aLine))
+        return false;
       aLine="";
     }
   }
-  return SetResponse(output);
+  return true;
+}
+
+// Holds the output of GetArbitraryQuery until the statement is finished, so the database
+// isn't kept locked while a slow client reads it.  Past SPOOL_MEMORY bytes the output goes
+// to a temporary file, so memory use still doesn't depend on the size of the result.
+class CQuerySpool : public CDatabase::IQueryOutput
+{
+public:
+  CQuerySpool() : failed(false), m_spooled(false) {};
+  ~CQuerySpool()
+  {
+    if (m_spooled)
+    {
+      m_file.Close();
+      ::DeleteFile(m_fileName.c_str());
+    }
+  };
+  virtual bool Write(const CStdString &data)
+  {
+    m_buffer += data;
+    if (m_buffer.size() < SPOOL_MEMORY)
+      return true;
+    if (!m_spooled)
+    { // several of the http server's threads can be running queries at once
+      m_fileName.Format("%sxbmcQuery%u.tmp", _P("Z:\\").c_str(), (unsigned int)GetCurrentThreadId());
+      if (!m_file.OpenForWrite(m_fileName, true, true))
+      {
+        failed=true;
+        return false;
+      }
+      m_spooled=true;
+    }
+    if (m_file.Write(m_buffer.c_str(), m_buffer.size()) != (int)m_buffer.size())
+    {
+      failed=true;
+      return false;
+    }
+    m_buffer.clear();
+    return true;
+  };
+  // hands everything on to writer, once the query is done with
+  bool Replay(IHttpResponseWriter &writer)
+  {
+    if (m_spooled)
+    {
+      m_file.Close();
+      CFile input;
+      if (!input.Open(m_fileName))
+        return false;
+      char *buffer = new char[SPOOL_MEMORY];
+      bool success=true;
+      unsigned int read;
+      while (success && (read = input.Read(buffer, SPOOL_MEMORY)) > 0)
+        success=writer.Write(CStdString(buffer, read));
+      delete[] buffer;
+      input.Close();
+      if (!success)
+        return false;
+    }
+    return m_buffer.IsEmpty() || writer.Write(m_buffer);
+  };
+  bool failed;
+private:
+  static const unsigned int SPOOL_MEMORY = 256 * 1024;
+  CStdString m_buffer;
+  bool m_spooled;
+  CStdString m_fileName;
+  CFile m_file;
+};
+
+bool CXbmcHttp::queryDataBase(CDatabase &database, int numParas, CStdString paras[], const CResponseFormat &format, IHttpResponseWriter &writer)
+{
+  // paras: query;[offset];[limit]
+  if (numParas==0)
+  {
+    writer.Write(format.openTag+"Error:Missing Parameter");
+    return false;
+  }
+  if (!database.Open())
+  {
+    writer.Write(format.openTag+"Error:Could not open database");
+    return false;
+  }
+  int offset=0, limit=-1;
+  if (numParas>1 && atoi(paras[1])>0)
+    offset=atoi(paras[1]);
+  if (numParas>2 && paras[2]!="")
+    limit=atoi(paras[2]);
+
+  // nothing goes to the client until the statement is finished with
+  CQuerySpool output;
+  CStdString error;
+  bool success=database.GetArbitraryQuery(paras[0], format.openRecordSet, format.closeRecordSet, format.openRecord, format.closeRecord,
+                                          format.openField, format.closeField, output, error, offset, limit);
+  database.Close();
+  if (success)
+    return output.Replay(writer);
+  if (output.failed)
+    writer.Write(format.openTag+"Error:Could not write temporary file");
+  else
+    writer.Write(format.openTag+"Error:"+error);
+  return false;
+}
+
+bool CXbmcHttp::IsStreamable(const CStdString &command)
+{
+  CStdString cmd=command;
+  cmd.ToLower();
+  return cmd=="querymusicdatabase" || cmd=="queryvideodatabase" || cmd=="getdirectory" ||
+         cmd=="getthumb" || cmd=="filedownload";
+}
+
+CXbmcHttp::CResponseFormat CXbmcHttp::GetResponseFormat()
+{
+  CSingleLock lock(m_formatSection);
+  CResponseFormat format;
+  format.userHeader=userHeader;
+  format.userFooter=userFooter;
+  format.openTag=openTag;
+  format.closeTag=closeTag;
+  format.openRecordSet=openRecordSet;
+  format.closeRecordSet=closeRecordSet;
+  format.openRecord=openRecord;
+  format.closeRecord=closeRecord;
+  format.openField=openField;
+  format.closeField=closeField;
+  format.incWebHeader=incWebHeader;
+  format.incWebFooter=incWebFooter;
+  format.closeFinalTag=closeFinalTag;
+  return format;
+}
+
+bool CXbmcHttp::StreamCommand(const CStdString &command, const CStdString &parameter, const CResponseFormat &format, IHttpResponseWriter &writer)
+{
+  if (shuttingDown)
+    return false;
+  CStdString cmd, paras[MAX_PARAS];
+  int numParas=splitParameter(parameter!="" ? command+"; "+parameter : command, cmd, paras, ";");
+  cmd.ToLower();
+  CLog::Log(LOGDEBUG, "HttpApi Start streamed command: %s", cmd.c_str());
+
+  // the same output as the command would give through SetResponse and the shim
+  if (!writer.Write(format.userHeader))
+    return false;
+  CFinalTagWriter output(writer, format.closeTag);
+  if (numParas<0)
+    output.Write(format.openTag+(numParas==-2 ? "Error:Too many parameters" : "Error:Missing command"));
+  else if (cmd=="querymusicdatabase")
+  {
+    CMusicDatabase musicdatabase;
+    queryDataBase(musicdatabase, numParas, paras, format, output);
+  }
+  else if (cmd=="queryvideodatabase")
+  {
+    CVideoDatabase videodatabase;
+    queryDataBase(videodatabase, numParas, paras, format, output);
+  }
+  else if (cmd=="getthumb" || cmd=="filedownload")
+    getThumb(numParas, paras, cmd=="getthumb", format, output);
+  else if (numParas>0)
+    displayDir(numParas, paras, format, output);
+  else
+    output.Write(format.openTag+"Error:No path");
+  if (format.closeFinalTag && !output.Finish())
+    return false;
+  return writer.Write(format.userFooter);
 }
 
 void CXbmcHttp::SetCurrentMediaItem(CFileItem& newItem)
@@ -961,46 +1200,18 @@ int CXbmcHttp::xbmcGetSources(int numParas, CStdString paras[])
 
 int CXbmcHttp::xbmcQueryMusicDataBase(int numParas, CStdString paras[])
 {
-  if (numParas==0)
-    return SetResponse(openTag+"Error:Missing Parameter");
-  else
-  {
-	CMusicDatabase musicdatabase;
-	if (musicdatabase.Open())
-	{
-	  CStdString result;
-      if (musicdatabase.GetArbitraryQuery(paras[0], openRecordSet, closeRecordSet, openRecord, closeRecord, openField, closeField, result))
-		return SetResponse(result);
-	  else
-		  return SetResponse(openTag+"Error:"+result);
-	  musicdatabase.Close();
-	}
-	else
-	  return SetResponse(openTag+"Error:Could not open database");
-  }
-  return true;
+  CMusicDatabase musicdatabase;
+  CStringResponseWriter writer;
+  queryDataBase(musicdatabase, numParas, paras, GetResponseFormat(), writer);
+  return SetResponse(writer.response);
 }
 
 int CXbmcHttp::xbmcQueryVideoDataBase(int numParas, CStdString paras[])
 {
-  if (numParas==0)
-    return SetResponse(openTag+"Error:Missing Parameter");
-  else
-  {
-	CVideoDatabase videodatabase;
-	if (videodatabase.Open())
-	{
-	  CStdString result;
-      if (videodatabase.GetArbitraryQuery(paras[0], openRecordSet, closeRecordSet, openRecord, closeRecord, openField, closeField, result))
-		return SetResponse(result);
-	  else
-		  return SetResponse(openTag+"Error:"+result);
-	  videodatabase.Close();
-	}
-	else
-	  return SetResponse(openTag+"Error:Could not open database");
-  }
-  return true;
+  CVideoDatabase videodatabase;
+  CStringResponseWriter writer;
+  queryDataBase(videodatabase, numParas, paras, GetResponseFormat(), writer);
+  return SetResponse(writer.response);
 }
 
 int CXbmcHttp::xbmcAddToPlayList(int numParas, CStdString paras[])
@@ -1698,42 +1909,49 @@ int CXbmcHttp::xbmcGetGUIStatus()
 
 int CXbmcHttp::xbmcGetThumb(int numParas, CStdString paras[], bool bGetThumb)
 {
-  CStdString thumb="";
+  CStringResponseWriter writer;
+  getThumb(numParas, paras, bGetThumb, GetResponseFormat(), writer);
+  return SetResponse(writer.response);
+}
+
+bool CXbmcHttp::getThumb(int numParas, CStdString paras[], bool bGetThumb, const CResponseFormat &format, IHttpResponseWriter &writer)
+{
   int linesize=80;
   if (numParas<1)
-    return SetResponse(openTag+"Error:Missing parameter");
+  {
+    writer.Write(format.openTag+"Error:Missing parameter");
+    return false;
+  }
   bool bImgTag=false;
   // only allow the old GetThumb command to accept "imgtag"
   if (bGetThumb && numParas==2 && paras[1].Equals("imgtag"))
   {
     bImgTag=true;
-    thumb="<img src=\"data:image/jpg;base64,";
     linesize=0;
   }
+  CStdString file=paras[0], strDest;
   if (CUtil::IsRemote(paras[0]))
-  {
-    CStdString strDest=_P("Z:\\")+"xbmcDownloadFile.tmp";
+  { // this can run on several of the http server's threads at once, so each needs its own copy
+    strDest.Format("%sxbmcDownloadFile%u.tmp", _P("Z:\\").c_str(), (unsigned int)GetCurrentThreadId());
     CFile::Cache(paras[0], strDest.c_str(),NULL,NULL) ;
-    if (CFile::Exists(strDest))
-    {
-      thumb+=encodeFileToBase64(strDest,linesize);
-      ::DeleteFile(strDest.c_str());
-    }
-    else
+    if (!CFile::Exists(strDest))
     {
-      return SetResponse(openTag+"Error");
+      writer.Write(format.openTag+"Error");
+      return false;
     }
+    file=strDest;
   }
-  else
-    thumb+=encodeFileToBase64(paras[0],linesize);
 
+  bool success=true;
   if (bImgTag)
-  {
-    thumb+="\" alt=\"Your browser doesnt support this\" title=\"";
-    thumb+=paras[0];
-    thumb+="\">";
-  }
-  return SetResponse(thumb) ;
+    success=writer.Write("<img src=\"data:image/jpg;base64,");
+  if (success)
+    success=encodeFileToBase64(file, linesize, format.closeTag, writer);
+  if (!strDest.IsEmpty())
+    ::DeleteFile(strDest.c_str());
+  if (success && bImgTag)
+    success=writer.Write("\" alt=\"Your browser doesnt support this\" title=\""+paras[0]+"\">");
+  return success;
 }
 
 int CXbmcHttp::xbmcGetThumbFilename(int numParas, CStdString paras[])
@@ -2887,6 +3105,7 @@ int CXbmcHttp::xbmcSetResponseFormat(int numParas, CStdString paras[])
     return SetResponse(openTag+"Error:Missing parameter");
   else
   {
+    CSingleLock lock(m_formatSection);
 	CStdString para;
 	for (int i=0; i<numParas; i+=2)
 	{
@@ -3139,20 +3358,19 @@ CStdString CXbmcHttpShim::xbmcExternalCall(char *command)
 }
 
 /* Parse an XBMC HTTP API command */
-CStdString CXbmcHttpShim::xbmcProcessCommand( int eid, webs_t wp, char_t *command, char_t *parameter)
+CStdString CXbmcHttpShim::xbmcProcessCommand( int eid, webs_t wp, char_t *command, char_t *parameter, bool webCall)
 {
   if (m_pXbmcHttp)
     if (m_pXbmcHttp->shuttingDown)
       return "";
-  CStdString cmd=command, paras=parameter, response="[No response yet]", retVal;
+  CStdString cmd=command, paras=parameter, response, retVal;
   bool legalCmd=true;
   //CLog::Log(LOGDEBUG, "XBMCHTTPShim: Received command %s (%s)", cmd.c_str(), paras.c_str());
-  int cnt=0;
 
   checkForFunctionTypeParas(cmd, paras);
-  if (wp!=NULL)
+  if (wp!=NULL || webCall)
   {
-    if (eid==NO_EID)
+    if (eid==NO_EID && wp!=NULL)
 	  if (m_pXbmcHttp)
 	  {
 	    if (m_pXbmcHttp->incWebHeader)
@@ -3161,8 +3379,9 @@ CStdString CXbmcHttpShim::xbmcProcessCommand( int eid, webs_t wp, char_t *comman
 	  //else
 	    //websHeader(wp);
 
-	//we are being called via the webserver (rather than Python) so add any specific checks here
-    if ((cmd=="webserverstatus") && (paras!=""))//(strcmp(parameter,XBMC_NONE)))
+	//we are being called via the webserver (rather than Python) so add any specific checks here.
+	//Stopping the server from one of its own threads would wait on that thread forever.
+    if (cmd.Equals("webserverstatus") && (paras!=""))//(strcmp(parameter,XBMC_NONE)))
 	{
 	  response="Error:Can't turn off/on WebServer via a web call";
 	  legalCmd=false;
@@ -3170,29 +3389,18 @@ CStdString CXbmcHttpShim::xbmcProcessCommand( int eid, webs_t wp, char_t *comman
   }
   if (legalCmd)
   {
+    // each call gets its own response back with the message, so callers on the http
+    // server's workers, GoAhead and python don't have to take turns
 	  if (paras!="")
-		g_application.getApplicationMessenger().HttpApi(cmd+"; "+paras, true);
+		response=g_application.getApplicationMessenger().HttpApi(cmd+"; "+paras, true);
 	  else
-		g_application.getApplicationMessenger().HttpApi(cmd, true);
-	//wait for response - max 20s
-	Sleep(0);
-	response=g_application.getApplicationMessenger().GetResponse();
-	while (response=="[No response yet]" && cnt++<200) 
-	{
-	  response=g_application.getApplicationMessenger().GetResponse();
-	  CLog::Log(LOGDEBUG, "XBMCHTTPShim: waiting %d", cnt);
-	  Sleep(100);
-	}
-	if (cnt>199)
-	{
-	  response="Error:Timed out";
-	  CLog::Log(LOGDEBUG, "HttpApi Timed out");
-	}
+		response=g_application.getApplicationMessenger().HttpApi(cmd, true);
   }
   //flushresult
-  retVal=flushResult(eid, wp, m_pXbmcHttp->userHeader+response+m_pXbmcHttp->userFooter);
+  CXbmcHttp::CResponseFormat format=m_pXbmcHttp->GetResponseFormat();
+  retVal=flushResult(eid, wp, format.userHeader+response+format.userFooter);
   if (m_pXbmcHttp) //this should always be true unless something is very wrong
-    if ((wp!=NULL) && (m_pXbmcHttp->incWebFooter) && eid==NO_EID)
+    if ((wp!=NULL) && (format.incWebFooter) && eid==NO_EID)
       websFooter(wp);
   return retVal;
 }
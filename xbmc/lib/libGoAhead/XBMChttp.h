@@ -3,6 +3,7 @@
 #include "utils/UdpClient.h"
 #include "Key.h"
 #include "boost/shared_ptr.hpp"
+#include "utils/CriticalSection.h"
 
 /******************************** Description *********************************/
 
@@ -18,6 +19,17 @@ typedef char char_t;
 typedef struct websRec *webs_t;
 
 class CFileItem; typedef boost::shared_ptr<CFileItem> CFileItemPtr;
+class CDatabase;
+
+/*
+ *  Where the output of a command goes when it is streamed (see CXbmcHttp::StreamCommand)
+ */
+class IHttpResponseWriter
+{
+public:
+  virtual ~IHttpResponseWriter() {}
+  virtual bool Write(const CStdString &data)=0;
+};
 
 class CXbmcHttpShim
 {
@@ -27,7 +39,7 @@ public:
 
   void xbmcForm(webs_t wp, char_t *path, char_t *query);
   int	xbmcCommand( int eid, webs_t wp, int argc, char_t **argv);
-  CStdString xbmcProcessCommand( int eid, webs_t wp, char_t *command, char_t *parameter);
+  CStdString xbmcProcessCommand( int eid, webs_t wp, char_t *command, char_t *parameter, bool webCall = false);
   CStdString xbmcExternalCall(char *command);
   bool checkForFunctionTypeParas(CStdString &cmd, CStdString &paras);
 private:
@@ -52,6 +64,22 @@ public:
   ~CXbmcHttp();
 
   int xbmcCommand(const CStdString &parameter);
+
+  // the tags set by SetResponseFormat.  They are changed on the application thread, so the
+  // http server's threads work from a copy taken with GetResponseFormat.
+  struct CResponseFormat
+  {
+    CStdString userHeader, userFooter, openTag, closeTag, openRecordSet, closeRecordSet, openRecord, closeRecord, openField, closeField;
+    bool incWebHeader, incWebFooter, closeFinalTag;
+  };
+  CResponseFormat GetResponseFormat();
+
+  // querymusicdatabase, queryvideodatabase, getdirectory, getthumb and filedownload only
+  // read files and the databases, so they can be run on the http server's threads and
+  // written out as they go, instead of being built up in one response string on the
+  // application thread.
+  bool IsStreamable(const CStdString &command);
+  bool StreamCommand(const CStdString &command, const CStdString &parameter, const CResponseFormat &format, IHttpResponseWriter &writer);
   int xbmcAddToPlayList(int numParas, CStdString paras[]);
   int xbmcPlayerPlayFile(int numParas, CStdString paras[]); 
   int xbmcClearPlayList(int numParas, CStdString paras[]); 
@@ -143,9 +171,11 @@ private:
   CStdString lastThumbFn, lastPlayingInfo;
   CStdString openTag, closeTag,  openRecordSet, closeRecordSet, openRecord, closeRecord, openField, closeField, openBroadcast, closeBroadcast;
   bool  closeFinalTag;
+  CCriticalSection m_formatSection;
 
   void encodeblock( unsigned char in[3], unsigned char out[4], int len );
   CStdString encodeFileToBase64(const CStdString &inFilename, int linesize );
+  bool encodeFileToBase64(const CStdString &inFilename, int linesize, const CStdString &lineEnd, IHttpResponseWriter &writer);
   void decodeblock( unsigned char in[4], unsigned char out[3] );
   bool decodeBase64ToFile( const CStdString &inString, const CStdString &outfilename, bool append = false );
   __int64 fileSize(const CStdString &filename);
@@ -156,6 +186,9 @@ private:
   int SetResponse(const CStdString &response);
   CStdString flushResult(int eid, webs_t wp, const CStdString &output);
   int displayDir(int numParas, CStdString paras[]);
+  bool displayDir(int numParas, CStdString paras[], const CResponseFormat &format, IHttpResponseWriter &writer);
+  bool getThumb(int numParas, CStdString paras[], bool bGetThumb, const CResponseFormat &format, IHttpResponseWriter &writer);
+  bool queryDataBase(CDatabase &database, int numParas, CStdString paras[], const CResponseFormat &format, IHttpResponseWriter &writer);
   void SetCurrentMediaItem(CFileItem& newItem);
   void AddItemToPlayList(const CFileItemPtr &pItem, int playList, int sortMethod, CStdString mask, bool recursive);
   void LoadPlayListOld(const CStdString& strPlayList, int playList);
@@ -265,6 +265,11 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+/* as query, but each row is handed to callback as it is read instead of being
+   kept in the dataset.  The callback returns false to stop early, in which case
+   query_rows returns false too. */
+  typedef bool (*row_callback)(const sql_record &row, void *data);
+  virtual bool query_rows(const char *sql, row_callback callback, void *data) = 0;
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
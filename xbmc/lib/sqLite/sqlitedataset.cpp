@@ -422,6 +422,35 @@ const void* SqliteDataset::getExecRes() {
 }
 
 
+void SqliteDataset::read_row(sqlite3_stmt *stmt, unsigned int numColumns, sql_record &row) {
+  row.clear(); // the record may be reused, and set_asString() doesn't reset set_isNull()
+  row.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    field_value &v = row.at(i);
+    switch (sqlite3_column_type(stmt, i))
+    {
+    case SQLITE_INTEGER:
+      v.set_asInt64(sqlite3_column_int64(stmt, i));
+      break;
+    case SQLITE_FLOAT:
+      v.set_asDouble(sqlite3_column_double(stmt, i));
+      break;
+    case SQLITE_TEXT:
+      v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      break;
+    case SQLITE_BLOB:
+      v.set_asString((const char *)sqlite3_column_text(stmt, i));
+      break;
+    case SQLITE_NULL:
+    default:
+      v.set_asString("");
+      v.set_isNull();
+      break;
+    }
+  }
+}
+
 bool SqliteDataset::query(const char *query) {
     if(!handle()) throw DbErrors("No Database Connection");
     std::string qry = query;
@@ -450,31 +479,7 @@ bool SqliteDataset::query(const char *query) {
   while (sqlite3_step(stmt) == SQLITE_ROW)
   { // have a row of data
     sql_record *res = new sql_record;
-    res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
-      {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
-        break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_NULL:
-      default:
-        v.set_asString("");
-        v.set_isNull();
-        break;
-      }
-    }
+    read_row(stmt, numColumns, *res);
     result.records.push_back(res);
   }
   if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
@@ -494,6 +499,49 @@ bool SqliteDataset::query(const string &q){
   return query(q.c_str());
 }
 
+bool SqliteDataset::query_rows(const char *query, row_callback callback, void *data) {
+    if(!handle()) throw DbErrors("No Database Connection");
+    std::string qry = query;
+    int fs = qry.find("select");
+    int fS = qry.find("SELECT");
+    if (!( fs >= 0 || fS >=0))                                 
+         throw DbErrors("MUST be select SQL!"); 
+
+  close();
+
+  sqlite3_stmt *stmt = NULL;
+#ifdef __APPLE__
+  if (db->setErr(sqlite3_prepare(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
+#else
+  if (db->setErr(sqlite3_prepare_v2(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
+#endif
+    throw DbErrors(db->getErrorMsg());
+
+  // the one record is reused for each row, so nothing grows with the size of the result
+  const unsigned int numColumns = sqlite3_column_count(stmt);
+  sql_record row;
+  bool stopped = false;
+  int ret;
+  while ((ret = sqlite3_step(stmt)) == SQLITE_ROW)
+  {
+    read_row(stmt, numColumns, row);
+    if (!callback(row, data))
+    {
+      stopped = true;
+      break;
+    }
+  }
+  if (!stopped && ret != SQLITE_DONE)
+  {
+    db->setErr(ret, query);
+    sqlite3_finalize(stmt);
+    throw DbErrors(db->getErrorMsg());
+  }
+  if (db->setErr(sqlite3_finalize(stmt),query) != SQLITE_OK && !stopped)
+    throw DbErrors(db->getErrorMsg());
+  return !stopped;
+}
+
 void SqliteDataset::open(const string &sql) {
 	set_select_sql(sql);
 	open();
@@ -104,6 +104,8 @@ protected:
   char* errmsg;
   
   sqlite3* handle();
+/* reads the columns of the current row of stmt */
+  static void read_row(sqlite3_stmt *stmt, unsigned int numColumns, sql_record &row);
 
 /* Makes direct queries to database */
   virtual void make_query(StringList &_sql);
@@ -144,6 +146,7 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+  virtual bool query_rows(const char *query, row_callback callback, void *data);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
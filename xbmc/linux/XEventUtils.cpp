@@ -22,6 +22,7 @@
 #include "system.h"
 #include "PlatformDefs.h"
 #include "XEventUtils.h"
+#include "XSyncUtils.h"
 
 HANDLE WINAPI CreateEvent(void *pDummySec, bool bManualReset, bool bInitialState, char *szDummyName)
 {
@@ -71,6 +72,8 @@ bool WINAPI SetEvent(HANDLE hEvent)
   }
   SDL_mutexV(hEvent->m_hMutex);
 
+  NotifyMultipleObjectWaiters();
+
   return true;
 }
 
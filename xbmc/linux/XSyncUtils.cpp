@@ -86,6 +86,7 @@ bool WINAPI ReleaseMutex( HANDLE hMutex ) {
     return false;
 
   BOOL bOk = false;
+  bool bReleased = false;
 
   SDL_mutexP(hMutex->m_hMutex);
   if (hMutex->OwningThread == SDL_ThreadID() && hMutex->RecursionCount > 0) {
@@ -93,10 +94,15 @@ bool WINAPI ReleaseMutex( HANDLE hMutex ) {
     if (--hMutex->RecursionCount == 0) {
       hMutex->OwningThread = 0;
       SDL_SemPost(hMutex->m_hSem);
+      bReleased = true;
     }
   }
   SDL_mutexV(hMutex->m_hMutex);
 
+  // the mutex is now signaled, wake anyone blocked in WaitForMultipleObjects on it
+  if (bReleased)
+    NotifyMultipleObjectWaiters();
+
   return bOk;
 }
 
@@ -169,7 +175,11 @@ DWORD WINAPI WaitForEvent(HANDLE hHandle, DWORD dwMilliseconds)
   if (dwMilliseconds == 0)
   {
     if (hHandle->m_bEventSet == true)
+    {
       nRet = 0;
+      if (hHandle->m_bManualEvent == false)
+        hHandle->m_bEventSet = false;
+    }
     else
       nRet = SDL_MUTEX_TIMEDOUT;
   }
@@ -259,6 +269,27 @@ DWORD WINAPI WaitForSingleObject( HANDLE hHandle, DWORD dwMilliseconds ) {
   return dwRet;
 }
 
+// WaitForMultipleObjects() callers register here and sleep on a single shared
+// condition, which NotifyMultipleObjectWaiters() broadcasts whenever a handle is
+// signalled.  The generation count tells a waiter whether anything was signalled
+// between checking its handles and going to sleep.
+static SDL_mutex *g_waitMutex = SDL_CreateMutex();
+static SDL_cond *g_waitCond = SDL_CreateCond();
+static DWORD g_waitGeneration = 0;
+static LONG g_waiters = 0;
+
+void NotifyMultipleObjectWaiters()
+{
+  // the common case - nobody is waiting on several handles
+  if (InterlockedCompareExchange(&g_waiters, 0, 0) == 0 || !g_waitMutex)
+    return;
+
+  SDL_mutexP(g_waitMutex);
+  g_waitGeneration++;
+  SDL_CondBroadcast(g_waitCond);
+  SDL_mutexV(g_waitMutex);
+}
+
 DWORD WINAPI WaitForMultipleObjects( DWORD nCount, HANDLE* lpHandles, BOOL bWaitAll,  DWORD dwMilliseconds) {
   DWORD dwRet = WAIT_FAILED;
 
@@ -272,13 +303,21 @@ DWORD WINAPI WaitForMultipleObjects( DWORD nCount, HANDLE* lpHandles, BOOL bWait
   for (unsigned int nFlag=0; nFlag<nCount; nFlag++ )
     bDone[nFlag] = FALSE;
 
+  // register before the first check, so that a handle signalled after we've
+  // looked at it is sure to wake us
+  InterlockedIncrement(&g_waiters);
+
   DWORD nSignalled = 0;
   while (!bWaitEnded) {
 
+    SDL_mutexP(g_waitMutex);
+    DWORD generation = g_waitGeneration;
+    SDL_mutexV(g_waitMutex);
+
     for (unsigned int i=0; i < nCount; i++) {
 
       if (!bDone[i]) {
-        DWORD dwWaitRC = WaitForSingleObject(lpHandles[i], 20);
+        DWORD dwWaitRC = WaitForSingleObject(lpHandles[i], 0);
         if (dwWaitRC == WAIT_OBJECT_0) {
           dwRet = WAIT_OBJECT_0 + i;
 
@@ -292,6 +331,7 @@ DWORD WINAPI WaitForMultipleObjects( DWORD nCount, HANDLE* lpHandles, BOOL bWait
           }
         }
         else if (dwWaitRC == WAIT_FAILED) {
+          dwRet = WAIT_FAILED;
           bWaitEnded = TRUE;
           break;
         }
@@ -299,43 +339,77 @@ DWORD WINAPI WaitForMultipleObjects( DWORD nCount, HANDLE* lpHandles, BOOL bWait
 
     }
 
+    if (bWaitEnded)
+      break;
+
     DWORD dwElapsed = SDL_GetTicks() - dwStartTime;
     if (dwMilliseconds != INFINITE && dwElapsed >= dwMilliseconds) {
       dwRet = WAIT_TIMEOUT;
-      bWaitEnded = TRUE;
       break;
     }
 
-    // wait 100ms between rounds
-    SDL_Delay(100);
+    // sleep until a handle is signalled, unless one already has been since we
+    // read the generation
+    SDL_mutexP(g_waitMutex);
+    if (generation == g_waitGeneration)
+    {
+      if (dwMilliseconds == INFINITE)
+        SDL_CondWait(g_waitCond, g_waitMutex);
+      else
+        SDL_CondWaitTimeout(g_waitCond, g_waitMutex, dwMilliseconds - dwElapsed);
+    }
+    SDL_mutexV(g_waitMutex);
   }
 
+  InterlockedDecrement(&g_waiters);
+
   delete [] bDone;
   return dwRet;
 }
 
+// Interlocked* map to the compiler's atomic builtins, which are full barriers
+// like their win32 counterparts.  Apple's gcc 4.0 doesn't have them, so use
+// libkern's there.  The global mutex is only left as a last resort.
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#define HAS_SYNC_BUILTINS
+#elif defined(__APPLE__)
+#include <libkern/OSAtomic.h>
+#endif
+
 LONG InterlockedIncrement(  LONG * Addend ) {
   if (Addend == NULL)
     return 0;
 
+#if defined(HAS_SYNC_BUILTINS)
+  return __sync_add_and_fetch(Addend, 1);
+#elif defined(__APPLE__) && !defined(__LP64__)
+  return OSAtomicIncrement32Barrier((int32_t *)Addend);
+#else
   SDL_mutexP(g_mutex);
   (* Addend)++;
   LONG nKeep = *Addend;
   SDL_mutexV(g_mutex);
 
   return nKeep;
+#endif
 }
 
 LONG InterlockedDecrement(  LONG * Addend ) {
   if (Addend == NULL)
     return 0;
 
+#if defined(HAS_SYNC_BUILTINS)
+  return __sync_sub_and_fetch(Addend, 1);
+#elif defined(__APPLE__) && !defined(__LP64__)
+  return OSAtomicDecrement32Barrier((int32_t *)Addend);
+#else
   SDL_mutexP(g_mutex);
   (* Addend)--;
   LONG nKeep = *Addend;
   SDL_mutexV(g_mutex);
 
   return nKeep;
+#endif
 }
 
 LONG InterlockedCompareExchange(
@@ -345,6 +419,21 @@ LONG InterlockedCompareExchange(
 ) {
   if (Destination == NULL)
     return 0;
+
+#if defined(HAS_SYNC_BUILTINS)
+  return __sync_val_compare_and_swap(Destination, Comparand, Exchange);
+#elif defined(__APPLE__) && !defined(__LP64__)
+  // OSAtomicCompareAndSwap32 only says whether it swapped, so retry until we
+  // either swap or see a value that doesn't match
+  for (;;)
+  {
+    LONG nKeep = *(volatile LONG *)Destination;
+    if (nKeep != Comparand)
+      return nKeep;
+    if (OSAtomicCompareAndSwap32Barrier(Comparand, Exchange, (int32_t *)Destination))
+      return nKeep;
+  }
+#else
   SDL_mutexP(g_mutex);
   LONG nKeep = *Destination;
   if (*Destination == Comparand)
@@ -352,6 +441,7 @@ LONG InterlockedCompareExchange(
   SDL_mutexV(g_mutex);
 
   return nKeep;
+#endif
 }
 
 LONG InterlockedExchange(
@@ -362,12 +452,51 @@ LONG InterlockedExchange(
   if (Target == NULL)
     return 0;
 
+#if defined(HAS_SYNC_BUILTINS) || (defined(__APPLE__) && !defined(__LP64__))
+  // __sync_lock_test_and_set is only an acquire barrier, so swap with CAS
+  LONG nKeep;
+  do
+  {
+    nKeep = *Target;
+  } while (InterlockedCompareExchange((LONG *)Target, Value, nKeep) != nKeep);
+
+  return nKeep;
+#else
   SDL_mutexP(g_mutex);
   LONG nKeep = *Target;
   *Target = Value;
   SDL_mutexV(g_mutex);
 
   return nKeep;
+#endif
+}
+
+PVOID InterlockedExchangePointer(
+  PVOID volatile* Target,
+  PVOID Value
+)
+{
+  if (Target == NULL)
+    return NULL;
+
+#if defined(HAS_SYNC_BUILTINS)
+  PVOID pKeep;
+  do
+  {
+    pKeep = *Target;
+  } while (__sync_val_compare_and_swap(Target, pKeep, Value) != pKeep);
+
+  return pKeep;
+#elif defined(__APPLE__) && !defined(__LP64__)
+  return (PVOID)InterlockedExchange((LONG volatile *)Target, (LONG)Value);
+#else
+  SDL_mutexP(g_mutex);
+  PVOID pKeep = *Target;
+  *Target = Value;
+  SDL_mutexV(g_mutex);
+
+  return pKeep;
+#endif
 }
 
 #endif
@@ -46,6 +46,10 @@ void GlobalMemoryStatus(LPMEMORYSTATUS lpBuffer);
 DWORD WINAPI WaitForSingleObject( HANDLE hHandle, DWORD dwMilliseconds );
 DWORD WINAPI WaitForMultipleObjects( DWORD nCount, HANDLE* lpHandles, BOOL bWaitAll,  DWORD dwMilliseconds);
 
+// wakes up any WaitForMultipleObjects() callers to check their handles again.
+// Must be called after anything a wait can be satisfied by is signalled.
+void NotifyMultipleObjectWaiters();
+
 LONG InterlockedIncrement(  LONG * Addend );
 LONG InterlockedDecrement(  LONG * Addend );
 LONG InterlockedCompareExchange(
@@ -59,6 +63,11 @@ LONG InterlockedExchange(
   LONG Value
 );
 
+PVOID InterlockedExchangePointer(
+  PVOID volatile* Target,
+  PVOID Value
+);
+
 int SDL_SemWaitTimeout2(SDL_sem *sem, Uint32 ms);
 
 #endif
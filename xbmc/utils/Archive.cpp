@@ -24,25 +24,41 @@
 #include "FileSystem/File.h"
 
 using namespace XFILE;
+using namespace std;
 
-#define BUFFER_MAX 4096
+#define READ_CHUNK_SIZE 65536
 
-CArchive::CArchive(CFile* pFile, int mode)
+static const char compactMagic[4] = { 'X', 'B', 'C', 'A' };
+
+CArchive::CArchive(CFile* pFile, int mode, Format format /* = legacy */)
 {
   m_pFile = pFile;
   m_iMode = mode;
-
-  m_pBuffer = new BYTE[BUFFER_MAX];
+  m_format = format;
+  m_failed = false;
   m_BufferPos = 0;
+
+  if (m_iMode == load)
+  {
+    FillBuffer();
+    if (m_format == compact)
+    {
+      char magic[4];
+      if (!ReadBytes(magic, sizeof(magic)) || memcmp(magic, compactMagic, sizeof(magic)) != 0 ||
+          ReadVarInt() != COMPACT_VERSION)
+        m_failed = true;
+    }
+  }
+  else if (m_format == compact)
+  {
+    WriteBytes(compactMagic, sizeof(compactMagic));
+    WriteVarInt(COMPACT_VERSION);
+  }
 }
 
 CArchive::~CArchive()
 {
   FlushBuffer();
-  if (m_pBuffer != NULL)
-    delete[] m_pBuffer;
-
-  m_BufferPos = 0;
 }
 
 void CArchive::Close()
@@ -60,159 +76,176 @@ bool CArchive::IsStoring()
   return (m_iMode == store);
 }
 
-CArchive& CArchive::operator<<(float f)
+void CArchive::WriteBytes(const void *data, unsigned int size)
 {
-  int size = sizeof(float);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
+  if (!size)
+    return;
+  const BYTE *bytes = (const BYTE *)data;
+  m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+}
 
-  memcpy(&m_pBuffer[m_BufferPos], &f, size);
+bool CArchive::ReadBytes(void *data, unsigned int size)
+{
+  if (m_failed || size > m_buffer.size() - m_BufferPos)
+  {
+    m_failed = true;
+    memset(data, 0, size);
+    return false;
+  }
+  if (size)
+    memcpy(data, &m_buffer[m_BufferPos], size);
   m_BufferPos += size;
+  return true;
+}
 
-  return *this;
+void CArchive::WriteVarInt(unsigned __int64 value)
+{
+  BYTE bytes[10];
+  unsigned int size = 0;
+  while (value >= 0x80)
+  {
+    bytes[size++] = (BYTE)(value | 0x80);
+    value >>= 7;
+  }
+  bytes[size++] = (BYTE)value;
+  WriteBytes(bytes, size);
 }
 
-CArchive& CArchive::operator<<(double d)
+unsigned __int64 CArchive::ReadVarInt()
 {
-  int size = sizeof(double);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
+  unsigned __int64 value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7)
+  {
+    if (m_failed || m_BufferPos >= m_buffer.size())
+    {
+      m_failed = true;
+      return 0;
+    }
+    BYTE b = m_buffer[m_BufferPos++];
+    value |= (unsigned __int64)(b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return value;
+  }
+  m_failed = true;
+  return 0;
+}
 
-  memcpy(&m_pBuffer[m_BufferPos], &d, size);
-  m_BufferPos += size;
+// zigzag encoding, so that small negative numbers are small varints too
+void CArchive::WriteSigned(__int64 value)
+{
+  WriteVarInt(((unsigned __int64)value << 1) ^ (unsigned __int64)(value >> 63));
+}
 
-  return *this;
+__int64 CArchive::ReadSigned()
+{
+  unsigned __int64 value = ReadVarInt();
+  return (__int64)(value >> 1) ^ -(__int64)(value & 1);
 }
 
-CArchive& CArchive::operator<<(int i)
+CArchive& CArchive::operator<<(float f)
 {
-  int size = sizeof(int);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
+  WriteBytes(&f, sizeof(float));
+  return *this;
+}
 
-  memcpy(&m_pBuffer[m_BufferPos], &i, size);
-  m_BufferPos += size;
+CArchive& CArchive::operator<<(double d)
+{
+  WriteBytes(&d, sizeof(double));
+  return *this;
+}
 
+CArchive& CArchive::operator<<(int i)
+{
+  if (m_format == compact)
+    WriteSigned(i);
+  else
+    WriteBytes(&i, sizeof(int));
   return *this;
 }
 
 CArchive& CArchive::operator<<(unsigned int i)
 {
-  int size = sizeof(unsigned int);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  memcpy(&m_pBuffer[m_BufferPos], &i, size);
-  m_BufferPos += size;
-
+  if (m_format == compact)
+    WriteVarInt(i);
+  else
+    WriteBytes(&i, sizeof(unsigned int));
   return *this;
 }
 
 CArchive& CArchive::operator<<(__int64 i64)
 {
-  int size = sizeof(__int64);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  memcpy(&m_pBuffer[m_BufferPos], &i64, size);
-  m_BufferPos += size;
-
+  if (m_format == compact)
+    WriteSigned(i64);
+  else
+    WriteBytes(&i64, sizeof(__int64));
   return *this;
 }
 
 CArchive& CArchive::operator<<(long l)
 {
-  int size = sizeof(long);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  memcpy(&m_pBuffer[m_BufferPos], &l, size);
-  m_BufferPos += size;
-
+  if (m_format == compact)
+    WriteSigned(l);
+  else
+    WriteBytes(&l, sizeof(long));
   return *this;
 }
 
 CArchive& CArchive::operator<<(bool b)
 {
-  int size = sizeof(bool);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  memcpy(&m_pBuffer[m_BufferPos], &b, size);
-  m_BufferPos += size;
-
+  WriteBytes(&b, sizeof(bool));
   return *this;
 }
 
 CArchive& CArchive::operator<<(char c)
 {
-  int size = sizeof(char);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  memcpy(&m_pBuffer[m_BufferPos], &c, size);
-  m_BufferPos += size;
-
+  WriteBytes(&c, sizeof(char));
   return *this;
 }
 
 CArchive& CArchive::operator<<(const CStdString& str)
 {
-  *this << str.GetLength();
-
-  int size = str.GetLength();
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  int iBufferMaxParts=size/BUFFER_MAX;
-  for (int i=0; i<iBufferMaxParts; i++)
+  if (m_format == compact)
   {
-    memcpy(&m_pBuffer[m_BufferPos], str.c_str()+(i*BUFFER_MAX), BUFFER_MAX);
-    m_BufferPos+=BUFFER_MAX;
-    FlushBuffer();
+    // odd values are references to a string stored earlier, even ones are
+    // followed by the string itself
+    unsigned int size = str.size();
+    if (size <= MAX_INTERN_LENGTH)
+    {
+      map<CStdString, unsigned int>::const_iterator it = m_storedStrings.find(str);
+      if (it != m_storedStrings.end())
+      {
+        WriteVarInt(((unsigned __int64)it->second << 1) | 1);
+        return *this;
+      }
+      m_storedStrings.insert(make_pair(str, (unsigned int)m_storedStrings.size()));
+    }
+    WriteVarInt((unsigned __int64)size << 1);
+    WriteBytes(str.c_str(), size);
+    return *this;
   }
 
-  int iPos=iBufferMaxParts*BUFFER_MAX;
-  int iSizeLeft=size-iPos;
-  memcpy(&m_pBuffer[m_BufferPos], str.c_str()+iPos, iSizeLeft);
-  m_BufferPos+=iSizeLeft;
-
+  *this << str.GetLength();
+  WriteBytes(str.c_str(), str.GetLength());
   return *this;
 }
 
 CArchive& CArchive::operator<<(const CStdStringW& str)
 {
-  *this << str.GetLength();
-
-  int size = str.GetLength();
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  int iBufferMaxParts=size/BUFFER_MAX;
-  for (int i=0; i<iBufferMaxParts; ++i)
+  if (m_format == compact)
   {
-    memcpy(&m_pBuffer[m_BufferPos], str.c_str()+(i*BUFFER_MAX), BUFFER_MAX);
-    m_BufferPos+=BUFFER_MAX;
-    FlushBuffer();
+    WriteVarInt(str.size());
+    WriteBytes(str.c_str(), str.size() * sizeof(wchar_t));
+    return *this;
   }
 
-  int iPos=iBufferMaxParts*BUFFER_MAX;
-  int iSizeLeft=size-iPos;
-  memcpy(&m_pBuffer[m_BufferPos], str.c_str()+iPos, iSizeLeft);
-  m_BufferPos+=iSizeLeft;
-
+  *this << str.GetLength();
+  WriteBytes(str.c_str(), str.GetLength());
   return *this;
 }
 
 CArchive& CArchive::operator<<(const SYSTEMTIME& time)
 {
-  int size = sizeof(SYSTEMTIME);
-  if (m_BufferPos + size >= BUFFER_MAX)
-    FlushBuffer();
-
-  memcpy(&m_pBuffer[m_BufferPos], &time, size);
-  m_BufferPos += size;
-
+  WriteBytes(&time, sizeof(SYSTEMTIME));
   return *this;
 }
 
@@ -225,88 +258,137 @@ CArchive& CArchive::operator<<(ISerializable& obj)
 
 CArchive& CArchive::operator>>(float& f)
 {
-  m_pFile->Read((void*)&f, sizeof(float));
-
+  ReadBytes(&f, sizeof(float));
   return *this;
 }
 
 CArchive& CArchive::operator>>(double& d)
 {
-  m_pFile->Read((void*)&d, sizeof(double));
-
+  ReadBytes(&d, sizeof(double));
   return *this;
 }
 
 CArchive& CArchive::operator>>(int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(int));
-
+  if (m_format == compact)
+    i = (int)ReadSigned();
+  else
+    ReadBytes(&i, sizeof(int));
   return *this;
 }
 
 CArchive& CArchive::operator>>(unsigned int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(unsigned int));
-
+  if (m_format == compact)
+    i = (unsigned int)ReadVarInt();
+  else
+    ReadBytes(&i, sizeof(unsigned int));
   return *this;
 }
 
 CArchive& CArchive::operator>>(__int64& i64)
 {
-  m_pFile->Read((void*)&i64, sizeof(__int64));
-
+  if (m_format == compact)
+    i64 = ReadSigned();
+  else
+    ReadBytes(&i64, sizeof(__int64));
   return *this;
 }
 
 CArchive& CArchive::operator>>(long& l)
 {
-  m_pFile->Read((void*)&l, sizeof(long));
-
+  if (m_format == compact)
+    l = (long)ReadSigned();
+  else
+    ReadBytes(&l, sizeof(long));
   return *this;
 }
 
 CArchive& CArchive::operator>>(bool& b)
 {
-  m_pFile->Read((void*)&b, sizeof(bool));
-
+  ReadBytes(&b, sizeof(bool));
   return *this;
 }
 
 CArchive& CArchive::operator>>(char& c)
 {
-  m_pFile->Read((void*)&c, sizeof(char));
-
+  ReadBytes(&c, sizeof(char));
   return *this;
 }
 
 CArchive& CArchive::operator>>(CStdString& str)
 {
-  int iLength = 0;
-  *this >> iLength;
+  unsigned int size;
+  if (m_format == compact)
+  {
+    unsigned __int64 value = ReadVarInt();
+    if (value & 1)
+    {
+      unsigned __int64 index = value >> 1;
+      if (index < m_loadedStrings.size())
+        str = m_loadedStrings[(unsigned int)index];
+      else
+      {
+        m_failed = true;
+        str.Empty();
+      }
+      return *this;
+    }
+    size = (unsigned int)(value >> 1);
+  }
+  else
+  {
+    int iLength = 0;
+    *this >> iLength;
+    size = (unsigned int)iLength;
+  }
 
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
-  str.ReleaseBuffer();
+  if (m_failed || size > m_buffer.size() - m_BufferPos)
+  {
+    m_failed = true;
+    str.Empty();
+    return *this;
+  }
+  if (size)
+    str.assign((const char *)&m_buffer[m_BufferPos], size);
+  else
+    str.Empty();
+  m_BufferPos += size;
 
+  if (m_format == compact && size <= MAX_INTERN_LENGTH)
+    m_loadedStrings.push_back(str);
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(CStdStringW& str)
 {
-  int iLength = 0;
-  *this >> iLength;
+  unsigned int size;
+  if (m_format == compact)
+    size = (unsigned int)ReadVarInt() * sizeof(wchar_t);
+  else
+  {
+    int iLength = 0;
+    *this >> iLength;
+    size = (unsigned int)iLength;
+  }
 
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
+  if (m_failed || size > m_buffer.size() - m_BufferPos)
+  {
+    m_failed = true;
+    str.Empty();
+    return *this;
+  }
+  // the legacy format only stores GetLength() bytes of a wide string
+  ReadBytes(str.GetBufferSetLength(m_format == compact ? size / sizeof(wchar_t) : size), size);
   str.ReleaseBuffer();
 
-
   return *this;
 }
 
 CArchive& CArchive::operator>>(SYSTEMTIME& time)
 {
-  m_pFile->Read((void*)&time, sizeof(SYSTEMTIME));
-
+  ReadBytes(&time, sizeof(SYSTEMTIME));
   return *this;
 }
 
@@ -319,9 +401,34 @@ CArchive& CArchive::operator>>(ISerializable& obj)
 
 void CArchive::FlushBuffer()
 {
-  if (m_BufferPos > 0)
+  if (m_iMode == store && m_buffer.size() > m_BufferPos)
   {
-    m_pFile->Write(m_pBuffer, m_BufferPos);
-    m_BufferPos = 0;
+    m_pFile->Write(&m_buffer[m_BufferPos], m_buffer.size() - m_BufferPos);
+    m_BufferPos = m_buffer.size();
   }
 }
+
+void CArchive::FillBuffer()
+{
+  __int64 length = m_pFile->GetLength();
+  if (length > 0)
+  { // read it all in one go
+    m_buffer.resize((unsigned int)length);
+    unsigned int total = 0;
+    while (total < m_buffer.size())
+    {
+      unsigned int read = m_pFile->Read(&m_buffer[total], m_buffer.size() - total);
+      if (read == 0)
+        break;
+      total += read;
+    }
+    m_buffer.resize(total);
+    return;
+  }
+
+  // unknown length
+  BYTE chunk[READ_CHUNK_SIZE];
+  unsigned int read;
+  while ((read = m_pFile->Read(chunk, READ_CHUNK_SIZE)) > 0)
+    m_buffer.insert(m_buffer.end(), chunk, chunk + read);
+}
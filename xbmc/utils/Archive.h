@@ -23,6 +23,9 @@
 
 #include "StdString.h"
 
+#include <map>
+#include <vector>
+
 namespace XFILE
 {
   class CFile;
@@ -37,10 +40,28 @@ public:
   virtual ~ISerializable() {}
 };
 
+/*!
+ \brief Binary (de)serialization of values and ISerializable objects to a CFile.
+
+ The archive is read from the file in one go when loading and written out in one
+ go on Close() when storing, so the per field operators only ever touch memory.
+
+ In the legacy format every value is stored as its raw bytes and strings as an
+ int length followed by the characters.  The compact format (used for the
+ directory caches) starts with a header and version, stores integers as varints
+ and interns strings, so that repeated paths, artists, albums, thumbs and so on
+ are only stored (and allocated on load) once.  A compact archive that doesn't
+ have the expected header or version, or that is truncated, fails to load - see
+ IsFailed().  COMPACT_VERSION must be bumped whenever the layout of anything
+ stored in the compact format changes.
+ */
 class CArchive
 {
 public:
-  CArchive(XFILE::CFile* pFile, int mode);
+  enum Mode {load = 0, store};
+  enum Format {legacy = 0, compact};
+
+  CArchive(XFILE::CFile* pFile, int mode, Format format = legacy);
   ~CArchive();
   // storing
   CArchive& operator<<(float f);
@@ -73,15 +94,39 @@ public:
   bool IsLoading();
   bool IsStoring();
 
+  /*! \brief true if loading ran past the end of the data, or the header or version
+   of a compact archive didn't match.  Values read after a failure are zero/empty.
+   */
+  bool IsFailed() const { return m_failed; }
+
+  /*! \brief size of the archive in bytes, so far when storing
+   */
+  unsigned int GetSize() const { return m_buffer.size(); }
+
   void Close();
 
-  enum Mode {load = 0, store};
+  static const unsigned int COMPACT_VERSION = 1;
 
 protected:
   void FlushBuffer();
+  void FillBuffer();
+  void WriteBytes(const void *data, unsigned int size);
+  bool ReadBytes(void *data, unsigned int size);
+  void WriteVarInt(unsigned __int64 value);
+  unsigned __int64 ReadVarInt();
+  void WriteSigned(__int64 value);
+  __int64 ReadSigned();
+
+  // strings no longer than this are interned in compact archives
+  static const unsigned int MAX_INTERN_LENGTH = 256;
+
   XFILE::CFile* m_pFile;
   int m_iMode;
-  LPBYTE m_pBuffer;
-  int m_BufferPos;
-};
+  Format m_format;
+  bool m_failed;
+  std::vector<BYTE> m_buffer;
+  unsigned int m_BufferPos;   // read position when loading
 
+  std::map<CStdString, unsigned int> m_storedStrings;  // string -> index, when storing
+  std::vector<CStdString> m_loadedStrings;             // index -> string, when loading
+};
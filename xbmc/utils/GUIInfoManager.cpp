@@ -58,6 +58,8 @@
 #include "VideoDatabase.h"
 #include "GUIWindowManager.h"
 #include "FileSystem/File.h"
+#include "FileSystem/FileStats.h"
+#include "GUIProfiler.h"
 #include "PlayList.h"
 #include "TuxBoxUtil.h"
 
@@ -414,6 +416,8 @@ int CGUIInfoManager::TranslateSingleString(const CStdString &strCondition)
       return AddMultiInfo(GUIInfo(SYSTEM_GET_CORE_USAGE, atoi(strTest.Mid(17,strTest.size()-18)), 0));
     else if (strTest.Left(17).Equals("system.hascoreid("))
       return AddMultiInfo(GUIInfo(bNegate ? -SYSTEM_HAS_CORE_ID : SYSTEM_HAS_CORE_ID, ConditionalStringParameter(strTest.Mid(17,strTest.size()-18)), 0));
+    else if (strTest.Left(17).Equals("system.filestats("))
+      return AddMultiInfo(GUIInfo(SYSTEM_FILE_STATS, atoi(strTest.Mid(17,strTest.size()-18)), 0));
   }
   // library test conditions
   else if (strTest.Left(7).Equals("library"))
@@ -1619,6 +1623,8 @@ bool CGUIInfoManager::GetBool(int condition1, DWORD dwContextWindow, const CGUIL
   if (!item && IsCached(condition1, dwContextWindow, bReturn)) // never use cache for list items
     return bReturn;
 
+  GUIPROFILER_SCOPE(CGUIProfiler::PROFILE_INFOBOOL, "infobool", condition1)
+
   int condition = abs(condition1);
 
   if(condition >= COMBINED_VALUES_START && (condition - COMBINED_VALUES_START) < (int)(m_CombinedValues.size()) )
@@ -2354,6 +2360,11 @@ CStdString CGUIInfoManager::GetMultiInfoLabel(const GUIInfo &info, DWORD context
     strCpu.Format("%4.2f", g_cpuInfo.GetCoreInfo(info.GetData1()).m_fPct);
     return strCpu;
   }
+  else if (info.m_info == SYSTEM_FILE_STATS)
+  {
+    if (info.GetData1() > 0)
+      return g_fileStats.GetSummary(info.GetData1() - 1);
+  }
   else if (info.m_info >= MUSICPLAYER_TITLE && info.m_info <= MUSICPLAYER_DISC_NUMBER)
     return GetMusicPlaylistInfo(info);
   else if (info.m_info == CONTAINER_PROPERTY)
@@ -370,6 +370,7 @@ class CDateTime;
 #define SYSTEM_GET_BOOL             704
 #define SYSTEM_GET_CORE_USAGE       705
 #define SYSTEM_HAS_CORE_ID          706
+#define SYSTEM_FILE_STATS           707
 
 #define LIBRARY_HAS_MUSIC           720
 #define LIBRARY_HAS_VIDEO           721
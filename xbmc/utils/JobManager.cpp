@@ -0,0 +1,292 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "JobManager.h"
+#include "SingleLock.h"
+#include "CPUInfo.h"
+
+using namespace std;
+
+CJobManager g_jobManager;
+
+CJobToken::CJobToken()
+{
+  m_cancelled = false;
+  m_running = 0;
+}
+
+void CJobToken::Cancel(bool wait /* = true */)
+{
+  CSingleLock lock(m_lock);
+  m_cancelled = true;
+  while (wait && m_running)
+  {
+    lock.Leave();
+    m_idleEvent.WaitMSec(100);
+    lock.Enter();
+  }
+}
+
+// called before a job runs - false if it should be skipped
+bool CJobToken::BeginJob()
+{
+  CSingleLock lock(m_lock);
+  if (m_cancelled)
+    return false;
+  m_running++;
+  return true;
+}
+
+void CJobToken::EndJob()
+{
+  CSingleLock lock(m_lock);
+  if (--m_running == 0)
+    m_idleEvent.Set();
+}
+
+CJob::CJob()
+{
+  m_blockers = 0;
+  m_finished = false;
+  m_priority = CJobManager::PRIORITY_LOW;
+}
+
+void CJob::AddDependency(const CJobPtr &job)
+{
+  m_dependencies.push_back(job);
+}
+
+CJobManager::CWorker::CWorker(CJobManager *manager, unsigned int index)
+{
+  m_manager = manager;
+  m_index = index;
+}
+
+void CJobManager::CWorker::Process()
+{
+  while (!m_bStop)
+  {
+    CJobPtr job;
+    if (m_manager->GetJob(this, job))
+      m_manager->RunJob(job);
+    else
+      m_manager->m_jobEvent.WaitMSec(1000);
+  }
+}
+
+CJobManager::CJobManager()
+{
+  m_queuedJobs = 0;
+  m_stop = false;
+}
+
+CJobManager::~CJobManager()
+{
+  Stop();
+}
+
+// must be called with m_lock held
+void CJobManager::StartWorkers()
+{
+  int workers = g_cpuInfo.getCPUCount() * 2;
+  if (workers < 4)
+    workers = 4;
+  if (workers > 16)
+    workers = 16;
+
+  for (int i = 0; i < workers; i++)
+  {
+    CWorker *worker = new CWorker(this, i);
+    m_workers.push_back(worker);
+  }
+  // start them once they're all in the list, as they steal from each other
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    m_workers[i]->Create();
+    m_workers[i]->SetName("JobManager worker");
+    // everything run here is background work, which shouldn't hold up the GUI
+    m_workers[i]->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
+  }
+  CLog::Log(LOGDEBUG, "%s - started %i workers", __FUNCTION__, workers);
+}
+
+void CJobManager::Stop()
+{
+  vector<CWorker *> workers;
+  {
+    CSingleLock lock(m_lock);
+    m_stop = true;
+    workers = m_workers;
+  }
+  for (unsigned int i = 0; i < workers.size(); i++)
+  {
+    m_jobEvent.Set();
+    workers[i]->StopThread();
+  }
+
+  CSingleLock lock(m_lock);
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+    delete m_workers[i];
+  m_workers.clear();
+  for (unsigned int i = 0; i < PRIORITY_COUNT; i++)
+    m_jobs[i].clear();
+}
+
+void CJobManager::Submit(const CJobPtr &job, PRIORITY priority /* = PRIORITY_LOW */, const CJobTokenPtr &token /* = CJobTokenPtr() */)
+{
+  job->m_priority = priority;
+  job->m_token = token;
+  job->m_blockers = 1;
+
+  for (unsigned int i = 0; i < job->m_dependencies.size(); i++)
+  {
+    CJob *dependency = job->m_dependencies[i].get();
+    CSingleLock lock(dependency->m_lock);
+    if (!dependency->m_finished)
+    {
+      InterlockedIncrement(&job->m_blockers);
+      dependency->m_dependents.push_back(job);
+    }
+  }
+  job->m_dependencies.clear();
+
+  if (InterlockedDecrement(&job->m_blockers) == 0)
+    Queue(job);
+}
+
+CJobManager::CWorker *CJobManager::GetCurrentWorker()
+{
+  DWORD threadId = GetCurrentThreadId();
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    if (m_workers[i]->ThreadId() == threadId)
+      return m_workers[i];
+  }
+  return NULL;
+}
+
+void CJobManager::Queue(const CJobPtr &job)
+{
+  CSingleLock lock(m_lock);
+  if (m_stop)
+    return;
+  if (m_workers.empty())
+    StartWorkers();
+
+  // count it first, so that the count is never less than the jobs queued
+  InterlockedIncrement(&m_queuedJobs);
+  CWorker *worker = GetCurrentWorker();
+  if (worker)
+  {
+    CSingleLock workerLock(worker->m_lock);
+    worker->m_jobs[job->m_priority].push_back(job);
+  }
+  else
+    m_jobs[job->m_priority].push_back(job);
+  lock.Leave();
+
+  m_jobEvent.Set();
+}
+
+bool CJobManager::GetJob(CWorker *worker, CJobPtr &job)
+{
+  if (InterlockedCompareExchange(&m_queuedJobs, 0, 0) <= 0)
+    return false;
+
+  unsigned int workers = m_workers.size();
+  for (unsigned int priority = 0; priority < PRIORITY_COUNT && !job; priority++)
+  {
+    // our own work, most recent first
+    {
+      CSingleLock lock(worker->m_lock);
+      deque<CJobPtr> &jobs = worker->m_jobs[priority];
+      if (!jobs.empty())
+      {
+        job = jobs.back();
+        jobs.pop_back();
+        break;
+      }
+    }
+    // then work from outside the pool
+    {
+      CSingleLock lock(m_lock);
+      deque<CJobPtr> &jobs = m_jobs[priority];
+      if (!jobs.empty())
+      {
+        job = jobs.front();
+        jobs.pop_front();
+        break;
+      }
+    }
+    // then steal the oldest work from the others
+    for (unsigned int i = 1; i < workers && !job; i++)
+    {
+      CWorker *victim = m_workers[(worker->GetIndex() + i) % workers];
+      CSingleLock lock(victim->m_lock);
+      deque<CJobPtr> &jobs = victim->m_jobs[priority];
+      if (!jobs.empty())
+      {
+        job = jobs.front();
+        jobs.pop_front();
+      }
+    }
+  }
+  if (!job)
+    return false;
+
+  // the event only wakes one worker, so pass it on if there's more to do
+  if (InterlockedDecrement(&m_queuedJobs) > 0)
+    m_jobEvent.Set();
+  return true;
+}
+
+void CJobManager::RunJob(const CJobPtr &job)
+{
+  CJobToken *token = job->m_token.get();
+  if (!token || token->BeginJob())
+  {
+    try
+    {
+      job->DoWork();
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s - unhandled exception in job", __FUNCTION__);
+    }
+    if (token)
+      token->EndJob();
+  }
+
+  // release anything that was waiting on this job.  Jobs that depend on a
+  // cancelled job still run (unless they share its token).
+  vector<CJobPtr> dependents;
+  {
+    CSingleLock lock(job->m_lock);
+    job->m_finished = true;
+    dependents.swap(job->m_dependents);
+  }
+  for (unsigned int i = 0; i < dependents.size(); i++)
+  {
+    if (InterlockedDecrement(&dependents[i]->m_blockers) == 0)
+      Queue(dependents[i]);
+  }
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "Thread.h"
+#include "CriticalSection.h"
+
+#include <deque>
+#include <vector>
+#include "boost/shared_ptr.hpp"
+
+class CJob;
+typedef boost::shared_ptr<CJob> CJobPtr;
+
+/*!
+ \brief Cancellation token shared by a group of jobs.
+
+ Jobs submitted with a token are skipped if they haven't started by the time the
+ token is cancelled.  Cancel() can also wait for those that are already running,
+ after which none of the group's jobs will touch their owner again.
+ */
+class CJobToken
+{
+public:
+  CJobToken();
+
+  void Cancel(bool wait = true);
+  bool IsCancelled() const { return m_cancelled; }
+
+private:
+  friend class CJobManager;
+  bool BeginJob();
+  void EndJob();
+
+  CCriticalSection m_lock;
+  CEvent m_idleEvent;
+  volatile bool m_cancelled;
+  unsigned int m_running;
+};
+typedef boost::shared_ptr<CJobToken> CJobTokenPtr;
+
+class CJob
+{
+public:
+  CJob();
+  virtual ~CJob() {}
+  virtual void DoWork() = 0;
+
+  /*! \brief Don't start this job until job has finished.  Must be called before submitting.
+   */
+  void AddDependency(const CJobPtr &job);
+
+  /*! \brief true once the job's token has been cancelled.  Long jobs should check this now and then.
+   */
+  bool IsCancelled() const { return m_token && m_token->IsCancelled(); }
+
+private:
+  friend class CJobManager;
+  CCriticalSection m_lock;
+  LONG m_blockers;                       // unfinished dependencies, plus one until submitted
+  bool m_finished;
+  std::vector<CJobPtr> m_dependencies;   // until submitted
+  std::vector<CJobPtr> m_dependents;     // jobs waiting for this one
+  CJobTokenPtr m_token;
+  int m_priority;
+};
+
+/*!
+ \brief Runs an IRunnable as a job, for code written against CThread(IRunnable*)
+ */
+class CRunnableJob : public CJob
+{
+public:
+  CRunnableJob(IRunnable *runnable) : m_runnable(runnable) {}
+  virtual void DoWork() { m_runnable->Run(); }
+private:
+  IRunnable *m_runnable;
+};
+
+/*!
+ \brief Process wide pool of worker threads for short background jobs.
+
+ Rather than each loader creating threads on demand, jobs are submitted here and
+ run by a fixed set of workers, sized to the number of cores (with some slack, as
+ most jobs spend their time waiting on disk or network).  Each worker has its own
+ deque per priority.  Jobs submitted from a worker go on the back of its own deque
+ and it takes from the back, so related work stays on one thread.  Jobs from other
+ threads go on a shared queue.  An idle worker takes from the shared queue, then
+ steals from the front of the other workers' deques.  Higher priority jobs (for
+ things on screen) are always taken before lower priority ones.
+
+ Long running services (scanners, the file cache, players, the video thumb extractor)
+ still own their threads, as they'd tie up workers needed by jobs for what's on screen.
+ */
+class CJobManager
+{
+public:
+  enum PRIORITY { PRIORITY_HIGH = 0, ///< needed for what's on screen
+                  PRIORITY_LOW,      ///< background work
+                  PRIORITY_COUNT };
+
+  CJobManager();
+  ~CJobManager();
+
+  /*! \brief Queue job to run once its dependencies have finished.
+   \param token optional token to cancel the job with
+   */
+  void Submit(const CJobPtr &job, PRIORITY priority = PRIORITY_LOW, const CJobTokenPtr &token = CJobTokenPtr());
+
+  /*! \brief Stop the workers.  Jobs still queued are dropped and later submissions are ignored.
+   */
+  void Stop();
+
+private:
+  class CWorker : public CThread
+  {
+  public:
+    CWorker(CJobManager *manager, unsigned int index);
+    unsigned int GetIndex() const { return m_index; }
+  protected:
+    virtual void Process();
+  private:
+    friend class CJobManager;
+    CJobManager *m_manager;
+    unsigned int m_index;
+    CCriticalSection m_lock;
+    std::deque<CJobPtr> m_jobs[PRIORITY_COUNT];
+  };
+
+  void StartWorkers();
+  void Queue(const CJobPtr &job);
+  bool GetJob(CWorker *worker, CJobPtr &job);
+  void RunJob(const CJobPtr &job);
+  CWorker *GetCurrentWorker();
+
+  CCriticalSection m_lock;
+  std::deque<CJobPtr> m_jobs[PRIORITY_COUNT];   // jobs submitted from outside the pool
+  std::vector<CWorker *> m_workers;
+  CEvent m_jobEvent;
+  LONG m_queuedJobs;
+  bool m_stop;
+};
+
+extern CJobManager g_jobManager;
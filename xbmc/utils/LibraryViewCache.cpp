@@ -0,0 +1,172 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "LibraryViewCache.h"
+#include "SingleLock.h"
+#include "Application.h"
+#include "Util.h"
+#include "FileItem.h"
+#include "FileSystem/Directory.h"
+#include "GUIWindowManager.h"
+#include "GUIDialogMusicScan.h"
+#include "GUIDialogVideoScan.h"
+
+using namespace DIRECTORY;
+
+CLibraryViewCache g_libraryViewCache;
+
+// the views that are slow to build on a large library.  Anything else is either
+// quick enough to query or too specific to be worth keeping around.
+static const char *musicViews[] = {
+  "musicdb://1/",     // genres
+  "musicdb://2/",     // artists
+  "musicdb://3/",     // albums
+  "musicdb://4/",     // songs
+  "musicdb://6/",     // recently added albums
+  "musicdb://9/",     // years
+  NULL
+};
+
+static const char *videoViews[] = {
+  "videodb://1/1/",   // movies by genre
+  "videodb://1/2/",   // movie titles
+  "videodb://1/3/",   // movies by year
+  "videodb://2/2/",   // tv show titles
+  "videodb://4/",     // recently added movies
+  "videodb://5/",     // recently added episodes
+  NULL
+};
+
+CLibraryViewCache::CLibraryViewCache()
+{
+  m_music = false;
+  m_video = false;
+  m_changed = 0;
+}
+
+void CLibraryViewCache::Invalidate(const CStdString &library)
+{
+  CSingleLock lock(m_critSection);
+  if (library.Equals("mdb"))
+    m_music = true;
+  else if (library.Equals("vdb"))
+    m_video = true;
+  else
+    return;
+  m_changed = timeGetTime();
+
+  if (!m_ThreadHandle && !m_bStop)
+  {
+    Create();
+    SetName("LibraryViewCache");
+  }
+  m_event.Set();
+}
+
+void CLibraryViewCache::Stop()
+{
+  { // m_bStop stays set after the thread exits, so it won't be started again
+    // if a library is changed while shutting down
+    CSingleLock lock(m_critSection);
+    m_bStop = true;
+  }
+  m_event.Set();
+  StopThread();
+}
+
+bool CLibraryViewCache::IsScanning() const
+{
+  CGUIDialogMusicScan *musicScan = (CGUIDialogMusicScan *)m_gWindowManager.GetWindow(WINDOW_DIALOG_MUSIC_SCAN);
+  if (musicScan && musicScan->IsScanning())
+    return true;
+  CGUIDialogVideoScan *videoScan = (CGUIDialogVideoScan *)m_gWindowManager.GetWindow(WINDOW_DIALOG_VIDEO_SCAN);
+  if (videoScan && videoScan->IsScanning())
+    return true;
+  return false;
+}
+
+void CLibraryViewCache::Process()
+{
+  SetPriority(THREAD_PRIORITY_LOWEST);
+
+  while (!m_bStop)
+  {
+    m_event.WaitMSec(SETTLE_TIME);
+    if (m_bStop)
+      break;
+
+    // wait until the library has been left alone for a while, and don't get in
+    // the way of a scan (it'll invalidate everything again when it's done) or of
+    // video playback.
+    bool music, video;
+    {
+      CSingleLock lock(m_critSection);
+      if (!m_music && !m_video)
+        continue;
+      if (timeGetTime() - m_changed < SETTLE_TIME)
+        continue;
+      if (IsScanning() || g_application.IsPlayingVideo())
+        continue;
+      music = m_music;
+      video = m_video;
+      m_music = m_video = false;
+    }
+
+    if (music)
+      Rebuild(musicViews);
+    if (video)
+      Rebuild(videoViews);
+  }
+}
+
+void CLibraryViewCache::Rebuild(const char **paths)
+{
+  for (unsigned int i = 0; paths[i] && !m_bStop; i++)
+  {
+    CFileItemList items(paths[i]);
+    if (items.HasDiscCache())
+      continue; // already cached by the GUI
+
+    DWORD updateID = CUtil::GetLibraryUpdateID();
+    DWORD time = timeGetTime();
+    if (!CDirectory::GetDirectory(paths[i], items))
+      continue;
+
+    // the library changed while we were fetching, so this listing may already
+    // be stale - it'll be picked up on the next pass.
+    if (updateID != CUtil::GetLibraryUpdateID())
+      break;
+
+    if (!items.Save())
+      continue;
+
+    // and it may have changed (and its cache been deleted) between that check and
+    // the save, in which case ours is stale.  Any change after this point bumps the
+    // id before it deletes the caches, so it takes ours with it.
+    if (updateID != CUtil::GetLibraryUpdateID())
+    {
+      items.RemoveDiscCache();
+      break;
+    }
+    CLog::Log(LOGDEBUG, "%s - cached %s (%i items) in %lu ms", __FUNCTION__, paths[i], items.Size(), timeGetTime() - time);
+  }
+}
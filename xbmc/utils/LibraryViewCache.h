@@ -0,0 +1,67 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "Thread.h"
+#include "CriticalSection.h"
+
+/*!
+ \brief Rebuilds the disc cache of the expensive library views in the background.
+
+ Listings such as all songs, all albums or movies by genre are read from the
+ database every time they're opened, which on a large library takes seconds.
+ Whenever a library is changed (CUtil::DeleteMusicDatabaseDirectoryCache and
+ CUtil::DeleteVideoDatabaseDirectoryCache) its cached listings are deleted, and
+ this thread is asked to rebuild the listings of that library only.  It waits
+ for things to settle down (and for any scan to finish), then fetches each view
+ at low priority and saves it with CFileItemList::Save, so that
+ CGUIMediaWindow::GetDirectory finds it in the disc cache the next time it's
+ opened.
+ */
+class CLibraryViewCache : public CThread
+{
+public:
+  CLibraryViewCache();
+
+  /*! \brief The views of a library are out of date and should be rebuilt
+   \param library "mdb" or "vdb", as passed to CUtil::DeleteDirectoryCache
+   */
+  void Invalidate(const CStdString &library);
+  void Stop();
+
+protected:
+  virtual void Process();
+
+private:
+  bool IsScanning() const;
+  void Rebuild(const char **paths);
+
+  static const DWORD SETTLE_TIME = 10000;
+
+  CCriticalSection m_critSection;
+  CEvent m_event;
+  bool m_music;       // music views need rebuilding
+  bool m_video;       // video views need rebuilding
+  DWORD m_changed;    // time of the last invalidation
+};
+
+extern CLibraryViewCache g_libraryViewCache;
@@ -0,0 +1,107 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "RandomSampler.h"
+#include "SingleLock.h"
+
+using namespace std;
+
+CRandomSampler g_randomSampler;
+
+CRandomSampler::CRandomSampler()
+{
+}
+
+// rand() may only give 15 bits, which isn't enough for a large library
+unsigned int CRandomSampler::Random(unsigned int range)
+{
+  unsigned int r = ((unsigned int)rand() << 15) ^ (unsigned int)rand();
+  r = (r << 15) ^ (unsigned int)rand();
+  return r % range;
+}
+
+bool CRandomSampler::Sample(const CStdString &key, unsigned int count, const set<long> &exclude, vector<long> &ids)
+{
+  CSingleLock lock(m_critSection);
+  map<CStdString, CPool>::iterator it = m_pools.find(key);
+  if (it == m_pools.end())
+    return false;
+
+  CPool &pool = it->second;
+  DWORD now = timeGetTime();
+  if (now - pool.created > POOL_LIFETIME)
+  {
+    m_pools.erase(it);
+    return false;
+  }
+  pool.lastUsed = now;
+
+  // partial Fisher-Yates - the chosen ids are swapped to the front of the array.
+  // The array is still a permutation of the same ids afterwards, so it can be
+  // reused as is for the next draw.
+  ids.clear();
+  vector<long> &pick = pool.ids;
+  unsigned int size = pick.size();
+  if (!count)
+    count = size;
+  for (unsigned int i = 0; i < size && ids.size() < count; i++)
+  {
+    unsigned int j = i + Random(size - i);
+    long id = pick[j];
+    pick[j] = pick[i];
+    pick[i] = id;
+    if (exclude.find(id) == exclude.end())
+      ids.push_back(id);
+  }
+  return true;
+}
+
+void CRandomSampler::SetPool(const CStdString &key, const vector<long> &ids)
+{
+  CSingleLock lock(m_critSection);
+  if (m_pools.size() >= MAX_POOLS && m_pools.find(key) == m_pools.end())
+  { // evict the least recently used pool
+    map<CStdString, CPool>::iterator oldest = m_pools.begin();
+    for (map<CStdString, CPool>::iterator it = m_pools.begin(); it != m_pools.end(); ++it)
+    {
+      if (it->second.lastUsed < oldest->second.lastUsed)
+        oldest = it;
+    }
+    m_pools.erase(oldest);
+  }
+  CPool &pool = m_pools[key];
+  pool.ids = ids;
+  pool.created = pool.lastUsed = timeGetTime();
+}
+
+void CRandomSampler::Invalidate(const CStdString &library)
+{
+  CSingleLock lock(m_critSection);
+  map<CStdString, CPool>::iterator it = m_pools.begin();
+  while (it != m_pools.end())
+  {
+    if (it->first.Left(library.size()) == library)
+      m_pools.erase(it++);
+    else
+      ++it;
+  }
+}
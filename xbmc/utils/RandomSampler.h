@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "CriticalSection.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+/*!
+ \brief Random selection of library items without going back to the database.
+
+ Keeps the ids of the items matching a query (eg "songs:" + where clause) in a
+ plain array, so that k distinct items can be drawn in O(k) with a partial
+ Fisher-Yates shuffle instead of an "order by random()" or "limit 1 offset n"
+ query per item.  Pools for a library are dropped whenever the library is
+ changed, and in any case after POOL_LIFETIME ms, so that filters on play
+ counts and the like don't go stale for long.
+ */
+class CRandomSampler
+{
+public:
+  CRandomSampler();
+
+  /*! \brief Draw up to count ids (all of them if count is 0) from the pool for key.
+   \param exclude ids that shouldn't be drawn (eg recently played)
+   \return false if there is no pool for key, in which case the caller should fetch
+           the ids and call SetPool.
+   */
+  bool Sample(const CStdString &key, unsigned int count, const std::set<long> &exclude, std::vector<long> &ids);
+  void SetPool(const CStdString &key, const std::vector<long> &ids);
+
+  /*! \brief Drop all pools whose key starts with library, eg "songs:"
+   */
+  void Invalidate(const CStdString &library);
+
+private:
+  struct CPool
+  {
+    std::vector<long> ids;
+    DWORD created;
+    DWORD lastUsed;
+  };
+
+  static unsigned int Random(unsigned int range);
+
+  static const unsigned int MAX_POOLS = 8;
+  static const DWORD POOL_LIFETIME = 10 * 60 * 1000;
+
+  std::map<CStdString, CPool> m_pools;
+  CCriticalSection m_critSection;
+};
+
+extern CRandomSampler g_randomSampler;
@@ -25,6 +25,7 @@
 #include <share.h>
 #endif
 #include "CriticalSection.h"
+#include "Thread.h"
 #include "SingleLock.h"
 #include "StdString.h"
 #include "Settings.h"
@@ -37,6 +38,96 @@ static CCriticalSection critSec;
 static char levelNames[][8] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
+/*
+ Log() only formats the line (on the caller's stack) and pushes it onto an
+ intrusive multi-producer, single-consumer queue, which never blocks the
+ caller.  The writer thread drains the queue every WRITE_INTERVAL ms (or as
+ soon as an error is logged) and does the prefix, the memory statistic and
+ the file I/O.  Anything SEVERE or worse is written out by the caller before
+ Log() returns, in case we're about to go down, as is everything once the log
+ has been closed.
+ */
+struct LogRecord
+{
+  LogRecord * volatile next;
+  time_t time;
+  DWORD threadId;
+  int level;
+  unsigned int length;
+  char text[1];          // length + 1 bytes
+};
+
+static const DWORD WRITE_INTERVAL = 250;
+
+static LogRecord logStub;                       // always in the queue, so it's never empty
+static LogRecord * volatile logHead = &logStub; // producers push here
+static LogRecord *logTail = &logStub;           // the consumer pops here, with writeSec held
+static CCriticalSection writeSec;
+
+enum { WRITER_NONE = 0, WRITER_RUNNING, WRITER_CLOSED };
+static LONG writerState = WRITER_NONE;
+
+static void PushRecord(LogRecord *record)
+{
+  record->next = NULL;
+  LogRecord *prev = (LogRecord *)InterlockedExchangePointer((PVOID volatile *)&logHead, record);
+  prev->next = record;
+}
+
+// must be called with writeSec held.  Returns NULL if the queue is empty, or
+// if a producer is halfway through pushing the next record.
+static LogRecord *PopRecord()
+{
+  LogRecord *tail = logTail;
+  LogRecord *next = tail->next;
+  if (tail == &logStub)
+  {
+    if (!next)
+      return NULL;
+    logTail = tail = next;
+    next = next->next;
+  }
+  if (next)
+  {
+    logTail = next;
+    return tail;
+  }
+  if (tail != logHead)
+    return NULL;
+  PushRecord(&logStub);
+  next = tail->next;
+  if (next)
+  {
+    logTail = next;
+    return tail;
+  }
+  return NULL;
+}
+
+class CLogWriter : public CThread
+{
+public:
+  void Wake() { m_event.Set(); }
+  void Stop()
+  {
+    m_bStop = true;
+    m_event.Set();
+    StopThread();
+  }
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      m_event.WaitMSec(WRITE_INTERVAL);
+      CLog::WriteQueued();
+    }
+  }
+private:
+  CEvent m_event;
+};
+
+static CLogWriter *logWriter = NULL;
 
 CLog::CLog()
 {}
@@ -46,7 +137,12 @@ CLog::~CLog()
 
 void CLog::Close()
 {
-  CSingleLock waitLock(critSec);
+  // from here on everything is written synchronously
+  if (InterlockedExchange(&writerState, WRITER_CLOSED) == WRITER_RUNNING && logWriter)
+    logWriter->Stop();
+
+  CSingleLock waitLock(writeSec);
+  WriteQueued();
   if (fd)
   {
     fclose(fd);
@@ -54,87 +150,145 @@ void CLog::Close()
   }
 }
 
-
-void CLog::Log(int loglevel, const char *format, ... )
+bool CLog::OpenLogFile()
 {
-  if (g_advancedSettings.m_logLevel > LOG_LEVEL_NORMAL ||
-     (g_advancedSettings.m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE))
-  {
-    CSingleLock waitLock(critSec);
-    if (!fd)
-    {
-      // g_stSettings.m_logFolder is initialized in the CSettings constructor to Q:
-      // and if we are running from DVD, it's changed to T: in CApplication::Create()
-      CStdString strLogFile, strLogFileOld;
+  // g_stSettings.m_logFolder is initialized in the CSettings constructor to Q:
+  // and if we are running from DVD, it's changed to T: in CApplication::Create()
+  CStdString strLogFile, strLogFileOld;
 
 #ifdef __APPLE__
-      strLogFile.Format("%sPlex.log", _P(g_stSettings.m_logFolder).c_str());
-      strLogFileOld.Format("%sPlex.old.log", _P(g_stSettings.m_logFolder).c_str());
+  strLogFile.Format("%sPlex.log", _P(g_stSettings.m_logFolder).c_str());
+  strLogFileOld.Format("%sPlex.old.log", _P(g_stSettings.m_logFolder).c_str());
 #else
-      strLogFile.Format("%sxbmc.log", _P(g_stSettings.m_logFolder).c_str());
-      strLogFileOld.Format("%sxbmc.old.log", _P(g_stSettings.m_logFolder).c_str());
+  strLogFile.Format("%sxbmc.log", _P(g_stSettings.m_logFolder).c_str());
+  strLogFileOld.Format("%sxbmc.old.log", _P(g_stSettings.m_logFolder).c_str());
 #endif
 
+  // only keep the log from the previous run, not whatever was logged before a Close()
+  static bool rotated = false;
+  if (!rotated)
+  {
 #ifndef _LINUX
-      ::DeleteFile(strLogFileOld.c_str());
-      ::MoveFile(strLogFile.c_str(), strLogFileOld.c_str());
+    ::DeleteFile(strLogFileOld.c_str());
+    ::MoveFile(strLogFile.c_str(), strLogFileOld.c_str());
 #else
-      ::unlink(strLogFileOld.c_str());
-      ::rename(strLogFile.c_str(), strLogFileOld.c_str());
+    ::unlink(strLogFileOld.c_str());
+    ::rename(strLogFile.c_str(), strLogFileOld.c_str());
 #endif
+    rotated = true;
+  }
 
 #ifndef _LINUX
-      fd = _fsopen(strLogFile, "a+", _SH_DENYWR);
+  fd = _fsopen(strLogFile, "a+", _SH_DENYWR);
 #else
-      fd = fopen(strLogFile, "a+");
+  fd = fopen(strLogFile, "a+");
 #endif
-    }
-
-    if (!fd)
-      return ;
+  return fd != NULL;
+}
 
-    SYSTEMTIME time;
-    GetLocalTime(&time);
+// Write out everything that's been queued.  writeSec makes sure only one thread
+// at a time is popping records.
+void CLog::WriteQueued()
+{
+  CSingleLock waitLock(writeSec);
 
-    MEMORYSTATUS stat;
-    GlobalMemoryStatus(&stat);
+  // the clock and the free memory are only looked up once a second
+  static time_t lastTime = 0;
+  static struct tm localTime;
+  static MEMORYSTATUS stat;
 
-    CStdString strPrefix, strData;
+  LogRecord *record;
+  bool wrote = false;
+  while ((record = PopRecord()) != NULL)
+  {
+    if (fd || OpenLogFile())
+    {
+      if (record->time != lastTime)
+      {
+        lastTime = record->time;
+#ifdef _LINUX
+        localtime_r(&lastTime, &localTime);
+#else
+        localTime = *localtime(&lastTime);
+#endif
+        GlobalMemoryStatus(&stat);
+      }
 
+      CStdString strPrefix, strData(record->text, record->length);
 #ifdef __APPLE__
-    strPrefix.Format("%02.2d:%02.2d:%02.2d T:%lu M:%9ju %7s: ", time.wHour, time.wMinute, time.wSecond, GetCurrentThreadId(), stat.dwAvailPhys, levelNames[loglevel]);
+      strPrefix.Format("%02.2d:%02.2d:%02.2d T:%lu M:%9ju %7s: ", localTime.tm_hour, localTime.tm_min, localTime.tm_sec, record->threadId, stat.dwAvailPhys, levelNames[record->level]);
 #else
-    strPrefix.Format("%02.2d:%02.2d:%02.2d T:%lu M:%9u %7s: ", time.wHour, time.wMinute, time.wSecond, GetCurrentThreadId(), stat.dwAvailPhys, levelNames[loglevel]);
+      strPrefix.Format("%02.2d:%02.2d:%02.2d T:%lu M:%9u %7s: ", localTime.tm_hour, localTime.tm_min, localTime.tm_sec, record->threadId, stat.dwAvailPhys, levelNames[record->level]);
 #endif
 
-    strData.reserve(16384);
+      /* fixup newline alignment, number of spaces should equal prefix length */
+      strData.Replace("\n", "\n                             ");
+      strData += "\n";
+
+      fwrite(strPrefix.c_str(), strPrefix.size(), 1, fd);
+      fwrite(strData.c_str(), strData.size(), 1, fd);
+      wrote = true;
+    }
+    free(record);
+  }
+  if (wrote)
+    fflush(fd);
+}
+
+void CLog::Log(int loglevel, const char *format, ... )
+{
+  if (g_advancedSettings.m_logLevel > LOG_LEVEL_NORMAL ||
+     (g_advancedSettings.m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE))
+  {
+    // format into a buffer on our own stack, only falling back to the heap for
+    // very long lines
+    char buffer[1024];
+    CStdString strLong;
+    const char *data = buffer;
     va_list va;
     va_start(va, format);
-    strData.FormatV(format,va);
+    int length = _vsnprintf(buffer, sizeof(buffer), format, va);
     va_end(va);
-
-
-    int length = 0;
-    while ( length != (int)strData.length() )
+    if (length < 0 || length >= (int)sizeof(buffer))
     {
-      length = strData.length();
-      strData.TrimRight(" ");
-      strData.TrimRight('\n');
-      strData.TrimRight("\r");
+      va_start(va, format);
+      strLong.FormatV(format, va);
+      va_end(va);
+      data = strLong.c_str();
+      length = strLong.size();
     }
 
+    while (length > 0 && (data[length - 1] == ' ' || data[length - 1] == '\n' || data[length - 1] == '\r'))
+      length--;
+
 #if !defined(_LINUX) && (defined(_DEBUG) || defined(PROFILE))
-    OutputDebugString(strData.c_str());
+    OutputDebugString(CStdString(data, length).c_str());
     OutputDebugString("\n");
 #endif
 
-    /* fixup newline alignment, number of spaces should equal prefix length */
-    strData.Replace("\n", "\n                             ");
-    strData += "\n";
+    LogRecord *record = (LogRecord *)malloc(sizeof(LogRecord) + length);
+    if (!record)
+      return;
+    record->time = time(NULL);
+    record->threadId = GetCurrentThreadId();
+    record->level = loglevel;
+    record->length = length;
+    memcpy(record->text, data, length);
+    record->text[length] = 0;
+    PushRecord(record);
+
+    if (InterlockedCompareExchange(&writerState, WRITER_RUNNING, WRITER_NONE) == WRITER_NONE)
+    { // first line logged, so start up the writer
+      logWriter = new CLogWriter;
+      logWriter->Create();
+      logWriter->SetName("LogWriter");
+      atexit(CLog::Close);
+    }
 
-    fwrite(strPrefix.c_str(), strPrefix.size(), 1, fd);
-    fwrite(strData.c_str(), strData.size(), 1, fd);
-    fflush(fd);
+    if (loglevel >= LOGSEVERE || InterlockedCompareExchange(&writerState, 0, 0) == WRITER_CLOSED || !logWriter)
+      WriteQueued();
+    else if (loglevel >= LOGERROR)
+      logWriter->Wake();
   }
 #ifndef _LINUX
 #if defined(_DEBUG) || defined(PROFILE)
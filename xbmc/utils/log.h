@@ -49,6 +49,9 @@
 class CLog
 {
   static FILE* fd;
+  static bool OpenLogFile();
+  static void WriteQueued();
+  friend class CLogWriter;
 public:
   CLog();
   virtual ~CLog(void);